@@ -0,0 +1,338 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_InterfaceId.hpp"
+#include "ESPressio_NotificationQueue.hpp"
+#include "ESPressio_NotificationTransaction.hpp"
+#include "ESPressio_ThreadSafeObservable.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        enum class AsyncDispatchMode {
+            /// A dispatcher thread, started on the first notification, delivers
+            /// queued notifications as soon as they are published.
+            DispatcherThread,
+            /// Queued notifications are only delivered by calls to `Drain()`.
+            Manual
+        };
+
+        /// A `ThreadSafeObservable` whose notifications are delivered
+        /// asynchronously.
+        /// `ExecuteNotification()` moves the notification operation, which must
+        /// capture everything it uses by value, into a bounded lock-free queue and
+        /// returns without invoking any Observer. The operation later runs on the
+        /// dispatcher thread, or in `Drain()`, with the same `NotificationContext`
+        /// as a synchronous `ThreadSafeObservable`. Operations are delivered one at
+        /// a time, in the order they were queued, and so are
+        /// `ExecuteDeferrableNotification()` callbacks, including those a
+        /// `NotificationTransaction` defers to its commit.
+        /// Enqueueing never allocates: operations are stored inline in the queue
+        /// and must fit in `ESPRESSIO_OBSERVABLE_ASYNC_PAYLOAD_CAPACITY` bytes.
+        /// Notifications still queued when the Observable is destroyed are
+        /// discarded.
+        class AsyncObservable : public ThreadSafeObservable {
+            private:
+                using Queue = Detail::NotificationQueue<NotificationContext>;
+
+                static constexpr int DispatcherSpinCount = 64;
+
+                /// Shared with the dispatcher thread so that it never touches the
+                /// Observable after releasing its notification lifetime, which
+                /// may have destroyed the Observable.
+                struct DispatchState {
+                    Queue queue;
+                    std::mutex mutex;
+                    std::condition_variable condition;
+                    std::atomic<bool> dispatcherWaiting{false};
+                    bool stopping = false;
+
+                    explicit DispatchState(std::size_t capacity) : queue(capacity) {}
+                };
+
+                std::shared_ptr<DispatchState> _state;
+                /// Held by whichever thread is consuming the queue; `_consuming`
+                /// detects re-entrant consumption from within a callback.
+                std::recursive_mutex _consumerMutex;
+                bool _consuming = false;
+                const AsyncDispatchMode _mode;
+                std::once_flag _dispatcherStart;
+                std::atomic<bool> _dispatcherStarted{false};
+                std::thread _dispatcher;
+
+                /// Marks the queue as being consumed while `_consumerMutex` is held.
+                class ConsumerScope {
+                    private:
+                        bool& _consuming;
+
+                    public:
+                        explicit ConsumerScope(bool& consuming) noexcept : _consuming(consuming) {
+                            _consuming = true;
+                        }
+                        ConsumerScope(const ConsumerScope&) = delete;
+                        ConsumerScope& operator=(const ConsumerScope&) = delete;
+                        ~ConsumerScope() { _consuming = false; }
+                };
+
+                /// A deferrable notification held by an open `NotificationTransaction`.
+                /// The flush collects its Observers on the committing thread, but
+                /// delivering it queues the callback for the Observers it won.
+                template <class ObserverType, class Callback>
+                class PendingAsyncNotification final : public Detail::PendingNotification {
+                    private:
+                        std::shared_ptr<IObservable> _notificationLifetime;
+                        AsyncObservable& _observable;
+                        Callback _callback;
+
+                    public:
+                        PendingAsyncNotification(
+                            std::shared_ptr<IObservable> notificationLifetime,
+                            AsyncObservable& observable,
+                            Callback callback)
+                            : Detail::PendingNotification(Detail::InterfaceId<ObserverType>::Value()),
+                              _notificationLifetime(std::move(notificationLifetime)),
+                              _observable(observable),
+                              _callback(std::move(callback)) {}
+
+                        void Collect(std::vector<void*>& observers) override {
+                            _observable.ThreadSafeObservable::ExecuteNotification(
+                                [&observers](NotificationContext& notification) {
+                                    notification.WithObservers<ObserverType>(
+                                        [&observers](ObserverType* observer) {
+                                            observers.push_back(static_cast<void*>(observer));
+                                        });
+                                });
+                        }
+
+                        void Deliver(void* const* selected, std::size_t count) override {
+                            if (selected == nullptr) {
+                                _observable._queueDeferrable<ObserverType>(std::move(_callback));
+                                return;
+                            }
+                            _observable._queueDeferrable<ObserverType>(
+                                std::move(_callback), std::vector<void*>(selected, selected + count));
+                        }
+                };
+
+                template <class ObserverType, class Callback>
+                void _queueDeferrable(Callback callback) {
+                    ExecuteNotification(
+                        [callback = std::move(callback)](NotificationContext& notification) mutable {
+                            notification.WithObservers<ObserverType>(callback);
+                        });
+                }
+
+                /// Queues `callback` for the `ObserverType` Observers whose interfaces
+                /// are in `selected`, sorted ascending. Observers are matched by
+                /// address when the notification is delivered.
+                template <class ObserverType, class Callback>
+                void _queueDeferrable(Callback callback, std::vector<void*> selected) {
+                    struct Delivery {
+                        Callback callback;
+                        std::vector<void*> selected;
+                    };
+                    std::shared_ptr<Delivery> delivery(
+                        new Delivery{std::move(callback), std::move(selected)});
+                    ExecuteNotification([delivery](NotificationContext& notification) {
+                        notification.WithObservers<ObserverType>([&delivery](ObserverType* observer) {
+                            if (std::binary_search(
+                                    delivery->selected.begin(),
+                                    delivery->selected.end(),
+                                    static_cast<void*>(observer))) {
+                                delivery->callback(observer);
+                            }
+                        });
+                    });
+                }
+
+                /// Requires `_consumerMutex`.
+                bool _dispatchNext() {
+                    return _state->queue.ConsumeNext([this](const Queue::Invoker& invoke) {
+                        ThreadSafeObservable::ExecuteNotification(
+                            [&invoke](NotificationContext& notification) {
+                                invoke(notification);
+                            });
+                    });
+                }
+
+                static void _runDispatcher(
+                    std::shared_ptr<DispatchState> state,
+                    std::weak_ptr<IObservable> observable,
+                    AsyncObservable* self) {
+                    for (;;) {
+                        // Briefly poll before blocking, so producers of a steady
+                        // stream rarely pay for waking the dispatcher.
+                        for (int spin = 0; spin < DispatcherSpinCount; ++spin) {
+                            if (state->queue.HasPending()) { break; }
+                            std::this_thread::yield();
+                        }
+                        {
+                            std::unique_lock<std::mutex> lock(state->mutex);
+                            state->dispatcherWaiting.store(true, std::memory_order_relaxed);
+                            std::atomic_thread_fence(std::memory_order_seq_cst);
+                            state->condition.wait(lock, [&state]() {
+                                return state->stopping || state->queue.HasPending();
+                            });
+                            state->dispatcherWaiting.store(false, std::memory_order_relaxed);
+                            if (state->stopping) { return; }
+                        }
+
+                        std::shared_ptr<IObservable> notificationLifetime = observable.lock();
+                        if (!notificationLifetime) { return; }
+                        {
+                            std::lock_guard<std::recursive_mutex> consumerLock(self->_consumerMutex);
+                            ConsumerScope consuming(self->_consuming);
+                            for (;;) {
+                                try {
+                                    if (!self->_dispatchNext()) { break; }
+                                } catch (...) {
+                                    self->OnAsyncNotificationException(std::current_exception());
+                                }
+                            }
+                        }
+                        // May destroy the Observable; only `state` is used afterwards.
+                        notificationLifetime.reset();
+                    }
+                }
+
+                void _startDispatcher() {
+                    std::call_once(_dispatcherStart, [this]() {
+                        std::shared_ptr<IObservable> observable = AcquireNotificationLifetime();
+                        _dispatcher = std::thread(
+                            &AsyncObservable::_runDispatcher,
+                            _state,
+                            std::weak_ptr<IObservable>(observable),
+                            this);
+                        _dispatcherStarted.store(true, std::memory_order_release);
+                    });
+                }
+
+                void _wakeDispatcher() {
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (_state->dispatcherWaiting.load(std::memory_order_relaxed)) {
+                        std::lock_guard<std::mutex> lock(_state->mutex);
+                        _state->condition.notify_one();
+                    }
+                }
+
+                void _stopDispatcher() noexcept {
+                    {
+                        std::lock_guard<std::mutex> lock(_state->mutex);
+                        _state->stopping = true;
+                    }
+                    _state->condition.notify_one();
+                    if (!_dispatcher.joinable()) { return; }
+                    if (_dispatcher.get_id() == std::this_thread::get_id()) {
+                        // Released from within the dispatcher thread, which exits
+                        // once control returns to it.
+                        _dispatcher.detach();
+                    } else {
+                        _dispatcher.join();
+                    }
+                }
+
+            protected:
+                /// Queues `operation` for asynchronous delivery, returning false
+                /// without queueing it when the queue is full. In
+                /// `DispatcherThread` mode, throws `ObservableOwnershipException`
+                /// if this Observable is not owned by a `std::shared_ptr`.
+                template <class Operation>
+                bool TryExecuteNotification(Operation&& operation) {
+                    if (_mode == AsyncDispatchMode::DispatcherThread &&
+                        !_dispatcherStarted.load(std::memory_order_acquire)) {
+                        _startDispatcher();
+                    }
+                    if (!_state->queue.TryEnqueue(std::forward<Operation>(operation))) {
+                        return false;
+                    }
+                    if (_mode == AsyncDispatchMode::DispatcherThread) {
+                        _wakeDispatcher();
+                    }
+                    return true;
+                }
+
+                /// Queues `operation` for asynchronous delivery. Throws
+                /// `AsyncNotificationQueueFullException` when the queue is full.
+                template <class Operation>
+                void ExecuteNotification(Operation&& operation) {
+                    if (!TryExecuteNotification(std::forward<Operation>(operation))) {
+                        throw AsyncNotificationQueueFullException();
+                    }
+                }
+
+                /// Queues `callback` for every `ObserverType` Observer or, while a
+                /// `NotificationTransaction` is open on this thread, defers it to
+                /// the transaction's commit, which queues it for the Observers it
+                /// won. Queued notifications never nest, so callbacks raising more
+                /// need no run-to-completion queue. `callback` must capture by value.
+                template <class ObserverType, class Callback>
+                void ExecuteDeferrableNotification(Callback callback) {
+                    if (Detail::IsTransactionOpen()) {
+                        using Pending = PendingAsyncNotification<ObserverType, Callback>;
+                        std::unique_ptr<Detail::PendingNotification> pending(new Pending(
+                            AcquireNotificationLifetime(), *this, std::move(callback)));
+                        Detail::TransactionState::Current().pending.push_back(std::move(pending));
+                        return;
+                    }
+                    _queueDeferrable<ObserverType>(std::move(callback));
+                }
+
+                /// Called on the dispatcher thread with any exception thrown while
+                /// delivering a notification. The remaining notifications are still
+                /// delivered. The default implementation ignores the exception.
+                virtual void OnAsyncNotificationException(std::exception_ptr exception) noexcept {
+                    (void)exception;
+                }
+
+            public:
+                /// `queueCapacity` is rounded up to a power of two.
+                explicit AsyncObservable(
+                    std::size_t queueCapacity = 64,
+                    AsyncDispatchMode mode = AsyncDispatchMode::DispatcherThread)
+                    : _state(std::make_shared<DispatchState>(queueCapacity)),
+                      _mode(mode) {}
+
+                ~AsyncObservable() override {
+                    _stopDispatcher();
+                    BeginObservableDestruction();
+                }
+
+                /// Delivers every queued notification on the calling thread and
+                /// returns how many were delivered. Returns 0 immediately if another
+                /// thread, or an enclosing callback, is already delivering.
+                /// Exceptions thrown by a callback propagate; the failed
+                /// notification is discarded and later ones remain queued.
+                /// Throws `ObservableOwnershipException`, delivering nothing, if
+                /// this Observable is not owned by a `std::shared_ptr`.
+                std::size_t Drain() {
+                    const std::shared_ptr<IObservable> notificationLifetime =
+                        AcquireNotificationLifetime();
+                    std::unique_lock<std::recursive_mutex> consumerLock(
+                        _consumerMutex, std::try_to_lock);
+                    if (!consumerLock.owns_lock() || _consuming) { return 0; }
+                    ConsumerScope consuming(_consuming);
+                    std::size_t delivered = 0;
+                    while (_dispatchNext()) { ++delivered; }
+                    return delivered;
+                }
+
+                std::size_t GetQueueCapacity() const noexcept {
+                    return _state->queue.GetCapacity();
+                }
+        };
+
+    }
+
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+/// Define as 1 to allocate `ObserverHandle`s and Observable lifetime control
+/// blocks from `Detail::SlabBlockAllocator` instead of the general heap.
+#ifndef ESPRESSIO_OBSERVABLE_POOLED_ALLOCATION
+#define ESPRESSIO_OBSERVABLE_POOLED_ALLOCATION 0
+#endif
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        namespace Detail {
+            /// Allocates every block directly from the general heap.
+            struct HeapBlockAllocator {
+                static void* Allocate(std::size_t size) {
+                    return ::operator new(size);
+                }
+
+                static void Deallocate(void* block, std::size_t) noexcept {
+                    ::operator delete(block);
+                }
+            };
+
+            /// Serves small blocks from fixed-size slabs that are carved once and
+            /// retained for the life of the program, so steady registration churn
+            /// neither reaches the general heap nor fragments it.
+            /// Each thread keeps a bounded free list per size class and only takes
+            /// the shared lock to refill or spill a batch of blocks. Blocks may be
+            /// released on a different thread from the one that allocated them.
+            /// Requests larger than the biggest size class use the general heap.
+            class SlabBlockAllocator {
+                public:
+                    static constexpr std::size_t Granularity = 64;
+                    static constexpr std::size_t SizeClassCount = 4;
+                    static constexpr std::size_t BlocksPerSlab = 32;
+                    static constexpr std::size_t ThreadCacheLimit = 64;
+
+                private:
+                    static_assert(
+                        Granularity % alignof(std::max_align_t) == 0,
+                        "Slab blocks must preserve fundamental alignment"
+                    );
+
+                    struct FreeBlock {
+                        FreeBlock* next;
+                    };
+
+                    struct ThreadCache {
+                        FreeBlock* blocks;
+                        std::size_t count;
+                    };
+
+                    struct SharedState {
+                        std::mutex mutex;
+                        FreeBlock* blocks[SizeClassCount] = {};
+                    };
+
+                    /// Returns every cached block to the shared lists when its
+                    /// thread exits.
+                    struct ThreadCacheRelease {
+                        ~ThreadCacheRelease() {
+                            for (std::size_t sizeClass = 0; sizeClass < SizeClassCount; ++sizeClass) {
+                                _spill(_threadCaches()[sizeClass], sizeClass, 0);
+                            }
+                            _threadReleased() = true;
+                        }
+                    };
+
+                    /// Deliberately never destroyed, so blocks may still be released
+                    /// during static destruction.
+                    static SharedState& _shared() {
+                        static SharedState* state = new SharedState();
+                        return *state;
+                    }
+
+                    static ThreadCache* _threadCaches() noexcept {
+                        static thread_local ThreadCache caches[SizeClassCount];
+                        return caches;
+                    }
+
+                    static bool& _threadReleased() noexcept {
+                        static thread_local bool released = false;
+                        return released;
+                    }
+
+                    static void _registerThread() {
+                        static thread_local ThreadCacheRelease release;
+                        (void)release;
+                    }
+
+                    static std::size_t _blockSize(std::size_t sizeClass) noexcept {
+                        return (sizeClass + 1) * Granularity;
+                    }
+
+                    /// Requires the shared mutex.
+                    static void _carveSlab(SharedState& shared, std::size_t sizeClass) {
+                        const std::size_t blockSize = _blockSize(sizeClass);
+                        char* slab = static_cast<char*>(::operator new(blockSize * BlocksPerSlab));
+                        for (std::size_t index = BlocksPerSlab; index > 0; --index) {
+                            FreeBlock* block = reinterpret_cast<FreeBlock*>(
+                                slab + (index - 1) * blockSize);
+                            block->next = shared.blocks[sizeClass];
+                            shared.blocks[sizeClass] = block;
+                        }
+                    }
+
+                    static void _refill(ThreadCache& cache, std::size_t sizeClass) {
+                        SharedState& shared = _shared();
+                        std::lock_guard<std::mutex> lock(shared.mutex);
+                        if (shared.blocks[sizeClass] == nullptr) {
+                            _carveSlab(shared, sizeClass);
+                        }
+                        while (cache.count < ThreadCacheLimit / 2 && shared.blocks[sizeClass] != nullptr) {
+                            FreeBlock* block = shared.blocks[sizeClass];
+                            shared.blocks[sizeClass] = block->next;
+                            block->next = cache.blocks;
+                            cache.blocks = block;
+                            ++cache.count;
+                        }
+                    }
+
+                    /// Moves cached blocks to the shared list until `retain` remain.
+                    static void _spill(ThreadCache& cache, std::size_t sizeClass, std::size_t retain) noexcept {
+                        if (cache.count <= retain) { return; }
+                        SharedState& shared = _shared();
+                        std::lock_guard<std::mutex> lock(shared.mutex);
+                        while (cache.count > retain) {
+                            FreeBlock* block = cache.blocks;
+                            cache.blocks = block->next;
+                            --cache.count;
+                            block->next = shared.blocks[sizeClass];
+                            shared.blocks[sizeClass] = block;
+                        }
+                    }
+
+                public:
+                    static void* Allocate(std::size_t size) {
+                        const std::size_t sizeClass = size == 0 ? 0 : (size - 1) / Granularity;
+                        if (sizeClass >= SizeClassCount) { return ::operator new(size); }
+
+                        ThreadCache& cache = _threadCaches()[sizeClass];
+                        if (cache.blocks == nullptr) {
+                            if (_threadReleased()) {
+                                ThreadCache transient{nullptr, 0};
+                                _refill(transient, sizeClass);
+                                FreeBlock* block = transient.blocks;
+                                transient.blocks = block->next;
+                                --transient.count;
+                                _spill(transient, sizeClass, 0);
+                                return block;
+                            }
+                            _registerThread();
+                            _refill(cache, sizeClass);
+                        }
+
+                        FreeBlock* block = cache.blocks;
+                        cache.blocks = block->next;
+                        --cache.count;
+                        return block;
+                    }
+
+                    static void Deallocate(void* block, std::size_t size) noexcept {
+                        if (block == nullptr) { return; }
+                        const std::size_t sizeClass = size == 0 ? 0 : (size - 1) / Granularity;
+                        if (sizeClass >= SizeClassCount) {
+                            ::operator delete(block);
+                            return;
+                        }
+
+                        ThreadCache& cache = _threadCaches()[sizeClass];
+                        FreeBlock* freed = static_cast<FreeBlock*>(block);
+                        freed->next = cache.blocks;
+                        cache.blocks = freed;
+                        ++cache.count;
+
+                        if (_threadReleased()) {
+                            _spill(cache, sizeClass, 0);
+                        } else if (cache.count == 1) {
+                            try {
+                                _registerThread();
+                            } catch (...) {
+                                _spill(cache, sizeClass, 0);
+                            }
+                        } else if (cache.count > ThreadCacheLimit) {
+                            _spill(cache, sizeClass, ThreadCacheLimit / 2);
+                        }
+                    }
+            };
+
+#if defined(ESPRESSIO_OBSERVABLE_BLOCK_ALLOCATOR)
+            /// A user-supplied allocator providing the same static `Allocate()`
+            /// and `Deallocate()` functions as `HeapBlockAllocator`.
+            using ObservableBlockAllocator = ESPRESSIO_OBSERVABLE_BLOCK_ALLOCATOR;
+#elif ESPRESSIO_OBSERVABLE_POOLED_ALLOCATION
+            using ObservableBlockAllocator = SlabBlockAllocator;
+#else
+            using ObservableBlockAllocator = HeapBlockAllocator;
+#endif
+
+            /// Adapts `ObservableBlockAllocator` to the standard allocator
+            /// requirements for use with `std::allocate_shared`.
+            template <class T>
+            struct BlockAllocatorAdapter {
+                using value_type = T;
+
+                BlockAllocatorAdapter() noexcept = default;
+
+                template <class U>
+                BlockAllocatorAdapter(const BlockAllocatorAdapter<U>&) noexcept {}
+
+                T* allocate(std::size_t count) {
+                    return static_cast<T*>(ObservableBlockAllocator::Allocate(count * sizeof(T)));
+                }
+
+                void deallocate(T* block, std::size_t count) noexcept {
+                    ObservableBlockAllocator::Deallocate(block, count * sizeof(T));
+                }
+
+                template <class U>
+                bool operator==(const BlockAllocatorAdapter<U>&) const noexcept { return true; }
+
+                template <class U>
+                bool operator!=(const BlockAllocatorAdapter<U>&) const noexcept { return false; }
+            };
+        }
+
+    }
+
+}
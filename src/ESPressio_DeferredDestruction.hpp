@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "ESPressio_BlockAllocator.hpp"
+#include "ESPressio_IObservable.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        namespace Detail {
+            class DeferredDestruction;
+        }
+
+        template <class ObservableType, class... Arguments>
+        std::shared_ptr<ObservableType> MakeObservable(Arguments&&... arguments);
+
+        namespace Detail {
+            /// Lets a single-threaded Observable created by `MakeObservable()` be
+            /// released by one of its own callbacks without retaining a
+            /// `shared_ptr` for every notification. Outstanding notifications are
+            /// counted in a plain integer, and the owner's deleter defers
+            /// destruction until the last of them ends.
+            class DeferredDestruction {
+                private:
+                    template <class ObservableType, class... Arguments>
+                    friend std::shared_ptr<ObservableType> ESPressio::Observable::MakeObservable(
+                        Arguments&&... arguments);
+                    friend class NotificationLifetime;
+
+                    /// The `shared_ptr` deleter installed by `MakeObservable()`.
+                    template <class ObservableType>
+                    struct DeferringDelete {
+                        void operator()(ObservableType* observable) const noexcept {
+                            DeferredDestruction& destruction = *observable;
+                            if (destruction._notificationLifetimes > 0) {
+                                destruction._released = true;
+                                return;
+                            }
+                            delete observable;
+                        }
+                    };
+
+                    std::size_t _notificationLifetimes = 0;
+                    bool _deferring = false;
+                    bool _released = false;
+
+                protected:
+                    DeferredDestruction() = default;
+                    DeferredDestruction(const DeferredDestruction&) = delete;
+                    DeferredDestruction& operator=(const DeferredDestruction&) = delete;
+                    ~DeferredDestruction() = default;
+
+                    /// Returns `true` when this Observable was created by
+                    /// `MakeObservable()`, so notifications need not retain it.
+                    bool IsDestructionDeferred() const noexcept {
+                        return _deferring;
+                    }
+            };
+
+            /// Keeps an Observable alive for a notification, held by its
+            /// `NotificationContext`. A deferring Observable is counted, and
+            /// destroyed here if its owner released it meanwhile; any other is
+            /// retained through `retained`.
+            class NotificationLifetime {
+                private:
+                    DeferredDestruction* _deferred = nullptr;
+                    IObservable* _observable;
+                    std::shared_ptr<IObservable> _retained;
+
+                public:
+                    /// `retained` must be empty exactly when `destruction` is deferring.
+                    NotificationLifetime(
+                        DeferredDestruction& destruction,
+                        IObservable& observable,
+                        std::shared_ptr<IObservable> retained) noexcept
+                        : _observable(&observable),
+                          _retained(std::move(retained)) {
+                        if (!_retained) {
+                            _deferred = &destruction;
+                            ++_deferred->_notificationLifetimes;
+                        }
+                    }
+
+                    NotificationLifetime(const NotificationLifetime& other) noexcept
+                        : _deferred(other._deferred),
+                          _observable(other._observable),
+                          _retained(other._retained) {
+                        if (_deferred != nullptr) { ++_deferred->_notificationLifetimes; }
+                    }
+
+                    NotificationLifetime& operator=(const NotificationLifetime&) = delete;
+
+                    ~NotificationLifetime() {
+                        if (_deferred == nullptr) { return; }
+                        if (--_deferred->_notificationLifetimes == 0 && _deferred->_released) {
+                            delete _observable;
+                        }
+                    }
+            };
+        }
+
+        /// Creates a single-threaded Observable (`Observable`,
+        /// `ObservableWithBuckets`, `StaticObservable`, `TypedObservable` or a
+        /// type derived from one) owned by a `shared_ptr` whose deleter waits
+        /// for outstanding notifications. Its notifications then count
+        /// themselves in a plain integer instead of retaining the Observable
+        /// atomically, while a callback may still release the last owner.
+        /// Once released, it can no longer be retained, so a
+        /// `NotificationTransaction` cannot defer its notifications from the
+        /// remainder of that notification. With
+        /// `ObservableWithBuckets::SetParallelDispatch()`, fan-out callbacks may
+        /// notify it from several threads; those notifications are counted under
+        /// the fan-out guard.
+        template <class ObservableType, class... Arguments>
+        std::shared_ptr<ObservableType> MakeObservable(Arguments&&... arguments) {
+            static_assert(
+                std::is_base_of<Detail::DeferredDestruction, ObservableType>::value,
+                "MakeObservable() requires a single-threaded Observable type");
+            ObservableType* observable = new ObservableType(std::forward<Arguments>(arguments)...);
+            static_cast<Detail::DeferredDestruction&>(*observable)._deferring = true;
+            return std::shared_ptr<ObservableType>(
+                observable,
+                Detail::DeferredDestruction::DeferringDelete<ObservableType>(),
+                Detail::BlockAllocatorAdapter<ObservableType>());
+        }
+
+    }
+
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        namespace Detail {
+            /// Records which snapshot Observables are dispatching on the current
+            /// thread, so re-entrant unregistration never waits for itself.
+            struct SnapshotDispatchFrame {
+                const void* observable;
+                SnapshotDispatchFrame* previous;
+            };
+
+            inline SnapshotDispatchFrame*& CurrentSnapshotDispatchFrame() noexcept {
+                static thread_local SnapshotDispatchFrame* frame = nullptr;
+                return frame;
+            }
+
+            /// Two-epoch read-copy-update reclamation shared by the snapshot
+            /// Observables.
+            /// Readers enter a `ReadSection` with one atomic increment of their
+            /// epoch's reader count and leave with one decrement; they never lock,
+            /// advance the epoch or reclaim. Writers serialise on
+            /// `GetWriterMutex()`, publish replacement state and `Retire()` what
+            /// they replaced. Retired state is deleted by a later `Reclaim()`,
+            /// which each write makes, once every reader that could still be
+            /// referencing it has left.
+            class EpochReclaimer {
+                private:
+                    struct RetiredState {
+                        void* state;
+                        void (*destroy)(void*);
+                        std::size_t epoch;
+                    };
+
+                    /// Leading padding keeps each count off the cache line of the
+                    /// epoch and of the other count.
+                    struct ReaderCount {
+                        unsigned char padding[64];
+                        std::atomic<std::size_t> readers{0};
+                    };
+
+                    /// Read by every reader, written only by writers.
+                    std::atomic<std::size_t> _epoch{0};
+                    std::atomic<std::size_t> _graceWaiters{0};
+                    ReaderCount _readers[2];
+                    std::mutex _writerMutex;
+                    std::mutex _graceMutex;
+                    std::condition_variable _graceCondition;
+                    std::vector<RetiredState> _retired;
+
+                    template <class State>
+                    static void _destroy(void* state) {
+                        delete static_cast<State*>(state);
+                    }
+
+                    /// The epoch only advances under the writer mutex, so a reader
+                    /// retries only when it raced a write.
+                    std::size_t _enterReadSection() noexcept {
+                        for (;;) {
+                            const std::size_t epoch = _epoch.load();
+                            const std::size_t slot = epoch & 1;
+                            _readers[slot].readers.fetch_add(1);
+                            if (_epoch.load() == epoch) { return slot; }
+                            _exitReadSection(slot);
+                        }
+                    }
+
+                    /// Only wakes writers waiting in `WaitForGracePeriod()`;
+                    /// reclamation is left to the next write.
+                    void _exitReadSection(std::size_t slot) noexcept {
+                        if (_readers[slot].readers.fetch_sub(1) != 1) { return; }
+
+                        if (_graceWaiters.load() != 0) {
+                            std::lock_guard<std::mutex> lock(_graceMutex);
+                            _graceCondition.notify_all();
+                        }
+                    }
+
+                    /// Requires the writer mutex. Readers only ever occupy the
+                    /// current and previous epochs, so the epoch may advance once
+                    /// the slot shared by the previous and next epochs has drained.
+                    void _tryAdvanceEpoch() noexcept {
+                        for (int attempt = 0; attempt < 2; ++attempt) {
+                            const std::size_t epoch = _epoch.load();
+                            if (_readers[(epoch + 1) & 1].readers.load() != 0) { return; }
+                            _epoch.store(epoch + 1);
+                        }
+                    }
+
+                public:
+                    class ReadSection {
+                        private:
+                            EpochReclaimer& _reclaimer;
+                            std::size_t _slot;
+
+                        public:
+                            explicit ReadSection(EpochReclaimer& reclaimer) noexcept
+                                : _reclaimer(reclaimer),
+                                  _slot(reclaimer._enterReadSection()) {}
+                            ReadSection(const ReadSection&) = delete;
+                            ReadSection& operator=(const ReadSection&) = delete;
+                            ~ReadSection() { _reclaimer._exitReadSection(_slot); }
+                    };
+
+                    /// Marks `observable` as dispatching on the current thread for
+                    /// the lifetime of the frame.
+                    class DispatchFrame {
+                        private:
+                            SnapshotDispatchFrame _frame;
+
+                        public:
+                            explicit DispatchFrame(const void* observable) noexcept
+                                : _frame{observable, CurrentSnapshotDispatchFrame()} {
+                                CurrentSnapshotDispatchFrame() = &_frame;
+                            }
+                            DispatchFrame(const DispatchFrame&) = delete;
+                            DispatchFrame& operator=(const DispatchFrame&) = delete;
+                            ~DispatchFrame() {
+                                CurrentSnapshotDispatchFrame() = _frame.previous;
+                            }
+                    };
+
+                    EpochReclaimer() = default;
+                    EpochReclaimer(const EpochReclaimer&) = delete;
+                    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+                    ~EpochReclaimer() {
+                        for (RetiredState& retired : _retired) {
+                            retired.destroy(retired.state);
+                        }
+                    }
+
+                    static bool IsDispatching(const void* observable) noexcept {
+                        for (
+                            const SnapshotDispatchFrame* frame = CurrentSnapshotDispatchFrame();
+                            frame != nullptr;
+                            frame = frame->previous
+                        ) {
+                            if (frame->observable == observable) { return true; }
+                        }
+                        return false;
+                    }
+
+                    std::mutex& GetWriterMutex() noexcept {
+                        return _writerMutex;
+                    }
+
+                    /// Requires the writer mutex. Reserving before publication keeps
+                    /// the subsequent `Retire()` calls non-throwing.
+                    void ReserveRetirements(std::size_t count) {
+                        if (_retired.capacity() - _retired.size() >= count) { return; }
+                        _retired.reserve(std::max(_retired.size() + count, _retired.capacity() * 2));
+                    }
+
+                    /// Requires the writer mutex and a prior `ReserveRetirements()`.
+                    /// Must be called after the replacement state has been published.
+                    /// Returns the retirement epoch to pass to `WaitForGracePeriod()`.
+                    template <class State>
+                    std::size_t Retire(State* state) noexcept {
+                        const std::size_t epoch = _epoch.load();
+                        if (state != nullptr) {
+                            _retired.push_back(RetiredState{state, &_destroy<State>, epoch});
+                        }
+                        return epoch;
+                    }
+
+                    /// Requires the writer mutex. State retired at epoch `e` can only
+                    /// be referenced by readers of epochs `e` and `e - 1`, both of
+                    /// which have drained once the epoch reaches `e + 2`.
+                    void Reclaim() noexcept {
+                        _tryAdvanceEpoch();
+                        const std::size_t epoch = _epoch.load();
+                        std::size_t reclaimed = 0;
+                        while (
+                            reclaimed < _retired.size() &&
+                            _retired[reclaimed].epoch + 2 <= epoch
+                        ) {
+                            _retired[reclaimed].destroy(_retired[reclaimed].state);
+                            ++reclaimed;
+                        }
+                        _retired.erase(_retired.begin(), _retired.begin() + reclaimed);
+                    }
+
+                    /// Must not be called with the writer mutex held, nor from within
+                    /// a `ReadSection` of this reclaimer.
+                    void WaitForGracePeriod(std::size_t retiredEpoch) {
+                        _graceWaiters.fetch_add(1);
+                        {
+                            std::unique_lock<std::mutex> graceLock(_graceMutex);
+                            _graceCondition.wait(graceLock, [this, retiredEpoch]() {
+                                std::lock_guard<std::mutex> writerLock(_writerMutex);
+                                Reclaim();
+                                return _epoch.load() >= retiredEpoch + 2;
+                            });
+                        }
+                        _graceWaiters.fetch_sub(1);
+                    }
+            };
+        }
+
+    }
+
+}
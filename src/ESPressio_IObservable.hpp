@@ -1,12 +1,19 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
+#include "ESPressio_BlockAllocator.hpp"
 #include "ESPressio_IObserver.hpp"
+#include "ESPressio_ObserverLatency.hpp"
 
 namespace ESPressio {
 
@@ -16,7 +23,14 @@ namespace ESPressio {
         class Observable;
         class ObservableWithBuckets;
         class ObserverHandle;
+        class ShardedThreadSafeObservable;
+        template <class... ObserverInterfaces>
+        class StaticObservable;
         class ThreadSafeObservable;
+        class ThreadSafeObservableWithBuckets;
+        class ThreadSafeSnapshotObservable;
+        template <class ObserverInterface>
+        class TypedObservable;
 
         class ObservableException : public std::runtime_error {
             public:
@@ -74,44 +88,113 @@ namespace ESPressio {
                         "Observable notifications require ownership by std::shared_ptr") {}
         };
 
+        class AsyncNotificationQueueFullException : public ObservableException {
+            public:
+                AsyncNotificationQueueFullException()
+                    : ObservableException(
+                        "The asynchronous notification queue is full") {}
+        };
+
+        /// Thrown by a parallel notification once every callback has completed,
+        /// carrying each exception the callbacks threw.
+        class ParallelNotificationException : public ObservableException {
+            private:
+                std::vector<std::exception_ptr> _exceptions;
+
+            public:
+                explicit ParallelNotificationException(std::vector<std::exception_ptr> exceptions)
+                    : ObservableException("One or more parallel notification callbacks failed"),
+                      _exceptions(std::move(exceptions)) {}
+
+                const std::vector<std::exception_ptr>& GetExceptions() const noexcept {
+                    return _exceptions;
+                }
+        };
+
         namespace Detail {
+            /// Tracks whether an Observable is alive and how many handle
+            /// operations are using it. Both live in one atomic word, so
+            /// `Acquire()`, `Release()` and `Peek()` are a single atomic operation.
+            /// Only `InvalidateAndWait()`, and a `Release()` that finishes the last
+            /// operation it waits for, take the mutex.
+            /// The Observable's `shared_ptr`s jointly hold one intrusive reference
+            /// and each `ObserverRegistration` holds another, so a registration
+            /// keeps the control alive in a single pointer.
             class ObservableLifetimeControl {
                 private:
-                    mutable std::mutex _mutex;
+                    /// Set once `InvalidateAndWait()` begins; active operations are
+                    /// counted in the bits above it.
+                    static constexpr std::size_t Invalidated = 1;
+                    static constexpr std::size_t Operation = 2;
+
+                    std::atomic<std::size_t> _state{0};
+                    std::atomic<std::size_t> _references{1};
+                    IObservable* const _observable;
+                    std::mutex _mutex;
                     std::condition_variable _condition;
-                    IObservable* _observable;
-                    std::size_t _activeOperations = 0;
-                    bool _alive = true;
+
+                    /// Ends an operation counted in `_state`, waking
+                    /// `InvalidateAndWait()` if it was the last one it waited for.
+                    void _endOperation() {
+                        if (_state.fetch_sub(Operation, std::memory_order_acq_rel) ==
+                            (Invalidated | Operation)) {
+                            std::lock_guard<std::mutex> lock(_mutex);
+                            _condition.notify_all();
+                        }
+                    }
 
                 public:
+                    /// The `shared_ptr` deleter, dropping the shared reference.
+                    struct SharedRelease {
+                        void operator()(ObservableLifetimeControl* lifetimeControl) const noexcept {
+                            lifetimeControl->ReleaseReference();
+                        }
+                    };
+
                     explicit ObservableLifetimeControl(IObservable* observable)
                         : _observable(observable) {}
 
+                    static void* operator new(std::size_t size) {
+                        return ObservableBlockAllocator::Allocate(size);
+                    }
+
+                    static void operator delete(void* lifetimeControl, std::size_t size) noexcept {
+                        ObservableBlockAllocator::Deallocate(lifetimeControl, size);
+                    }
+
+                    void AddReference() noexcept {
+                        _references.fetch_add(1, std::memory_order_relaxed);
+                    }
+
+                    void ReleaseReference() noexcept {
+                        if (_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                            delete this;
+                        }
+                    }
+
                     IObservable* Acquire() {
-                        std::lock_guard<std::mutex> lock(_mutex);
-                        if (!_alive) { return nullptr; }
-                        ++_activeOperations;
+                        if ((_state.fetch_add(Operation, std::memory_order_acq_rel) & Invalidated) != 0) {
+                            _endOperation();
+                            return nullptr;
+                        }
                         return _observable;
                     }
 
                     void Release() {
-                        std::lock_guard<std::mutex> lock(_mutex);
-                        if (--_activeOperations == 0) {
-                            _condition.notify_all();
-                        }
+                        _endOperation();
                     }
 
                     IObservable* Peek() const {
-                        std::lock_guard<std::mutex> lock(_mutex);
-                        return _alive ? _observable : nullptr;
+                        return (_state.load(std::memory_order_acquire) & Invalidated) != 0
+                            ? nullptr
+                            : _observable;
                     }
 
                     void InvalidateAndWait() {
+                        if (_state.fetch_or(Invalidated, std::memory_order_acq_rel) == 0) { return; }
                         std::unique_lock<std::mutex> lock(_mutex);
-                        _alive = false;
-                        _observable = nullptr;
                         _condition.wait(lock, [this]() {
-                            return _activeOperations == 0;
+                            return _state.load(std::memory_order_acquire) == Invalidated;
                         });
                     }
             };
@@ -135,14 +218,36 @@ namespace ESPressio {
                 /// Returns the non-owning `IObserver` pointer while registered,
                 /// or nullptr after unregistration has begun.
                 virtual IObserver* GetObserver() = 0;
+                /// Returns the callback latencies recorded for this registration
+                /// while its Observable tracked latency; empty otherwise.
+                virtual ObserverLatencyHistogram GetLatencyHistogram() const {
+                    return ObserverLatencyHistogram();
+                }
         };
 
         using ObserverHandlePtr = std::unique_ptr<IObserverHandle>;
+        /// The handles returned by a bulk registration, in the order the
+        /// Observers were supplied.
+        using ObserverHandleBatch = std::vector<ObserverHandlePtr>;
+
+        namespace Detail {
+            /// Copies a range of Observer pointers (of any type convertible to
+            /// `IObserver*`) so a bulk operation can validate it before mutating.
+            template <class ObserverRange>
+            std::vector<IObserver*> CollectObservers(const ObserverRange& observers) {
+                std::vector<IObserver*> collected;
+                for (IObserver* observer : observers) {
+                    collected.push_back(observer);
+                }
+                return collected;
+            }
+        }
     
         /// An `IObservable` is an object that can be observed by any number of `IObserver` descendant types
         class IObservable : public std::enable_shared_from_this<IObservable> {
             private:
                 friend class ObserverHandle;
+                friend class ObserverRegistration;
                 std::shared_ptr<Detail::ObservableLifetimeControl> _lifetimeControl;
 
             protected:
@@ -169,10 +274,26 @@ namespace ESPressio {
                     _lifetimeControl->InvalidateAndWait();
                 }
 
+                /// Called when an `ObserverRegistration` is unregistered or destroyed.
+                /// Implementations returning `ObserverRegistration`s must unregister
+                /// `observer` only while `registration` still identifies its
+                /// registration, so a registration made stale by `UnregisterObserver()`
+                /// cannot remove a later one.
+                virtual void UnregisterObserverRegistration(IObserver* observer, std::uint32_t registration) {
+                    (void)observer;
+                    (void)registration;
+                }
+
             public:
+                /// `true` for Observables that may be registered with and notified
+                /// from any thread. Every Thread Safe Observable redeclares it.
+                static constexpr bool IsThreadSafe = false;
+
                 IObservable()
                     : _lifetimeControl(
-                        std::make_shared<Detail::ObservableLifetimeControl>(this)) {}
+                        new Detail::ObservableLifetimeControl(this),
+                        Detail::ObservableLifetimeControl::SharedRelease(),
+                        Detail::BlockAllocatorAdapter<Detail::ObservableLifetimeControl>()) {}
                 IObservable(const IObservable&) = delete;
                 IObservable& operator=(const IObservable&) = delete;
                 IObservable(IObservable&&) = delete;
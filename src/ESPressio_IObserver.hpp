@@ -1,17 +1,107 @@
 #pragma once
 
+#include <cstddef>
+#include <type_traits>
+
+#include "ESPressio_InterfaceId.hpp"
+
+/// Define as 1 to dispatch without RTTI: Observers then resolve their
+/// interfaces through `IObserver::ResolveInterface()`, and the library uses
+/// neither `dynamic_cast` nor `typeid`. Defaults to 1 when the compiler has
+/// RTTI disabled (e.g. `-fno-rtti`), otherwise to 0.
+#ifndef ESPRESSIO_OBSERVABLE_NO_RTTI
+#if defined(__cpp_rtti) || defined(__GXX_RTTI) || defined(_CPPRTTI)
+#define ESPRESSIO_OBSERVABLE_NO_RTTI 0
+#else
+#define ESPRESSIO_OBSERVABLE_NO_RTTI 1
+#endif
+#endif
+
 namespace ESPressio {
 
     namespace Observable {
 
         /// An `IObserver` is an object that can observe an `IObservable`
         /// You MUST inherit from this type for ANY object from which you intend to Observe any `IObservable` descendant types
-        /// This is required to satisfy the `dynamic_cast` requirements of the `Observable` class, and cannot be avoided due to C++ language limitations.
+        /// Observables `dynamic_cast` it to the Observer interfaces they notify. Without RTTI
+        /// (`ESPRESSIO_OBSERVABLE_NO_RTTI`), Observers resolve their interfaces themselves instead,
+        /// most simply by deriving from `ObserverOf<...>`.
         class IObserver {
             public:
                 virtual ~IObserver() = default;
+
+#if ESPRESSIO_OBSERVABLE_NO_RTTI
+                /// Returns this Observer as the Observer interface whose
+                /// `Detail::InterfaceId` is `interfaceId`, or nullptr if it does
+                /// not implement it.
+                /// Pure, so that an Observer which does not resolve its interfaces
+                /// fails to compile rather than never being notified.
+                virtual void* ResolveInterface(std::size_t interfaceId) noexcept = 0;
+#endif
         };
 
+        /// Returns `observer`, upcast to the first of `ObserverInterfaces` whose
+        /// `Detail::InterfaceId` is `interfaceId`, or nullptr. Implements
+        /// `IObserver::ResolveInterface()` for Observers that must also resolve
+        /// interfaces `ObserverOf<...>` cannot derive from, such as the bases of
+        /// the interfaces they implement.
+        template <class... ObserverInterfaces, class Observer>
+        void* ResolveObserverInterface(Observer* observer, std::size_t interfaceId) noexcept {
+            void* resolved = nullptr;
+            const int resolve[] = {
+                0,
+                (resolved == nullptr && interfaceId == Detail::InterfaceId<ObserverInterfaces>::Value()
+                    ? (resolved = static_cast<void*>(static_cast<ObserverInterfaces*>(observer)), 0)
+                    : 0)...
+            };
+            (void)resolve;
+            (void)observer;
+            (void)interfaceId;
+            return resolved;
+        }
+
+        /// An `IObserver` implementing every one of `ObserverInterfaces`, and
+        /// resolving each of them in RTTI-free builds:
+        /// `class Logger final : public ObserverOf<ITemperatureObserver> { ... };`
+        /// `IObserver` is a virtual base, shared with interfaces deriving from
+        /// it virtually.
+        template <class... ObserverInterfaces>
+        class ObserverOf : public virtual IObserver, public ObserverInterfaces... {
+#if ESPRESSIO_OBSERVABLE_NO_RTTI
+            public:
+                void* ResolveInterface(std::size_t interfaceId) noexcept override {
+                    return ResolveObserverInterface<ObserverInterfaces...>(this, interfaceId);
+                }
+#endif
+        };
+
+        namespace Detail {
+            template <class ObserverType>
+            ObserverType* CastObserver(IObserver* observer, std::true_type) noexcept {
+                return observer;
+            }
+
+            template <class ObserverType>
+            ObserverType* CastObserver(IObserver* observer, std::false_type) noexcept {
+#if ESPRESSIO_OBSERVABLE_NO_RTTI
+                return static_cast<ObserverType*>(
+                    observer->ResolveInterface(InterfaceId<ObserverType>::Value()));
+#else
+                return dynamic_cast<ObserverType*>(observer);
+#endif
+            }
+        }
+
+        /// Returns `observer` as an `ObserverType`, or nullptr if it does not
+        /// implement it: a `dynamic_cast`, or `IObserver::ResolveInterface()`
+        /// without RTTI.
+        template <class ObserverType>
+        ObserverType* ObserverCast(IObserver* observer) noexcept {
+            if (observer == nullptr) { return nullptr; }
+            return Detail::CastObserver<ObserverType>(
+                observer, std::is_same<typename std::remove_cv<ObserverType>::type, IObserver>());
+        }
+
     }
 
-}
\ No newline at end of file
+}
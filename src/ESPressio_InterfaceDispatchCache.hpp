@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_IObserver.hpp"
+#include "ESPressio_InterfaceId.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        class ObserverHandle;
+
+        namespace Detail {
+            /// A registration slot of `Observable` or `ThreadSafeObservable`.
+            /// Vacant slots have a null `observer`; `handle` is null for an
+            /// `ObserverRegistration`.
+            struct ObserverSlot {
+                IObserver* observer;
+                ObserverHandle* handle;
+            };
+
+            /// Where a registered Observer's slot is, and the id of its
+            /// `ObserverRegistration`, or 0 for an `IObserverHandle`.
+            struct SlotIndex {
+                std::size_t slot;
+                std::uint32_t registration;
+            };
+
+            /// Per-interface buckets of pre-resolved Observer interface pointers
+            /// for the untyped Observables.
+            /// A bucket is materialised the first time its interface is notified,
+            /// after which every registration resolves the interface once, so the
+            /// interface resolution is paid per registration rather than per
+            /// notification.
+            /// Entries refer to the owning Observable's registration slots and
+            /// retain registration (ascending slot) order. Unregistration only
+            /// needs to null the slot: dispatch skips entries whose slot is null,
+            /// and `Compact()` drops them when the Observable compacts its slots.
+            /// Not synchronised: the owning Observable guards every call.
+            class InterfaceDispatchCache {
+                public:
+                    struct Entry {
+                        std::size_t slot;
+                        void* observerInterface;
+                    };
+
+                    struct Bucket {
+                        void* (*resolve)(IObserver*);
+                        std::vector<Entry> entries;
+                    };
+
+                private:
+                    /// Indexed by `Detail::InterfaceId`; null until materialised.
+                    std::vector<std::unique_ptr<Bucket> > _buckets;
+
+                    template <class ObserverType>
+                    static void* _resolve(IObserver* observer) {
+                        return static_cast<void*>(ObserverCast<ObserverType>(observer));
+                    }
+
+                public:
+                    /// Returns the bucket for `ObserverType`, materialising it from
+                    /// the live (non-null) slots of `observers` on first use.
+                    /// Bucket addresses remain stable until `Clear()`.
+                    template <class ObserverType>
+                    Bucket& GetBucket(const std::vector<ObserverSlot>& observers) {
+                        const std::size_t interfaceId = InterfaceId<ObserverType>::Value();
+                        if (interfaceId < _buckets.size() && _buckets[interfaceId]) {
+                            return *_buckets[interfaceId];
+                        }
+
+                        std::unique_ptr<Bucket> bucket(
+                            new Bucket{&_resolve<ObserverType>, std::vector<Entry>()});
+                        for (std::size_t slot = 0; slot < observers.size(); ++slot) {
+                            IObserver* observer = observers[slot].observer;
+                            if (observer == nullptr) { continue; }
+                            void* observerInterface = bucket->resolve(observer);
+                            if (observerInterface != nullptr) {
+                                bucket->entries.push_back(Entry{slot, observerInterface});
+                            }
+                        }
+                        if (interfaceId >= _buckets.size()) {
+                            _buckets.resize(interfaceId + 1);
+                        }
+                        _buckets[interfaceId] = std::move(bucket);
+                        return *_buckets[interfaceId];
+                    }
+
+                    /// Appends `observer`, registered in `slot`, to every materialised
+                    /// bucket whose interface it implements. `slot` must exceed every
+                    /// slot already cached. Either every bucket is updated or, on
+                    /// exception, none is.
+                    void Add(std::size_t slot, IObserver* observer) {
+                        if (_buckets.empty()) { return; }
+
+                        std::vector<Bucket*> appended;
+                        appended.reserve(_buckets.size());
+                        try {
+                            for (std::unique_ptr<Bucket>& bucket : _buckets) {
+                                if (!bucket) { continue; }
+                                void* observerInterface = bucket->resolve(observer);
+                                if (observerInterface == nullptr) { continue; }
+                                bucket->entries.push_back(Entry{slot, observerInterface});
+                                appended.push_back(bucket.get());
+                            }
+                        } catch (...) {
+                            for (Bucket* bucket : appended) { bucket->entries.pop_back(); }
+                            throw;
+                        }
+                    }
+
+                    /// Drops every entry for `firstSlot` and later slots, undoing the
+                    /// `Add()` calls of a failed bulk registration.
+                    void Truncate(std::size_t firstSlot) noexcept {
+                        for (std::unique_ptr<Bucket>& bucket : _buckets) {
+                            if (!bucket) { continue; }
+                            std::vector<Entry>& entries = bucket->entries;
+                            while (!entries.empty() && entries.back().slot >= firstSlot) {
+                                entries.pop_back();
+                            }
+                        }
+                    }
+
+                    /// Drops entries whose slot in `observers` is null and renumbers
+                    /// the remainder to the slots they occupy once `observers` has
+                    /// been compacted in order. Must be called before compacting.
+                    void Compact(const std::vector<ObserverSlot>& observers) noexcept {
+                        for (std::unique_ptr<Bucket>& bucket : _buckets) {
+                            if (!bucket) { continue; }
+                            std::vector<Entry>& entries = bucket->entries;
+                            std::size_t slot = 0;
+                            std::size_t liveSlots = 0;
+                            std::size_t kept = 0;
+                            for (const Entry& entry : entries) {
+                                for (; slot < entry.slot; ++slot) {
+                                    if (observers[slot].observer != nullptr) { ++liveSlots; }
+                                }
+                                if (observers[entry.slot].observer == nullptr) { continue; }
+                                entries[kept++] = Entry{liveSlots, entry.observerInterface};
+                            }
+                            entries.resize(kept);
+                        }
+                    }
+
+                    void Clear() noexcept {
+                        _buckets.clear();
+                    }
+            };
+        }
+
+    }
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        namespace Detail {
+            inline std::size_t NextInterfaceId() noexcept {
+                static std::atomic<std::size_t> nextInterfaceId{0};
+                return nextInterfaceId.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /// Maps each Observer interface type to a small, dense integer ID,
+            /// assigned on first use. IDs are stable for the life of the program
+            /// and index flat per-interface bucket arrays, so selecting a bucket
+            /// needs no hashing and no RTTI.
+            template <class ObserverInterface>
+            struct InterfaceId {
+                static std::size_t Value() noexcept {
+                    static const std::size_t interfaceId = NextInterfaceId();
+                    return interfaceId;
+                }
+            };
+        }
+
+    }
+
+}
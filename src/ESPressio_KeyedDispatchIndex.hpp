@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ESPressio_InterfaceDispatchCache.hpp"
+#include "ESPressio_IObserver.hpp"
+#include "ESPressio_InterfaceId.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        /// Identifies what a keyed registration is interested in, such as a
+        /// sensor id, so a keyed notification reaches only its Observers.
+        using SubscriptionKey = std::uint32_t;
+
+        namespace Detail {
+            /// Per-key lists of an Observable's registration slots, each with its
+            /// own lazily materialised interface buckets, so a keyed notification
+            /// visits only the Observers registered for that key.
+            /// Like `InterfaceDispatchCache`, entries retain ascending slot order,
+            /// unregistration only nulls the slot, and `Compact()` drops entries
+            /// for vacant slots (and keys left without any) when the Observable
+            /// compacts.
+            /// Not synchronised: the owning Observable guards every call.
+            class KeyedDispatchIndex {
+                public:
+                    using Bucket = InterfaceDispatchCache::Bucket;
+                    using Entry = InterfaceDispatchCache::Entry;
+
+                private:
+                    struct KeyBucket {
+                        std::vector<std::size_t> slots;
+                        /// Indexed by `Detail::InterfaceId`; null until materialised.
+                        std::vector<std::unique_ptr<Bucket> > buckets;
+                    };
+
+                    std::unordered_map<SubscriptionKey, KeyBucket> _keys;
+                    /// Scratch for `Compact()`, grown by `Add()` to cover every
+                    /// indexed slot so compaction never allocates.
+                    std::vector<std::size_t> _compactedSlots;
+
+                    template <class ObserverType>
+                    static void* _resolve(IObserver* observer) {
+                        return static_cast<void*>(ObserverCast<ObserverType>(observer));
+                    }
+
+                    /// Drops `slot` from each of `keys`, and any key it leaves empty.
+                    template <class KeyRange>
+                    void _remove(std::size_t slot, const KeyRange& keys) noexcept {
+                        for (const SubscriptionKey key : keys) {
+                            const auto found = _keys.find(key);
+                            if (found == _keys.end()) { continue; }
+                            KeyBucket& keyBucket = found->second;
+                            for (std::unique_ptr<Bucket>& bucket : keyBucket.buckets) {
+                                if (!bucket) { continue; }
+                                while (!bucket->entries.empty() && bucket->entries.back().slot >= slot) {
+                                    bucket->entries.pop_back();
+                                }
+                            }
+                            while (!keyBucket.slots.empty() && keyBucket.slots.back() >= slot) {
+                                keyBucket.slots.pop_back();
+                            }
+                            if (keyBucket.slots.empty()) { _keys.erase(found); }
+                        }
+                    }
+
+                public:
+                    /// Returns the bucket of `ObserverType` Observers registered for
+                    /// `key`, materialising it from the key's live slots in
+                    /// `observers` on first use, or nullptr when no Observer is
+                    /// registered for `key`. Bucket addresses remain stable until
+                    /// the key is dropped by `Compact()` or `Clear()`.
+                    template <class ObserverType>
+                    Bucket* GetBucket(SubscriptionKey key, const std::vector<ObserverSlot>& observers) {
+                        const auto found = _keys.find(key);
+                        if (found == _keys.end()) { return nullptr; }
+                        KeyBucket& keyBucket = found->second;
+
+                        const std::size_t interfaceId = InterfaceId<ObserverType>::Value();
+                        if (interfaceId < keyBucket.buckets.size() && keyBucket.buckets[interfaceId]) {
+                            return keyBucket.buckets[interfaceId].get();
+                        }
+
+                        std::unique_ptr<Bucket> bucket(
+                            new Bucket{&_resolve<ObserverType>, std::vector<Entry>()});
+                        for (const std::size_t slot : keyBucket.slots) {
+                            IObserver* observer = observers[slot].observer;
+                            if (observer == nullptr) { continue; }
+                            void* observerInterface = bucket->resolve(observer);
+                            if (observerInterface != nullptr) {
+                                bucket->entries.push_back(Entry{slot, observerInterface});
+                            }
+                        }
+                        if (interfaceId >= keyBucket.buckets.size()) {
+                            keyBucket.buckets.resize(interfaceId + 1);
+                        }
+                        keyBucket.buckets[interfaceId] = std::move(bucket);
+                        return keyBucket.buckets[interfaceId].get();
+                    }
+
+                    /// Indexes `observer`, registered in `slot`, under every key in
+                    /// `keys` (repeated keys are indexed once). `slot` must exceed
+                    /// every slot already indexed. Either every key is updated or,
+                    /// on exception, none is.
+                    template <class KeyRange>
+                    void Add(std::size_t slot, IObserver* observer, const KeyRange& keys) {
+                        if (keys.begin() == keys.end()) { return; }
+                        if (_compactedSlots.size() <= slot) { _compactedSlots.resize(slot + 1); }
+
+                        try {
+                            for (const SubscriptionKey key : keys) {
+                                KeyBucket& keyBucket = _keys[key];
+                                if (!keyBucket.slots.empty() && keyBucket.slots.back() == slot) {
+                                    continue;
+                                }
+                                keyBucket.slots.push_back(slot);
+                                for (std::unique_ptr<Bucket>& bucket : keyBucket.buckets) {
+                                    if (!bucket) { continue; }
+                                    void* observerInterface = bucket->resolve(observer);
+                                    if (observerInterface != nullptr) {
+                                        bucket->entries.push_back(Entry{slot, observerInterface});
+                                    }
+                                }
+                            }
+                        } catch (...) {
+                            _remove(slot, keys);
+                            throw;
+                        }
+                    }
+
+                    /// Drops entries whose slot in `observers` is null, and keys left
+                    /// without entries, then renumbers the remainder to the slots
+                    /// they occupy once `observers` has been compacted in order.
+                    /// Must be called before compacting.
+                    void Compact(const std::vector<ObserverSlot>& observers) noexcept {
+                        if (_keys.empty()) { return; }
+
+                        const std::size_t indexedSlots =
+                            _compactedSlots.size() < observers.size() ? _compactedSlots.size() : observers.size();
+                        std::size_t liveSlots = 0;
+                        for (std::size_t slot = 0; slot < indexedSlots; ++slot) {
+                            _compactedSlots[slot] = liveSlots;
+                            if (observers[slot].observer != nullptr) { ++liveSlots; }
+                        }
+
+                        for (auto key = _keys.begin(); key != _keys.end();) {
+                            KeyBucket& keyBucket = key->second;
+                            std::size_t kept = 0;
+                            for (const std::size_t slot : keyBucket.slots) {
+                                if (observers[slot].observer == nullptr) { continue; }
+                                keyBucket.slots[kept++] = _compactedSlots[slot];
+                            }
+                            keyBucket.slots.resize(kept);
+                            if (kept == 0) {
+                                key = _keys.erase(key);
+                                continue;
+                            }
+
+                            for (std::unique_ptr<Bucket>& bucket : keyBucket.buckets) {
+                                if (!bucket) { continue; }
+                                std::vector<Entry>& entries = bucket->entries;
+                                std::size_t keptEntries = 0;
+                                for (const Entry& entry : entries) {
+                                    if (observers[entry.slot].observer == nullptr) { continue; }
+                                    entries[keptEntries++] =
+                                        Entry{_compactedSlots[entry.slot], entry.observerInterface};
+                                }
+                                entries.resize(keptEntries);
+                            }
+                            ++key;
+                        }
+                    }
+
+                    void Clear() noexcept {
+                        _keys.clear();
+                    }
+            };
+        }
+
+    }
+
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/// The inline storage, in bytes, available to each queued asynchronous
+/// notification operation (its captured state).
+#ifndef ESPRESSIO_OBSERVABLE_ASYNC_PAYLOAD_CAPACITY
+#define ESPRESSIO_OBSERVABLE_ASYNC_PAYLOAD_CAPACITY 64
+#endif
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        namespace Detail {
+            /// A bounded multi-producer, single-consumer queue of type-erased
+            /// notification operations, each invoked with a `Context&`.
+            /// Every cell stores its operation inline, so the ring itself is the
+            /// payload pool: enqueueing never allocates and is lock-free, and a
+            /// full queue is reported rather than waited on. Operations are
+            /// delivered in the order their cells were claimed.
+            /// `ConsumeNext()` must only be called by one thread at a time;
+            /// `HasPending()` may be called concurrently and returns a snapshot.
+            template <class Context>
+            class NotificationQueue {
+                public:
+                    static constexpr std::size_t PayloadCapacity =
+                        ESPRESSIO_OBSERVABLE_ASYNC_PAYLOAD_CAPACITY;
+
+                    /// Passed to the `ConsumeNext()` callback to run the dequeued
+                    /// operation.
+                    class Invoker {
+                        private:
+                            friend class NotificationQueue;
+                            void (*_invoke)(void*, Context&);
+                            void* _storage;
+
+                            Invoker(void (*invoke)(void*, Context&), void* storage) noexcept
+                                : _invoke(invoke), _storage(storage) {}
+
+                        public:
+                            void operator()(Context& context) const {
+                                _invoke(_storage, context);
+                            }
+                    };
+
+                private:
+                    struct Cell {
+                        std::atomic<std::size_t> sequence;
+                        /// Null when the operation failed to construct.
+                        void (*invoke)(void*, Context&);
+                        void (*destroy)(void*);
+                        alignas(std::max_align_t) unsigned char storage[PayloadCapacity];
+                    };
+
+                    /// Keeps the producer and consumer positions on separate cache
+                    /// lines.
+                    struct alignas(std::max_align_t) Position {
+                        std::atomic<std::size_t> value{0};
+                        unsigned char padding[64 - sizeof(std::atomic<std::size_t>)];
+                    };
+
+                    std::unique_ptr<Cell[]> _cells;
+                    std::size_t _mask;
+                    Position _enqueuePosition;
+                    Position _dequeuePosition;
+
+                    template <class Operation>
+                    static void _invoke(void* storage, Context& context) {
+                        (*static_cast<Operation*>(storage))(context);
+                    }
+
+                    template <class Operation>
+                    static void _destroy(void* storage) {
+                        static_cast<Operation*>(storage)->~Operation();
+                    }
+
+                    static std::size_t _roundedCapacity(std::size_t capacity) noexcept {
+                        std::size_t rounded = 2;
+                        while (rounded < capacity) { rounded <<= 1; }
+                        return rounded;
+                    }
+
+                public:
+                    /// `capacity` is rounded up to a power of two.
+                    explicit NotificationQueue(std::size_t capacity)
+                        : _cells(new Cell[_roundedCapacity(capacity)]),
+                          _mask(_roundedCapacity(capacity) - 1) {
+                        for (std::size_t index = 0; index <= _mask; ++index) {
+                            _cells[index].sequence.store(index, std::memory_order_relaxed);
+                        }
+                    }
+
+                    NotificationQueue(const NotificationQueue&) = delete;
+                    NotificationQueue& operator=(const NotificationQueue&) = delete;
+
+                    ~NotificationQueue() {
+                        while (ConsumeNext([](const Invoker&) {})) {}
+                    }
+
+                    std::size_t GetCapacity() const noexcept {
+                        return _mask + 1;
+                    }
+
+                    /// Moves or copies `operation` into the next free cell. Returns
+                    /// false, leaving the queue unchanged, when every cell is in use.
+                    /// Rethrows if the operation's constructor throws; the claimed cell
+                    /// is then released empty.
+                    template <class Operation>
+                    bool TryEnqueue(Operation&& operation) {
+                        using StoredOperation = typename std::decay<Operation>::type;
+                        static_assert(
+                            sizeof(StoredOperation) <= PayloadCapacity,
+                            "Asynchronous notification operations must fit in "
+                            "ESPRESSIO_OBSERVABLE_ASYNC_PAYLOAD_CAPACITY bytes"
+                        );
+                        static_assert(
+                            alignof(StoredOperation) <= alignof(std::max_align_t),
+                            "Asynchronous notification operations must not be over-aligned"
+                        );
+
+                        Cell* cell;
+                        std::size_t position =
+                            _enqueuePosition.value.load(std::memory_order_relaxed);
+                        for (;;) {
+                            cell = &_cells[position & _mask];
+                            const std::size_t sequence =
+                                cell->sequence.load(std::memory_order_acquire);
+                            const std::ptrdiff_t difference =
+                                static_cast<std::ptrdiff_t>(sequence) -
+                                static_cast<std::ptrdiff_t>(position);
+                            if (difference == 0) {
+                                if (_enqueuePosition.value.compare_exchange_weak(
+                                        position, position + 1, std::memory_order_relaxed)) {
+                                    break;
+                                }
+                            } else if (difference < 0) {
+                                return false;
+                            } else {
+                                position = _enqueuePosition.value.load(std::memory_order_relaxed);
+                            }
+                        }
+
+                        try {
+                            new (cell->storage) StoredOperation(std::forward<Operation>(operation));
+                        } catch (...) {
+                            cell->invoke = nullptr;
+                            cell->destroy = nullptr;
+                            cell->sequence.store(position + 1, std::memory_order_release);
+                            throw;
+                        }
+                        cell->invoke = &_invoke<StoredOperation>;
+                        cell->destroy = &_destroy<StoredOperation>;
+                        cell->sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+
+                    bool HasPending() const noexcept {
+                        const std::size_t position =
+                            _dequeuePosition.value.load(std::memory_order_relaxed);
+                        return _cells[position & _mask].sequence.load(std::memory_order_acquire) ==
+                            position + 1;
+                    }
+
+                    /// Removes the oldest published operation and passes an `Invoker`
+                    /// for it to `deliver`, then destroys it and recycles its cell,
+                    /// even if `deliver` throws. Returns false when nothing is
+                    /// published.
+                    template <class Deliver>
+                    bool ConsumeNext(Deliver&& deliver) {
+                        const std::size_t position =
+                            _dequeuePosition.value.load(std::memory_order_relaxed);
+                        Cell& cell = _cells[position & _mask];
+                        if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+                            return false;
+                        }
+                        _dequeuePosition.value.store(position + 1, std::memory_order_relaxed);
+
+                        struct Recycle {
+                            Cell& cell;
+                            std::size_t sequence;
+                            ~Recycle() {
+                                if (cell.destroy != nullptr) { cell.destroy(cell.storage); }
+                                cell.sequence.store(sequence, std::memory_order_release);
+                            }
+                        } recycle{cell, position + _mask + 1};
+
+                        if (cell.invoke != nullptr) {
+                            deliver(Invoker(cell.invoke, cell.storage));
+                        }
+                        return true;
+                    }
+            };
+        }
+
+    }
+
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ESPressio_BlockAllocator.hpp"
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_InterfaceId.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        namespace Detail {
+            /// A notification deferred by an open `NotificationTransaction`, or
+            /// queued behind a run-to-completion dispatch by `QueueNotification()`.
+            class PendingNotification {
+                private:
+                    std::size_t _interfaceId;
+
+                public:
+                    explicit PendingNotification(std::size_t interfaceId) noexcept
+                        : _interfaceId(interfaceId) {}
+                    virtual ~PendingNotification() = default;
+
+                    static void* operator new(std::size_t size) {
+                        return ObservableBlockAllocator::Allocate(size);
+                    }
+
+                    static void operator delete(void* pending, std::size_t size) noexcept {
+                        ObservableBlockAllocator::Deallocate(pending, size);
+                    }
+
+                    std::size_t GetInterfaceId() const noexcept {
+                        return _interfaceId;
+                    }
+
+                    /// Appends every Observer interface the notification would reach.
+                    virtual void Collect(std::vector<void*>& observers) = 0;
+                    /// Delivers the notification to the `count` Observer interfaces
+                    /// at `selected` (sorted ascending), or to all of them if it is null.
+                    virtual void Deliver(void* const* selected, std::size_t count) = 0;
+            };
+
+            /// `Dispatch` runs the owning Observable's notification operation,
+            /// passing each live `ObserverType*` to the visitor it is given.
+            template <class ObserverType, class Dispatch, class Callback>
+            class TypedPendingNotification final : public PendingNotification {
+                private:
+                    std::shared_ptr<IObservable> _notificationLifetime;
+                    Dispatch _dispatch;
+                    Callback _callback;
+
+                public:
+                    TypedPendingNotification(
+                        std::shared_ptr<IObservable> notificationLifetime,
+                        Dispatch dispatch,
+                        Callback callback)
+                        : PendingNotification(InterfaceId<ObserverType>::Value()),
+                          _notificationLifetime(std::move(notificationLifetime)),
+                          _dispatch(std::move(dispatch)),
+                          _callback(std::move(callback)) {}
+
+                    void Collect(std::vector<void*>& observers) override {
+                        _dispatch([&observers](ObserverType* observer) {
+                            observers.push_back(static_cast<void*>(observer));
+                        });
+                    }
+
+                    void Deliver(void* const* selected, std::size_t count) override {
+                        _dispatch([this, selected, count](ObserverType* observer) {
+                            if (selected == nullptr || std::binary_search(
+                                    selected, selected + count, static_cast<void*>(observer))) {
+                                _callback(observer);
+                            }
+                        });
+                    }
+            };
+
+            /// One Observer interface reached by the pending notification `index`.
+            struct PendingDelivery {
+                void* observerInterface;
+                std::size_t interfaceId;
+                std::size_t index;
+            };
+
+            /// The notifications deferred by the transactions open on this thread,
+            /// and buffers retained between flushes to avoid reallocating them.
+            struct TransactionState {
+                std::vector<std::unique_ptr<PendingNotification> > pending;
+                std::size_t depth = 0;
+                std::vector<PendingDelivery> deliveries;
+                std::vector<void*> observers;
+                std::vector<std::size_t> table;
+
+                static TransactionState& Current() {
+                    static thread_local TransactionState state;
+                    return state;
+                }
+            };
+
+            inline bool IsTransactionOpen() {
+                return TransactionState::Current().depth > 0;
+            }
+
+            /// Defers an `ObserverType` notification to the outermost transaction
+            /// open on this thread, retaining the Observable until it is flushed.
+            /// Requires `IsTransactionOpen()`.
+            template <class ObserverType, class Dispatch, class Callback>
+            void DeferNotification(
+                std::shared_ptr<IObservable> notificationLifetime,
+                Dispatch&& dispatch,
+                Callback&& callback) {
+                using Pending = TypedPendingNotification<
+                    ObserverType,
+                    typename std::decay<Dispatch>::type,
+                    typename std::decay<Callback>::type
+                >;
+                std::unique_ptr<PendingNotification> pending(new Pending(
+                    std::move(notificationLifetime),
+                    std::forward<Dispatch>(dispatch),
+                    std::forward<Callback>(callback)));
+                TransactionState::Current().pending.push_back(std::move(pending));
+            }
+        }
+
+        /// Defers the notifications raised through `ExecuteDeferrableNotification()`
+        /// on this thread, by any number of Observables, until `Commit()`.
+        /// Committing the outermost transaction delivers them in the order they
+        /// were raised, but each Observer receives at most one notification per
+        /// Observer interface: the last one raised for it, from whichever
+        /// Observable. Observers unregistered before the flush reaches them are
+        /// skipped, and Observers registered during it are not notified.
+        /// Transactions nest. Destroying a transaction without committing it
+        /// discards the notifications raised since it began, so a failed update
+        /// notifies nothing. Notifications raised by callbacks during the flush
+        /// are delivered immediately.
+        class NotificationTransaction {
+            private:
+                std::size_t _savepoint;
+                bool _open = true;
+
+                static std::size_t _hash(const Detail::PendingDelivery& delivery) noexcept {
+                    const std::size_t hash = std::hash<void*>()(delivery.observerInterface) ^
+                        (delivery.interfaceId * static_cast<std::size_t>(0x9E3779B97F4A7C15ULL));
+                    return hash ^ (hash >> 17);
+                }
+
+                /// Keeps, in order, only the last delivery to each Observer interface,
+                /// using `table` as an open-addressed set of the deliveries kept.
+                static void _keepLastDeliveries(
+                    std::vector<Detail::PendingDelivery>& deliveries,
+                    std::vector<std::size_t>& table) {
+                    const std::size_t empty = static_cast<std::size_t>(-1);
+                    std::size_t capacity = 16;
+                    while (capacity < deliveries.size() * 2) { capacity *= 2; }
+                    table.assign(capacity, empty);
+
+                    std::size_t kept = deliveries.size();
+                    for (std::size_t position = deliveries.size(); position-- > 0;) {
+                        const Detail::PendingDelivery delivery = deliveries[position];
+                        std::size_t bucket = _hash(delivery) & (capacity - 1);
+                        bool seen = false;
+                        while (table[bucket] != empty) {
+                            const Detail::PendingDelivery& other = deliveries[table[bucket]];
+                            if (other.observerInterface == delivery.observerInterface &&
+                                other.interfaceId == delivery.interfaceId) {
+                                seen = true;
+                                break;
+                            }
+                            bucket = (bucket + 1) & (capacity - 1);
+                        }
+                        if (seen) { continue; }
+                        deliveries[--kept] = delivery;
+                        table[bucket] = kept;
+                    }
+                    deliveries.erase(deliveries.begin(), deliveries.begin() + kept);
+                }
+
+                /// Selects, for each Observer interface, the last pending notification
+                /// reaching it, then delivers each notification to those it won.
+                /// A callback committing its own transaction flushes re-entrantly,
+                /// so the retained buffers are taken for the duration.
+                static void _flush(std::vector<std::unique_ptr<Detail::PendingNotification> >& pending) {
+                    if (pending.size() == 1) {
+                        pending.front()->Deliver(nullptr, 0);
+                        return;
+                    }
+                    Detail::TransactionState& state = Detail::TransactionState::Current();
+                    std::vector<Detail::PendingDelivery> deliveries;
+                    std::vector<void*> observers;
+                    std::vector<std::size_t> table;
+                    deliveries.swap(state.deliveries);
+                    observers.swap(state.observers);
+                    table.swap(state.table);
+
+                    for (std::size_t index = 0; index < pending.size(); ++index) {
+                        observers.clear();
+                        pending[index]->Collect(observers);
+                        const std::size_t interfaceId = pending[index]->GetInterfaceId();
+                        for (void* observer : observers) {
+                            deliveries.push_back(Detail::PendingDelivery{observer, interfaceId, index});
+                        }
+                    }
+                    _keepLastDeliveries(deliveries, table);
+
+                    observers.clear();
+                    for (const Detail::PendingDelivery& delivery : deliveries) {
+                        observers.push_back(delivery.observerInterface);
+                    }
+                    std::size_t begin = 0;
+                    while (begin < deliveries.size()) {
+                        const std::size_t index = deliveries[begin].index;
+                        std::size_t end = begin;
+                        while (end < deliveries.size() && deliveries[end].index == index) { ++end; }
+                        std::sort(observers.begin() + begin, observers.begin() + end, std::less<void*>());
+                        pending[index]->Deliver(observers.data() + begin, end - begin);
+                        begin = end;
+                    }
+
+                    deliveries.clear();
+                    observers.clear();
+                    state.deliveries.swap(deliveries);
+                    state.observers.swap(observers);
+                    state.table.swap(table);
+                }
+
+            public:
+                NotificationTransaction() {
+                    Detail::TransactionState& state = Detail::TransactionState::Current();
+                    _savepoint = state.pending.size();
+                    ++state.depth;
+                }
+
+                NotificationTransaction(const NotificationTransaction&) = delete;
+                NotificationTransaction& operator=(const NotificationTransaction&) = delete;
+
+                ~NotificationTransaction() {
+                    if (!_open) { return; }
+                    Detail::TransactionState& state = Detail::TransactionState::Current();
+                    state.pending.resize(_savepoint);
+                    --state.depth;
+                }
+
+                /// Ends this transaction. Committing the outermost transaction
+                /// delivers every deferred notification; an exception thrown by a
+                /// callback propagates and discards those not yet delivered.
+                /// Subsequent calls do nothing.
+                void Commit() {
+                    if (!_open) { return; }
+                    _open = false;
+                    Detail::TransactionState& state = Detail::TransactionState::Current();
+                    if (--state.depth > 0) { return; }
+                    std::vector<std::unique_ptr<Detail::PendingNotification> > pending;
+                    pending.swap(state.pending);
+                    _flush(pending);
+                    if (state.pending.empty()) {
+                        pending.clear();
+                        state.pending.swap(pending);
+                    }
+                }
+        };
+
+    }
+
+}
@@ -1,14 +1,24 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <initializer_list>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 #include <vector>
-#include <algorithm>
 
+#include "ESPressio_DeferredDestruction.hpp"
 #include "ESPressio_IObservable.hpp"
+#include "ESPressio_InterfaceDispatchCache.hpp"
 #include "ESPressio_IObserver.hpp"
+#include "ESPressio_NotificationTransaction.hpp"
+#include "ESPressio_ObservableInstrumentation.hpp"
 #include "ESPressio_ObserverHandle.hpp"
+#include "ESPressio_ObserverRegistration.hpp"
+#include "ESPressio_RunToCompletion.hpp"
 
 namespace ESPressio {
 
@@ -20,29 +30,162 @@ namespace ESPressio {
         /// Observers may register or unregister during a callback, but calls
         /// from multiple threads still require external synchronization.
         /// If you need a Thread-Safe Implementation, use the `ThreadSafeObservable` class instead.
-        class Observable : public IUntypedObservable {
+        /// With `EnableRunToCompletion()`, notifications raised through
+        /// `ExecuteDeferrableNotification()` during a callback are queued and
+        /// delivered once the notification in progress completes, instead of
+        /// recursing into it.
+        class Observable
+            : public IUntypedObservable,
+              public Detail::DeferredDestruction,
+              private Detail::ObservableCounters {
             private:
-                std::vector<IObserverHandle*> _observers;
+                /// Registration slots in registration order; unregistered slots are
+                /// nulled and reclaimed by `_compactIfWorthwhile()`.
+                std::vector<Detail::ObserverSlot> _observers;
+                std::unordered_map<IObserver*, Detail::SlotIndex> _slots;
+                Detail::RegistrationIds _registrationIds;
+                Detail::InterfaceDispatchCache _dispatchCache;
                 std::size_t _notificationDepth = 0;
-                bool _needsCompaction = false;
+                std::size_t _vacantSlots = 0;
+                Detail::LatencyTracker _latencyTracker;
+                bool _runToCompletion = false;
 
-                void _finishNotification() {
-                    if (--_notificationDepth == 0 && _needsCompaction) {
-                        _observers.erase(
-                            std::remove(_observers.begin(), _observers.end(), nullptr),
-                            _observers.end());
-                        _needsCompaction = false;
+                /// Compaction is deferred until no notification is iterating and at
+                /// least half of the slots are vacant, keeping unregistration O(1)
+                /// amortised without reordering Observers.
+                void _compactIfWorthwhile() noexcept {
+                    if (_notificationDepth > 0 || _vacantSlots == 0 ||
+                        _vacantSlots * 2 < _observers.size()) {
+                        return;
                     }
+                    RecordCompaction();
+                    _dispatchCache.Compact(_observers);
+                    std::size_t liveSlots = 0;
+                    for (const Detail::ObserverSlot& slot : _observers) {
+                        if (slot.observer == nullptr) { continue; }
+                        _slots.find(slot.observer)->second.slot = liveSlots;
+                        _observers[liveSlots++] = slot;
+                    }
+                    _observers.resize(liveSlots);
+                    _vacantSlots = 0;
+                }
+
+                bool _vacateSlot(IObserver* observer) noexcept {
+                    const auto slot = _slots.find(observer);
+                    if (slot == _slots.end()) { return false; }
+
+                    Detail::ObserverSlot& vacated = _observers[slot->second.slot];
+                    if (vacated.handle != nullptr) { vacated.handle->InvalidateRegistration(); }
+                    vacated = Detail::ObserverSlot{nullptr, nullptr};
+                    _slots.erase(slot);
+                    ++_vacantSlots;
+                    RecordUnregistrations(1);
+                    return true;
+                }
+
+                ObserverHandleBatch _registerObservers(const std::vector<IObserver*>& observers) {
+                    for (IObserver* observer : observers) {
+                        if (observer == nullptr) {
+                            throw InvalidObserverRegistrationException();
+                        }
+                    }
+
+                    const std::size_t firstSlot = _observers.size();
+                    _observers.reserve(firstSlot + observers.size());
+                    _slots.reserve(_slots.size() + observers.size());
+                    ObserverHandleBatch handles;
+                    handles.reserve(observers.size());
+
+                    std::size_t indexed = 0;
+                    try {
+                        for (; indexed < observers.size(); ++indexed) {
+                            const Detail::SlotIndex index{firstSlot + indexed, 0};
+                            if (!_slots.emplace(observers[indexed], index).second) {
+                                throw DuplicateObserverRegistrationException();
+                            }
+                        }
+                        for (IObserver* observer : observers) {
+                            handles.emplace_back(new ObserverHandle(GetLifetimeControl(), observer));
+                        }
+                        for (std::size_t index = 0; index < observers.size(); ++index) {
+                            _dispatchCache.Add(firstSlot + index, observers[index]);
+                        }
+                    } catch (...) {
+                        _dispatchCache.Truncate(firstSlot);
+                        for (std::size_t index = 0; index < indexed; ++index) {
+                            _slots.erase(observers[index]);
+                        }
+                        for (ObserverHandlePtr& handle : handles) {
+                            static_cast<ObserverHandle*>(handle.get())->InvalidateRegistration();
+                        }
+                        throw;
+                    }
+
+                    for (std::size_t index = 0; index < observers.size(); ++index) {
+                        _observers.push_back(Detail::ObserverSlot{
+                            observers[index], static_cast<ObserverHandle*>(handles[index].get())});
+                    }
+                    RecordRegistrations(handles.size());
+                    return handles;
+                }
+
+                void _addSlot(Detail::ObserverSlot added, std::uint32_t registration) {
+                    const std::size_t slot = _observers.size();
+                    _observers.push_back(added);
+                    try {
+                        _slots.emplace(added.observer, Detail::SlotIndex{slot, registration});
+                        try {
+                            _dispatchCache.Add(slot, added.observer);
+                        } catch (...) {
+                            _slots.erase(added.observer);
+                            throw;
+                        }
+                    } catch (...) {
+                        _observers.pop_back();
+                        throw;
+                    }
+                    RecordRegistrations(1);
+                }
+
+                void _finishNotification() noexcept {
+                    --_notificationDepth;
+                    _compactIfWorthwhile();
+                }
+
+                /// Records a timed callback unless it unregistered its own Observer,
+                /// whose handle may already be destroyed.
+                Detail::LatencyTracker::Clock::time_point _recordLatency(
+                    std::size_t slot,
+                    IObserver* observer,
+                    Detail::LatencyTracker::Clock::time_point start) {
+                    const auto end = Detail::LatencyTracker::Clock::now();
+                    const Detail::ObserverSlot& timed = _observers[slot];
+                    if (timed.observer != observer) { return end; }
+                    return _latencyTracker.Record(
+                        timed.handle != nullptr ? &timed.handle->GetOrCreateLatencyHistogram() : nullptr,
+                        observer,
+                        start,
+                        end);
                 }
 
                 template <class Callback>
                 void _withObservers(Callback&& callback) {
                     ++_notificationDepth;
                     const std::size_t observerCount = _observers.size();
+                    const bool timed = _latencyTracker.IsEnabled();
+                    Detail::LatencyTracker::Clock::time_point start;
+                    if (timed) { start = Detail::LatencyTracker::Clock::now(); }
                     try {
+                        Detail::ObservableCounters::DispatchTally tally(*this);
                         for (std::size_t index = 0; index < observerCount; ++index) {
-                            IObserverHandle* handle = _observers[index];
-                            if (handle != nullptr) { callback(handle->GetObserver()); }
+                            IObserver* observer = _observers[index].observer;
+                            if (observer == nullptr) {
+                                tally.Skipped();
+                                continue;
+                            }
+                            tally.Invoked();
+                            callback(observer);
+                            if (timed) { start = _recordLatency(index, observer, start); }
                         }
                     } catch (...) {
                         _finishNotification();
@@ -51,16 +194,29 @@ namespace ESPressio {
                     _finishNotification();
                 }
 
+                /// Dispatch walks the cached bucket of interface pointers resolved
+                /// when `ObserverType` was first notified or the Observer registered.
                 template <class ObserverType, class Callback>
                 void _withObservers(Callback&& callback) {
+                    Detail::InterfaceDispatchCache::Bucket& bucket =
+                        _dispatchCache.GetBucket<ObserverType>(_observers);
                     ++_notificationDepth;
-                    const std::size_t observerCount = _observers.size();
+                    const std::size_t observerCount = bucket.entries.size();
+                    const bool timed = _latencyTracker.IsEnabled();
+                    Detail::LatencyTracker::Clock::time_point start;
+                    if (timed) { start = Detail::LatencyTracker::Clock::now(); }
                     try {
+                        Detail::ObservableCounters::DispatchTally tally(*this);
                         for (std::size_t index = 0; index < observerCount; ++index) {
-                            IObserverHandle* handle = _observers[index];
-                            if (handle == nullptr) { continue; }
-                            ObserverType* observerAsT = dynamic_cast<ObserverType*>(handle->GetObserver());
-                            if (observerAsT != nullptr) { callback(observerAsT); }
+                            const Detail::InterfaceDispatchCache::Entry entry = bucket.entries[index];
+                            IObserver* observer = _observers[entry.slot].observer;
+                            if (observer == nullptr) {
+                                tally.Skipped();
+                                continue;
+                            }
+                            tally.Invoked();
+                            callback(static_cast<ObserverType*>(entry.observerInterface));
+                            if (timed) { start = _recordLatency(entry.slot, observer, start); }
                         }
                     } catch (...) {
                         _finishNotification();
@@ -70,16 +226,23 @@ namespace ESPressio {
                 }
 
             protected:
+                void UnregisterObserverRegistration(IObserver* observer, std::uint32_t registration) override {
+                    const auto slot = _slots.find(observer);
+                    if (slot == _slots.end() || slot->second.registration != registration) { return; }
+                    UnregisterObserver(observer);
+                }
+
                 class NotificationContext {
                     private:
                         friend class Observable;
                         Observable& _observable;
-                        std::shared_ptr<IObservable> _notificationLifetime;
+                        Detail::NotificationLifetime _notificationLifetime;
                         NotificationContext(
                             Observable& observable,
                             std::shared_ptr<IObservable> notificationLifetime)
                             : _observable(observable),
-                              _notificationLifetime(std::move(notificationLifetime)) {}
+                              _notificationLifetime(
+                                  observable, observable, std::move(notificationLifetime)) {}
 
                     public:
                         template <class Callback>
@@ -100,56 +263,160 @@ namespace ESPressio {
                 /// occur inside operation.
                 template <class Operation>
                 void ExecuteNotification(Operation&& operation) {
-                    NotificationContext context(
-                        *this, AcquireNotificationLifetime());
-                    operation(context);
+                    const auto execute = [this, &operation]() {
+                        NotificationContext context(
+                            *this,
+                            IsDestructionDeferred()
+                                ? std::shared_ptr<IObservable>()
+                                : AcquireNotificationLifetime());
+                        // Declared after the context, which may release the last owner.
+                        Detail::ObservableCounters::NotificationTimer timer(*this);
+                        operation(context);
+                    };
+                    if (_runToCompletion && !Detail::IsCascadeDispatching()) {
+                        Detail::RunToCompletion(execute);
+                        return;
+                    }
+                    execute();
+                }
+
+                /// Notifies every `ObserverType` Observer with `callback` or, while a
+                /// `NotificationTransaction` is open on this thread, defers it to
+                /// the transaction's commit. With `EnableRunToCompletion()`, one
+                /// raised while a run-to-completion notification dispatches on this
+                /// thread is queued behind it instead. `callback` is retained until
+                /// then, so it must capture by value.
+                template <class ObserverType, class Callback>
+                void ExecuteDeferrableNotification(Callback callback) {
+                    const auto dispatch = [this](const std::function<void(ObserverType*)>& visit) {
+                        ExecuteNotification([&visit](NotificationContext& notification) {
+                            notification.WithObservers<ObserverType>(visit);
+                        });
+                    };
+                    if (Detail::IsTransactionOpen()) {
+                        Detail::DeferNotification<ObserverType>(
+                            AcquireNotificationLifetime(), dispatch, std::move(callback));
+                        return;
+                    }
+                    if (_runToCompletion && Detail::IsCascadeDispatching()) {
+                        Detail::QueueNotification<ObserverType>(
+                            AcquireNotificationLifetime(), dispatch, std::move(callback));
+                        return;
+                    }
+                    ExecuteNotification([&callback](NotificationContext& notification) {
+                        notification.WithObservers<ObserverType>(callback);
+                    });
                 }
             public:
+                using Detail::ObservableCounters::GetStatistics;
+
+                /// Times every later callback, recording it in the Observer's
+                /// `IObserverHandle::GetLatencyHistogram()` and calling
+                /// `onSlowObserver`, if set, for callbacks longer than `budget`.
+                void EnableLatencyTracking(
+                    std::chrono::nanoseconds budget = std::chrono::nanoseconds::max(),
+                    SlowObserverHook onSlowObserver = SlowObserverHook()) {
+                    _latencyTracker.Enable(budget, std::move(onSlowObserver));
+                }
+
+                /// Stops timing callbacks; recorded histograms are kept.
+                void DisableLatencyTracking() noexcept {
+                    _latencyTracker.Disable();
+                }
+
+                /// Delivers notifications raised by callbacks one after another
+                /// rather than nested: from now on, a notification of this
+                /// Observable raised through `ExecuteDeferrableNotification()` while
+                /// a run-to-completion notification of any Observable dispatches on
+                /// this thread is queued, and the outermost one delivers the queue
+                /// in order once its own callbacks return. Stack usage no longer
+                /// grows with the length of a cascade, and unregistrations are
+                /// compacted between queued notifications. Notifications raised
+                /// through `ExecuteNotification()` still run immediately.
+                void EnableRunToCompletion() noexcept {
+                    _runToCompletion = true;
+                }
+
+                /// Delivers notifications raised by callbacks immediately again.
+                void DisableRunToCompletion() noexcept {
+                    _runToCompletion = false;
+                }
+
                 ~Observable() override {
                     BeginObservableDestruction();
-                    for (IObserverHandle* handle : _observers) {
-                        if (handle != nullptr) {
-                            static_cast<ObserverHandle*>(handle)->InvalidateRegistration();
-                        }
+                    for (const Detail::ObserverSlot& slot : _observers) {
+                        if (slot.handle != nullptr) { slot.handle->InvalidateRegistration(); }
                     }
                     _observers.clear();
+                    _slots.clear();
+                    _dispatchCache.Clear();
                 }
 
                 ObserverHandlePtr RegisterObserver(IObserver* observer) override {
                     if (observer == nullptr) {
                         throw InvalidObserverRegistrationException();
                     }
-                    for (auto thisObserver : _observers) {
-                        if (thisObserver != nullptr && thisObserver->GetObserver() == observer) {
-                            throw DuplicateObserverRegistrationException();
-                        }
+                    if (_slots.find(observer) != _slots.end()) {
+                        throw DuplicateObserverRegistrationException();
                     }
                     std::unique_ptr<ObserverHandle> handle(
                         new ObserverHandle(GetLifetimeControl(), observer));
-                    _observers.push_back(handle.get());
+                    _addSlot(Detail::ObserverSlot{observer, handle.get()}, 0);
                     return ObserverHandlePtr(handle.release());
                 }
 
-                void UnregisterObserver(IObserver* observer) override {
-                    for (auto thisObserver = _observers.begin(); thisObserver != _observers.end(); thisObserver++) {
-                        if ((*thisObserver)->GetObserver() == observer) {
-                            static_cast<ObserverHandle*>((*thisObserver))->InvalidateRegistration();
-                            if (_notificationDepth > 0) {
-                                *thisObserver = nullptr;
-                                _needsCompaction = true;
-                            } else {
-                                _observers.erase(thisObserver);
-                            }
-                            return;
-                        }
+                /// Registers `observer` like `RegisterObserver()`, returning an
+                /// `ObserverRegistration` instead of allocating a handle.
+                ObserverRegistration RegisterObserverByValue(IObserver* observer) {
+                    if (observer == nullptr) {
+                        throw InvalidObserverRegistrationException();
                     }
+                    if (_slots.find(observer) != _slots.end()) {
+                        throw DuplicateObserverRegistrationException();
+                    }
+                    const std::uint32_t registration = _registrationIds.Next();
+                    _addSlot(Detail::ObserverSlot{observer, nullptr}, registration);
+                    return ObserverRegistration(*this, observer, registration);
+                }
+
+                /// Registers every Observer in `observers` (any range of pointers
+                /// convertible to `IObserver*`), growing storage at most once.
+                /// Either every Observer is registered, with handles returned in the
+                /// same order, or an exception is thrown and none is.
+                template <class ObserverRange>
+                ObserverHandleBatch RegisterObservers(const ObserverRange& observers) {
+                    const std::vector<IObserver*> candidates = Detail::CollectObservers(observers);
+                    return _registerObservers(candidates);
+                }
+
+                ObserverHandleBatch RegisterObservers(std::initializer_list<IObserver*> observers) {
+                    return _registerObservers(std::vector<IObserver*>(observers));
+                }
+
+                void UnregisterObserver(IObserver* observer) override {
+                    if (_vacateSlot(observer)) { _compactIfWorthwhile(); }
+                }
+
+                /// Unregisters every registered Observer in `observers`, ignoring any
+                /// that are not registered, and compacts at most once.
+                template <class ObserverRange>
+                void UnregisterObservers(const ObserverRange& observers) {
+                    for (IObserver* observer : observers) { _vacateSlot(observer); }
+                    _compactIfWorthwhile();
+                }
+
+                void UnregisterObservers(std::initializer_list<IObserver*> observers) {
+                    UnregisterObservers<std::initializer_list<IObserver*> >(observers);
+                }
+
+                /// Pre-allocates storage for `observerCount` registered Observers.
+                void Reserve(std::size_t observerCount) {
+                    _observers.reserve(observerCount);
+                    _slots.reserve(observerCount);
                 }
 
                 bool IsObserverRegistered(IObserver* observer) override {
-                    for (auto thisObserver : _observers) {
-                        if (thisObserver->GetObserver() == observer) { return true; }
-                    }
-                    return false;
+                    return _slots.find(observer) != _slots.end();
                 }
         };
 
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/// Define as 1 to count notifications, callbacks, registrations and dispatch
+/// time for every `Observable`, `ThreadSafeObservable` and
+/// `ObservableWithBuckets`, reported by their `GetStatistics()`. When 0 the
+/// counters are empty and every recording call compiles away.
+#ifndef ESPRESSIO_OBSERVABLE_INSTRUMENTATION
+#define ESPRESSIO_OBSERVABLE_INSTRUMENTATION 0
+#endif
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        /// A copy of an Observable's instrumentation counters, taken by
+        /// `GetStatistics()`. Every field is zero unless
+        /// `ESPRESSIO_OBSERVABLE_INSTRUMENTATION` is 1.
+        struct ObservableStatistics {
+            /// Notification operations executed, including those that found
+            /// no Observers.
+            std::uint64_t notifications = 0;
+            std::uint64_t callbacksInvoked = 0;
+            /// Unregistered Observers passed over while dispatching.
+            std::uint64_t tombstonesSkipped = 0;
+            std::uint64_t compactions = 0;
+            std::uint64_t registrations = 0;
+            std::uint64_t unregistrations = 0;
+            /// Wall-clock time spent in notification operations.
+            std::uint64_t totalDispatchNanoseconds = 0;
+            std::uint64_t maxDispatchNanoseconds = 0;
+        };
+
+        namespace Detail {
+            /// Counts in relaxed atomics, so counters may be updated from any
+            /// thread; a snapshot taken during a notification may be partial.
+            class AtomicObservableCounters {
+                private:
+                    std::atomic<std::uint64_t> _notifications{0};
+                    std::atomic<std::uint64_t> _callbacksInvoked{0};
+                    std::atomic<std::uint64_t> _tombstonesSkipped{0};
+                    std::atomic<std::uint64_t> _compactions{0};
+                    std::atomic<std::uint64_t> _registrations{0};
+                    std::atomic<std::uint64_t> _unregistrations{0};
+                    std::atomic<std::uint64_t> _totalDispatchNanoseconds{0};
+                    std::atomic<std::uint64_t> _maxDispatchNanoseconds{0};
+
+                public:
+                    /// Times one notification operation, recording it when destroyed.
+                    class NotificationTimer {
+                        private:
+                            AtomicObservableCounters& _counters;
+                            std::chrono::steady_clock::time_point _start;
+
+                        public:
+                            explicit NotificationTimer(AtomicObservableCounters& counters) noexcept
+                                : _counters(counters), _start(std::chrono::steady_clock::now()) {}
+                            NotificationTimer(const NotificationTimer&) = delete;
+                            NotificationTimer& operator=(const NotificationTimer&) = delete;
+                            ~NotificationTimer() {
+                                const auto elapsed = std::chrono::steady_clock::now() - _start;
+                                _counters.RecordNotification(static_cast<std::uint64_t>(
+                                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+                            }
+                    };
+
+                    /// Tallies one dispatch loop locally, publishing it when destroyed.
+                    class DispatchTally {
+                        private:
+                            AtomicObservableCounters& _counters;
+                            std::uint64_t _invoked = 0;
+                            std::uint64_t _skipped = 0;
+
+                        public:
+                            explicit DispatchTally(AtomicObservableCounters& counters) noexcept
+                                : _counters(counters) {}
+                            DispatchTally(const DispatchTally&) = delete;
+                            DispatchTally& operator=(const DispatchTally&) = delete;
+                            ~DispatchTally() {
+                                if (_invoked != 0) {
+                                    _counters._callbacksInvoked.fetch_add(_invoked, std::memory_order_relaxed);
+                                }
+                                if (_skipped != 0) {
+                                    _counters._tombstonesSkipped.fetch_add(_skipped, std::memory_order_relaxed);
+                                }
+                            }
+
+                            void Invoked(std::size_t count = 1) noexcept { _invoked += count; }
+                            void Skipped(std::size_t count = 1) noexcept { _skipped += count; }
+                    };
+
+                    void RecordNotification(std::uint64_t nanoseconds) noexcept {
+                        _notifications.fetch_add(1, std::memory_order_relaxed);
+                        _totalDispatchNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+                        std::uint64_t maximum = _maxDispatchNanoseconds.load(std::memory_order_relaxed);
+                        while (nanoseconds > maximum &&
+                               !_maxDispatchNanoseconds.compare_exchange_weak(
+                                   maximum, nanoseconds, std::memory_order_relaxed)) {}
+                    }
+
+                    void RecordCompaction() noexcept {
+                        _compactions.fetch_add(1, std::memory_order_relaxed);
+                    }
+
+                    void RecordRegistrations(std::size_t count) noexcept {
+                        _registrations.fetch_add(count, std::memory_order_relaxed);
+                    }
+
+                    void RecordUnregistrations(std::size_t count) noexcept {
+                        _unregistrations.fetch_add(count, std::memory_order_relaxed);
+                    }
+
+                    /// Returns a copy of this Observable's instrumentation counters.
+                    ObservableStatistics GetStatistics() const noexcept {
+                        ObservableStatistics statistics;
+                        statistics.notifications = _notifications.load(std::memory_order_relaxed);
+                        statistics.callbacksInvoked = _callbacksInvoked.load(std::memory_order_relaxed);
+                        statistics.tombstonesSkipped = _tombstonesSkipped.load(std::memory_order_relaxed);
+                        statistics.compactions = _compactions.load(std::memory_order_relaxed);
+                        statistics.registrations = _registrations.load(std::memory_order_relaxed);
+                        statistics.unregistrations = _unregistrations.load(std::memory_order_relaxed);
+                        statistics.totalDispatchNanoseconds =
+                            _totalDispatchNanoseconds.load(std::memory_order_relaxed);
+                        statistics.maxDispatchNanoseconds =
+                            _maxDispatchNanoseconds.load(std::memory_order_relaxed);
+                        return statistics;
+                    }
+            };
+
+            /// The disabled policy: an empty base whose calls do nothing.
+            class NullObservableCounters {
+                public:
+                    class NotificationTimer {
+                        public:
+                            explicit NotificationTimer(NullObservableCounters&) noexcept {}
+                    };
+
+                    class DispatchTally {
+                        public:
+                            explicit DispatchTally(NullObservableCounters&) noexcept {}
+                            void Invoked(std::size_t = 1) noexcept {}
+                            void Skipped(std::size_t = 1) noexcept {}
+                    };
+
+                    void RecordNotification(std::uint64_t) noexcept {}
+                    void RecordCompaction() noexcept {}
+                    void RecordRegistrations(std::size_t) noexcept {}
+                    void RecordUnregistrations(std::size_t) noexcept {}
+
+                    /// Returns all-zero statistics; instrumentation is disabled.
+                    ObservableStatistics GetStatistics() const noexcept {
+                        return ObservableStatistics();
+                    }
+            };
+
+            /// Inherited privately by the Observable types, so the disabled policy
+            /// adds no storage.
+#if ESPRESSIO_OBSERVABLE_INSTRUMENTATION
+            using ObservableCounters = AtomicObservableCounters;
+#else
+            using ObservableCounters = NullObservableCounters;
+#endif
+        }
+
+    }
+
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_IObserver.hpp"
+#include "ESPressio_Observable.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        /// Notified by an `ObservableValue<T>` whenever its value changes.
+        template <class T>
+        class IValueObserver : public virtual IObserver {
+            public:
+                virtual ~IValueObserver() = default;
+                virtual void OnValueChanged(const T& previous, const T& current) = 0;
+        };
+
+        /// An `ObservableValue` comparator treating values within `epsilon` of each
+        /// other as equal.
+        template <class T>
+        class ApproximatelyEqual {
+            private:
+                T _epsilon;
+
+            public:
+                explicit ApproximatelyEqual(T epsilon) : _epsilon(epsilon) {}
+
+                bool operator()(const T& first, const T& second) const {
+                    return (first > second ? first - second : second - first) <= _epsilon;
+                }
+        };
+
+        namespace Detail {
+            struct NullMutex {
+                void lock() noexcept {}
+                void unlock() noexcept {}
+            };
+
+            template <class Base>
+            struct IsThreadSafeObservable : std::integral_constant<bool, Base::IsThreadSafe> {};
+        }
+
+        /// Holds a value of type `T` and notifies every `IValueObserver<T>` when it
+        /// changes, built on any Observable type `Base` (`Observable` by default).
+        /// Writes that `Equal` considers equal to the value Observers last saw are
+        /// not notified; as the comparison is always against that value, a slow
+        /// drift within an `ApproximatelyEqual` tolerance still notifies once it
+        /// accumulates. Writes inside `Coalesce()` are collapsed into a single
+        /// notification from the value before the outermost scope to the final one.
+        /// On a `Base` supporting `NotificationTransaction`, changes made inside a
+        /// transaction are deferred to its commit; a transaction destroyed
+        /// uncommitted discards them, and the next change is notified from the
+        /// value it set.
+        /// With a thread-safe `Base`, the value may be read and written from any
+        /// thread, and coalescing applies to every writer. Writers publish one at
+        /// a time, holding a lock across the notification, so Observers see
+        /// changes in the order they were made and end with the final value; a
+        /// write waits for a concurrent writer's notification to be delivered.
+        template <class T, class Base = Observable, class Equal = std::equal_to<T> >
+        class ObservableValue : public Base {
+            private:
+                using Mutex = typename std::conditional<
+                    Detail::IsThreadSafeObservable<Base>::value,
+                    std::mutex,
+                    Detail::NullMutex
+                >::type;
+                /// Recursive, so that a callback may write the value it observes.
+                using PublishMutex = typename std::conditional<
+                    Detail::IsThreadSafeObservable<Base>::value,
+                    std::recursive_mutex,
+                    Detail::NullMutex
+                >::type;
+
+                mutable Mutex _mutex;
+                /// Held by a writer from its write until its notification returns.
+                PublishMutex _publishMutex;
+                T _value;
+                /// The value Observers were last notified of.
+                T _notified;
+                Equal _equal;
+                std::size_t _coalescingDepth = 0;
+
+                /// Raises `callback` through `ExecuteDeferrableNotification()`, so that
+                /// an open `NotificationTransaction` defers it, when `Base` has one.
+                template <class Callback, class Self = ObservableValue>
+                auto _raiseChange(Callback callback, int)
+                    -> decltype(std::declval<Self&>().template ExecuteDeferrableNotification<
+                        IValueObserver<T> >(std::move(callback))) {
+                    return this->template ExecuteDeferrableNotification<IValueObserver<T> >(
+                        std::move(callback));
+                }
+
+                template <class Callback>
+                void _raiseChange(Callback callback, long) {
+                    this->ExecuteNotification(
+                        [&callback](typename Base::NotificationContext& notification) {
+                            notification.template WithObservers<IValueObserver<T> >(callback);
+                        });
+                }
+
+                /// Notifies Observers, after releasing `lock` on `_mutex`, when no
+                /// `Coalesce()` scope is open and `_value` differs from `_notified`.
+                /// Requires `_publishMutex`.
+                void _publishChange(std::unique_lock<Mutex>& lock) {
+                    if (_coalescingDepth > 0 || _equal(_value, _notified)) { return; }
+                    T previous(std::move(_notified));
+                    _notified = _value;
+                    T current(_value);
+                    lock.unlock();
+
+                    _raiseChange([previous, current](IValueObserver<T>* observer) {
+                        observer->OnValueChanged(previous, current);
+                    }, 0);
+                }
+
+                /// Ends a `Coalesce()` scope, even if its operation throws.
+                class CoalescingScope {
+                    private:
+                        ObservableValue& _value;
+
+                    public:
+                        explicit CoalescingScope(ObservableValue& value) : _value(value) {
+                            std::lock_guard<Mutex> lock(_value._mutex);
+                            ++_value._coalescingDepth;
+                        }
+                        CoalescingScope(const CoalescingScope&) = delete;
+                        CoalescingScope& operator=(const CoalescingScope&) = delete;
+                        ~CoalescingScope() {
+                            std::lock_guard<Mutex> lock(_value._mutex);
+                            --_value._coalescingDepth;
+                        }
+                };
+
+            public:
+                explicit ObservableValue(T initial = T(), Equal equal = Equal())
+                    : _value(initial), _notified(std::move(initial)), _equal(std::move(equal)) {}
+
+                T Get() const {
+                    std::lock_guard<Mutex> lock(_mutex);
+                    return _value;
+                }
+
+                /// Stores `value`, notifying Observers unless it equals the value they
+                /// last saw or a `Coalesce()` scope is open.
+                void Set(T value) {
+                    std::lock_guard<PublishMutex> publishing(_publishMutex);
+                    std::unique_lock<Mutex> lock(_mutex);
+                    _value = std::move(value);
+                    _publishChange(lock);
+                }
+
+                /// Runs `operation`, deferring notification of every write it makes
+                /// until it returns, then notifies once if the final value differs
+                /// from the value Observers last saw. Scopes may nest; only the
+                /// outermost notifies. If `operation` throws, nothing is notified and
+                /// the pending change is included in the next notification.
+                template <class Operation>
+                void Coalesce(Operation&& operation) {
+                    {
+                        CoalescingScope scope(*this);
+                        operation();
+                    }
+                    std::lock_guard<PublishMutex> publishing(_publishMutex);
+                    std::unique_lock<Mutex> lock(_mutex);
+                    _publishChange(lock);
+                }
+        };
+
+    }
+
+}
@@ -1,16 +1,29 @@
 #pragma once
 
 #include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <initializer_list>
 #include <memory>
+#include <mutex>
 #include <type_traits>
-#include <typeindex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "ESPressio_DeferredDestruction.hpp"
 #include "ESPressio_IObservable.hpp"
 #include "ESPressio_IObserver.hpp"
+#include "ESPressio_InterfaceId.hpp"
+#include "ESPressio_NotificationTransaction.hpp"
+#include "ESPressio_ObservableInstrumentation.hpp"
 #include "ESPressio_ObserverHandle.hpp"
+#include "ESPressio_ObserverRegistration.hpp"
+#include "ESPressio_ParallelDispatchPool.hpp"
+#include "ESPressio_RunToCompletion.hpp"
 
 namespace ESPressio {
 
@@ -30,46 +43,150 @@ namespace ESPressio {
                     std::is_polymorphic<ObserverInterface>::value &&
                     AllInterfacesPolymorphic<RemainingInterfaces...>::value
                 > {};
+
+            using ResolvedInterface = std::pair<std::size_t, void*>;
+
+            template <class ObserverInterface>
+            bool ResolveInterface(
+                IObserver* observer,
+                std::vector<ResolvedInterface>& resolvedInterfaces) {
+                ObserverInterface* observerInterface =
+                    ObserverCast<ObserverInterface>(observer);
+                if (observerInterface == nullptr) { return false; }
+
+                const std::size_t interfaceId = InterfaceId<ObserverInterface>::Value();
+                const auto duplicate = std::find_if(
+                    resolvedInterfaces.begin(), resolvedInterfaces.end(),
+                    [interfaceId](const ResolvedInterface& resolved) {
+                        return resolved.first == interfaceId;
+                    }
+                );
+                if (duplicate == resolvedInterfaces.end()) {
+                    resolvedInterfaces.emplace_back(
+                        interfaceId,
+                        static_cast<void*>(observerInterface)
+                    );
+                }
+                return true;
+            }
+
+            /// Returns the interface IDs of `resolvedInterfaces` in ascending
+            /// order, so two registrations' interface sets compare with `==`.
+            inline std::vector<std::size_t> SortedInterfaceIds(
+                const std::vector<ResolvedInterface>& resolvedInterfaces) {
+                std::vector<std::size_t> interfaceIds;
+                interfaceIds.reserve(resolvedInterfaces.size());
+                for (const ResolvedInterface& resolved : resolvedInterfaces) {
+                    interfaceIds.push_back(resolved.first);
+                }
+                std::sort(interfaceIds.begin(), interfaceIds.end());
+                return interfaceIds;
+            }
+
+            /// Resolves every requested interface of `observer`, ignoring repeats.
+            /// Throws when the Observer is null or does not implement them all.
+            template <class... ObserverInterfaces>
+            std::vector<ResolvedInterface> ResolveInterfaces(IObserver* observer) {
+                static_assert(
+                    sizeof...(ObserverInterfaces) > 0,
+                    "At least one Observer interface must be specified"
+                );
+                static_assert(
+                    AllInterfacesPolymorphic<ObserverInterfaces...>::value,
+                    "Every Observer interface must be polymorphic"
+                );
+
+                if (observer == nullptr) {
+                    throw InvalidObserverRegistrationException();
+                }
+
+                std::vector<ResolvedInterface> resolvedInterfaces;
+                resolvedInterfaces.reserve(sizeof...(ObserverInterfaces));
+
+                bool interfacesMatch = true;
+                const int resolveInterfaces[] = {
+                    0,
+                    (interfacesMatch =
+                        ResolveInterface<ObserverInterfaces>(
+                            observer, resolvedInterfaces
+                        ) && interfacesMatch,
+                     0)...
+                };
+                (void)resolveInterfaces;
+
+                if (!interfacesMatch) {
+                    throw ObserverInterfaceMismatchException();
+                }
+                return resolvedInterfaces;
+            }
         }
 
         /// A non-thread-safe Observable optimized for typed dispatch. Observer
         /// interfaces are supplied explicitly at registration so notification
-        /// performs no dynamic casts.
-        class ObservableWithBuckets : public IObservable {
+        /// performs no dynamic casts. Notifications can optionally be fanned out
+        /// across a `ParallelDispatchPool`; see `SetParallelDispatch()`, and
+        /// cascades raised by callbacks queued; see `EnableRunToCompletion()`.
+        class ObservableWithBuckets
+            : public IObservable,
+              public Detail::DeferredDestruction,
+              private Detail::ObservableCounters {
             private:
+                /// Unregistered during a notification, `observer` is nulled until
+                /// the buckets are compacted.
                 struct BucketEntry {
-                    ObserverHandle* handle;
+                    IObserver* observer;
                     void* observerInterface;
                 };
 
+                /// `handle` is null, and `registration` non-zero, for an
+                /// `ObserverRegistration`.
                 struct Registration {
                     ObserverHandle* handle;
-                    std::vector<std::type_index> interfaces;
+                    std::uint32_t registration;
+                    std::vector<std::size_t> interfaces;
                 };
 
                 using Bucket = std::vector<BucketEntry>;
 
-                std::unordered_map<std::type_index, Bucket> _buckets;
+                /// Indexed by `Detail::InterfaceId`; interfaces never registered
+                /// with this Observable are either out of range or empty.
+                std::vector<Bucket> _buckets;
                 std::unordered_map<IObserver*, Registration> _registrations;
+                Detail::RegistrationIds _registrationIds;
                 std::size_t _notificationDepth = 0;
                 bool _needsCompaction = false;
+                /// Serialises registration calls made by callbacks of a parallel
+                /// fan-out, which may run on several threads at once.
+                std::recursive_mutex _fanOutMutex;
+                std::shared_ptr<ParallelDispatchPool> _parallelPool;
+                std::size_t _parallelChunkSize = 0;
+                /// The bucket entries of the parallel fan-out in progress, if any,
+                /// keyed by their index in the bucket of `_fanOutInterface`.
+                Detail::FanOutSnapshot* _fanOut = nullptr;
+                std::size_t _fanOutInterface = 0;
+                /// Parallel fan-outs are not timed.
+                Detail::LatencyTracker _latencyTracker;
+                bool _runToCompletion = false;
+
+                /// Locks `_fanOutMutex` when called from within a callback of this
+                /// Observable's parallel fan-out; otherwise returns without locking.
+                std::unique_lock<std::recursive_mutex> _guardRegistrations() {
+                    if (!Detail::FanOutParticipant::IsParticipating(this)) {
+                        return std::unique_lock<std::recursive_mutex>();
+                    }
+                    return std::unique_lock<std::recursive_mutex>(_fanOutMutex);
+                }
 
                 void _compactBuckets() {
-                    for (auto bucketIterator = _buckets.begin();
-                            bucketIterator != _buckets.end();) {
-                        Bucket& bucket = bucketIterator->second;
+                    RecordCompaction();
+                    for (Bucket& bucket : _buckets) {
                         bucket.erase(
                             std::remove_if(
                                 bucket.begin(), bucket.end(),
                                 [](const BucketEntry& entry) {
-                                    return entry.handle == nullptr;
+                                    return entry.observer == nullptr;
                                 }),
                             bucket.end());
-                        if (bucket.empty()) {
-                            bucketIterator = _buckets.erase(bucketIterator);
-                        } else {
-                            ++bucketIterator;
-                        }
                     }
                     _needsCompaction = false;
                 }
@@ -80,96 +197,243 @@ namespace ESPressio {
                     }
                 }
 
-                static bool _containsInterface(
-                    const std::vector<std::type_index>& interfaces,
-                    const std::type_index& observerInterface) {
-                    return std::find(
-                        interfaces.begin(), interfaces.end(), observerInterface
-                    ) != interfaces.end();
+                /// Records a timed callback unless it unregistered its own Observer,
+                /// whose handle may already be destroyed.
+                Detail::LatencyTracker::Clock::time_point _recordLatency(
+                    std::size_t interfaceId,
+                    std::size_t index,
+                    IObserver* observer,
+                    Detail::LatencyTracker::Clock::time_point start) {
+                    const auto end = Detail::LatencyTracker::Clock::now();
+                    if (_buckets[interfaceId][index].observer != observer) { return end; }
+                    ObserverHandle* handle = _registrations.find(observer)->second.handle;
+                    return _latencyTracker.Record(
+                        handle != nullptr ? &handle->GetOrCreateLatencyHistogram() : nullptr,
+                        observer,
+                        start,
+                        end);
                 }
 
-                static bool _sameInterfaces(
-                    const std::vector<std::type_index>& left,
-                    const std::vector<std::type_index>& right) {
-                    if (left.size() != right.size()) { return false; }
-                    for (const std::type_index& observerInterface : left) {
-                        if (!_containsInterface(right, observerInterface)) {
-                            return false;
+                /// Removes the entries of bucket `interfaceId` whose Observer
+                /// `isRemoved` accepts or, during a notification, nulls them until
+                /// the buckets are compacted.
+                template <class Predicate>
+                void _removeFromBucket(std::size_t interfaceId, Predicate isRemoved) noexcept {
+                    Bucket& bucket = _buckets[interfaceId];
+                    if (_notificationDepth > 0) {
+                        for (std::size_t index = 0; index < bucket.size(); ++index) {
+                            BucketEntry& entry = bucket[index];
+                            if (entry.observer != nullptr && isRemoved(entry.observer)) {
+                                entry.observer = nullptr;
+                                entry.observerInterface = nullptr;
+                                _needsCompaction = true;
+                                if (_fanOut != nullptr && interfaceId == _fanOutInterface) {
+                                    _fanOut->Skip(index);
+                                }
+                            }
                         }
+                    } else {
+                        bucket.erase(
+                            std::remove_if(
+                                bucket.begin(), bucket.end(),
+                                [&isRemoved](const BucketEntry& entry) {
+                                    return isRemoved(entry.observer);
+                                }),
+                            bucket.end());
+                    }
+                }
+
+                void _removeFromBuckets(
+                    IObserver* observer,
+                    const std::vector<std::size_t>& interfaces) noexcept {
+                    for (const std::size_t interfaceId : interfaces) {
+                        _removeFromBucket(interfaceId, [observer](IObserver* entry) {
+                            return entry == observer;
+                        });
                     }
-                    return true;
                 }
 
-                template <class ObserverInterface>
-                static bool _resolveInterface(
+                /// Returns the sorted interface ids of a new registration of
+                /// `observer`, throwing if it is already registered.
+                std::vector<std::size_t> _validateRegistration(
                     IObserver* observer,
-                    std::vector<std::pair<std::type_index, void*> >& resolvedInterfaces) {
-                    ObserverInterface* observerInterface =
-                        dynamic_cast<ObserverInterface*>(observer);
-                    if (observerInterface == nullptr) { return false; }
-
-                    const std::type_index interfaceType(typeid(ObserverInterface));
-                    const auto duplicate = std::find_if(
-                        resolvedInterfaces.begin(), resolvedInterfaces.end(),
-                        [&interfaceType](
-                            const std::pair<std::type_index, void*>& resolved) {
-                            return resolved.first == interfaceType;
+                    const std::vector<Detail::ResolvedInterface>& resolvedInterfaces) const {
+                    std::vector<std::size_t> interfaceIds =
+                        Detail::SortedInterfaceIds(resolvedInterfaces);
+
+                    const auto existing = _registrations.find(observer);
+                    if (existing != _registrations.end()) {
+                        if (existing->second.interfaces != interfaceIds) {
+                            throw ObserverRegistrationConflictException();
                         }
-                    );
-                    if (duplicate == resolvedInterfaces.end()) {
-                        resolvedInterfaces.emplace_back(
-                            interfaceType,
-                            static_cast<void*>(observerInterface)
-                        );
+                        throw DuplicateObserverRegistrationException();
+                    }
+                    return interfaceIds;
+                }
+
+                void _addRegistration(
+                    IObserver* observer,
+                    const std::vector<Detail::ResolvedInterface>& resolvedInterfaces,
+                    Registration registration) {
+                    if (registration.interfaces.back() >= _buckets.size()) {
+                        _buckets.resize(registration.interfaces.back() + 1);
                     }
-                    return true;
+                    std::vector<std::size_t> insertedBuckets;
+                    insertedBuckets.reserve(resolvedInterfaces.size());
+
+                    try {
+                        for (const auto& resolved : resolvedInterfaces) {
+                            _buckets[resolved.first].push_back(
+                                BucketEntry{observer, resolved.second}
+                            );
+                            insertedBuckets.push_back(resolved.first);
+                        }
+
+                        _registrations.emplace(observer, std::move(registration));
+                    } catch (...) {
+                        _removeFromBuckets(observer, insertedBuckets);
+                        throw;
+                    }
+
+                    RecordRegistrations(1);
                 }
 
-                void _removeFromBuckets(const Registration& registration) noexcept {
-                    for (const std::type_index& observerInterface : registration.interfaces) {
-                        auto bucketIterator = _buckets.find(observerInterface);
-                        if (bucketIterator == _buckets.end()) { continue; }
+                template <class... ObserverInterfaces>
+                ObserverHandleBatch _registerObserversAs(const std::vector<IObserver*>& observers) {
+                    std::vector<std::vector<Detail::ResolvedInterface> > resolvedObservers;
+                    resolvedObservers.reserve(observers.size());
+                    for (IObserver* observer : observers) {
+                        resolvedObservers.push_back(
+                            Detail::ResolveInterfaces<ObserverInterfaces...>(observer));
+                    }
+                    if (observers.empty()) { return ObserverHandleBatch(); }
+
+                    // Every Observer resolved the same requested interfaces.
+                    const std::vector<std::size_t> interfaceIds =
+                        Detail::SortedInterfaceIds(resolvedObservers.front());
+                    for (IObserver* observer : observers) {
+                        const auto existing = _registrations.find(observer);
+                        if (existing == _registrations.end()) { continue; }
+                        if (existing->second.interfaces != interfaceIds) {
+                            throw ObserverRegistrationConflictException();
+                        }
+                        throw DuplicateObserverRegistrationException();
+                    }
+
+                    ObserverHandleBatch handles;
+                    handles.reserve(observers.size());
+                    if (interfaceIds.back() >= _buckets.size()) {
+                        _buckets.resize(interfaceIds.back() + 1);
+                    }
+                    for (const std::size_t interfaceId : interfaceIds) {
+                        Bucket& bucket = _buckets[interfaceId];
+                        bucket.reserve(bucket.size() + observers.size());
+                    }
+                    _registrations.reserve(_registrations.size() + observers.size());
 
-                        Bucket& bucket = bucketIterator->second;
-                        if (_notificationDepth > 0) {
-                            for (BucketEntry& entry : bucket) {
-                                if (entry.handle == registration.handle) {
-                                    entry.handle = nullptr;
-                                    entry.observerInterface = nullptr;
-                                    _needsCompaction = true;
-                                }
+                    std::size_t registered = 0;
+                    try {
+                        for (IObserver* observer : observers) {
+                            handles.emplace_back(new ObserverHandle(GetLifetimeControl(), observer));
+                        }
+                        for (; registered < observers.size(); ++registered) {
+                            ObserverHandle* handle =
+                                static_cast<ObserverHandle*>(handles[registered].get());
+                            if (!_registrations.emplace(
+                                    observers[registered],
+                                    Registration{handle, 0, interfaceIds}).second) {
+                                throw DuplicateObserverRegistrationException();
                             }
-                        } else {
-                            bucket.erase(
-                                std::remove_if(
-                                    bucket.begin(), bucket.end(),
-                                    [&registration](const BucketEntry& entry) {
-                                        return entry.handle == registration.handle;
-                                    }),
-                                bucket.end());
                         }
+                    } catch (...) {
+                        for (std::size_t index = 0; index < registered; ++index) {
+                            _registrations.erase(observers[index]);
+                        }
+                        for (ObserverHandlePtr& handle : handles) {
+                            static_cast<ObserverHandle*>(handle.get())->InvalidateRegistration();
+                        }
+                        throw;
+                    }
 
-                        if (_notificationDepth == 0 && bucket.empty()) {
-                            _buckets.erase(bucketIterator);
+                    for (std::size_t index = 0; index < observers.size(); ++index) {
+                        for (const Detail::ResolvedInterface& resolved : resolvedObservers[index]) {
+                            _buckets[resolved.first].push_back(
+                                BucketEntry{observers[index], resolved.second});
+                        }
+                    }
+                    RecordRegistrations(handles.size());
+                    return handles;
+                }
+
+                /// Requires a raised `_notificationDepth`.
+                template <class ObserverType, class Callback>
+                void _withObserversInParallel(
+                    std::size_t interfaceId,
+                    Callback& callback,
+                    Detail::ObservableCounters::DispatchTally& tally) {
+                    const Bucket& bucket = _buckets[interfaceId];
+                    Detail::FanOutSnapshot snapshot(bucket.size());
+                    for (std::size_t index = 0; index < bucket.size(); ++index) {
+                        if (bucket[index].observer != nullptr) {
+                            snapshot.Add(index, bucket[index].observerInterface);
                         }
                     }
+                    tally.Invoked(snapshot.GetCount());
+                    tally.Skipped(bucket.size() - snapshot.GetCount());
+
+                    const std::shared_ptr<ParallelDispatchPool> pool = _parallelPool;
+                    _fanOut = &snapshot;
+                    _fanOutInterface = interfaceId;
+                    std::vector<std::exception_ptr> exceptions;
+                    try {
+                        exceptions = pool->ForEach(
+                            snapshot.GetCount(), _parallelChunkSize,
+                            [this, &snapshot, &callback](std::size_t index) {
+                                Detail::FanOutParticipant participant(this);
+                                void* observer = snapshot.GetLive(index);
+                                if (observer != nullptr) {
+                                    callback(static_cast<ObserverType*>(observer));
+                                }
+                            });
+                    } catch (...) {
+                        _fanOut = nullptr;
+                        throw;
+                    }
+                    _fanOut = nullptr;
+                    if (!exceptions.empty()) {
+                        throw ParallelNotificationException(std::move(exceptions));
+                    }
                 }
 
                 /// Dispatch uses the interface pointer resolved during registration.
+                /// `_buckets` may grow during a callback, so entries are read by
+                /// index rather than through a retained bucket reference.
                 template <class ObserverType, class Callback>
                 void _withObservers(Callback&& callback) {
-                    const auto bucketIterator =
-                        _buckets.find(std::type_index(typeid(ObserverType)));
-                    if (bucketIterator == _buckets.end()) { return; }
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    const std::size_t interfaceId =
+                        Detail::InterfaceId<ObserverType>::Value();
+                    if (interfaceId >= _buckets.size()) { return; }
 
                     ++_notificationDepth;
-                    Bucket& bucket = bucketIterator->second;
-                    const std::size_t observerCount = bucket.size();
+                    const std::size_t observerCount = _buckets[interfaceId].size();
                     try {
-                        for (std::size_t index = 0; index < observerCount; ++index) {
-                            const BucketEntry& entry = bucket[index];
-                            if (entry.handle != nullptr) {
+                        Detail::ObservableCounters::DispatchTally tally(*this);
+                        if (_parallelPool && observerCount > _parallelChunkSize && _fanOut == nullptr) {
+                            _withObserversInParallel<ObserverType>(interfaceId, callback, tally);
+                        } else {
+                            const bool timed = _latencyTracker.IsEnabled();
+                            Detail::LatencyTracker::Clock::time_point start;
+                            if (timed) { start = Detail::LatencyTracker::Clock::now(); }
+                            for (std::size_t index = 0; index < observerCount; ++index) {
+                                const BucketEntry entry = _buckets[interfaceId][index];
+                                if (entry.observer == nullptr) {
+                                    tally.Skipped();
+                                    continue;
+                                }
+                                tally.Invoked();
                                 callback(static_cast<ObserverType*>(entry.observerInterface));
+                                if (timed) { start = _recordLatency(interfaceId, index, entry.observer, start); }
                             }
                         }
                     } catch (...) {
@@ -180,16 +444,26 @@ namespace ESPressio {
                 }
 
             protected:
+                void UnregisterObserverRegistration(IObserver* observer, std::uint32_t registration) override {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    const auto existing = _registrations.find(observer);
+                    if (existing == _registrations.end() || existing->second.registration != registration) {
+                        return;
+                    }
+                    UnregisterObserver(observer);
+                }
+
                 class NotificationContext {
                     private:
                         friend class ObservableWithBuckets;
                         ObservableWithBuckets& _observable;
-                        std::shared_ptr<IObservable> _notificationLifetime;
+                        Detail::NotificationLifetime _notificationLifetime;
                         NotificationContext(
                             ObservableWithBuckets& observable,
                             std::shared_ptr<IObservable> notificationLifetime)
                             : _observable(observable),
-                              _notificationLifetime(std::move(notificationLifetime)) {}
+                              _notificationLifetime(
+                                  observable, observable, std::move(notificationLifetime)) {}
 
                     public:
                         template <class ObserverType, class Callback>
@@ -201,16 +475,96 @@ namespace ESPressio {
 
                 template <class Operation>
                 void ExecuteNotification(Operation&& operation) {
-                    NotificationContext context(
-                        *this, AcquireNotificationLifetime());
-                    operation(context);
+                    const auto execute = [this, &operation]() {
+                        // Callbacks of a parallel fan-out may notify from several
+                        // threads at once, so their notification lifetimes, counted
+                        // in a plain integer when destruction is deferred, are
+                        // taken and released under the fan-out guard.
+                        std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                        NotificationContext context(
+                            *this,
+                            IsDestructionDeferred()
+                                ? std::shared_ptr<IObservable>()
+                                : AcquireNotificationLifetime());
+                        // Declared after the context, which may release the last owner.
+                        Detail::ObservableCounters::NotificationTimer timer(*this);
+                        operation(context);
+                    };
+                    if (_runToCompletion && !Detail::IsCascadeDispatching()) {
+                        Detail::RunToCompletion(execute);
+                        return;
+                    }
+                    execute();
+                }
+
+                /// Notifies every `ObserverType` Observer with `callback` or, while a
+                /// `NotificationTransaction` is open on this thread, defers it to
+                /// the transaction's commit. With `EnableRunToCompletion()`, one
+                /// raised while a run-to-completion notification dispatches on this
+                /// thread is queued behind it instead. `callback` is retained until
+                /// then, so it must capture by value.
+                template <class ObserverType, class Callback>
+                void ExecuteDeferrableNotification(Callback callback) {
+                    const auto dispatch = [this](const std::function<void(ObserverType*)>& visit) {
+                        ExecuteNotification([&visit](NotificationContext& notification) {
+                            notification.WithObservers<ObserverType>(visit);
+                        });
+                    };
+                    if (Detail::IsTransactionOpen()) {
+                        Detail::DeferNotification<ObserverType>(
+                            AcquireNotificationLifetime(), dispatch, std::move(callback));
+                        return;
+                    }
+                    if (_runToCompletion && Detail::IsCascadeDispatching()) {
+                        Detail::QueueNotification<ObserverType>(
+                            AcquireNotificationLifetime(), dispatch, std::move(callback));
+                        return;
+                    }
+                    ExecuteNotification([&callback](NotificationContext& notification) {
+                        notification.WithObservers<ObserverType>(callback);
+                    });
                 }
 
             public:
+                using Detail::ObservableCounters::GetStatistics;
+
+                /// Times every later serial callback, recording it in the Observer's
+                /// `IObserverHandle::GetLatencyHistogram()` and calling
+                /// `onSlowObserver`, if set, for callbacks longer than `budget`.
+                /// Callbacks fanned out by `SetParallelDispatch()` are not timed.
+                void EnableLatencyTracking(
+                    std::chrono::nanoseconds budget = std::chrono::nanoseconds::max(),
+                    SlowObserverHook onSlowObserver = SlowObserverHook()) {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    _latencyTracker.Enable(budget, std::move(onSlowObserver));
+                }
+
+                /// Stops timing callbacks; recorded histograms are kept.
+                void DisableLatencyTracking() {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    _latencyTracker.Disable();
+                }
+
+                /// Queues notifications raised through `ExecuteDeferrableNotification()`
+                /// while a run-to-completion notification dispatches on this thread,
+                /// as `Observable::EnableRunToCompletion()` does.
+                void EnableRunToCompletion() {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    _runToCompletion = true;
+                }
+
+                /// Delivers notifications raised by callbacks immediately again.
+                void DisableRunToCompletion() {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    _runToCompletion = false;
+                }
+
                 ~ObservableWithBuckets() override {
                     BeginObservableDestruction();
                     for (auto& registration : _registrations) {
-                        registration.second.handle->InvalidateRegistration();
+                        if (registration.second.handle != nullptr) {
+                            registration.second.handle->InvalidateRegistration();
+                        }
                     }
                     _buckets.clear();
                     _registrations.clear();
@@ -218,88 +572,134 @@ namespace ESPressio {
 
                 template <class... ObserverInterfaces>
                 ObserverHandlePtr RegisterObserverAs(IObserver* observer) {
-                    static_assert(
-                        sizeof...(ObserverInterfaces) > 0,
-                        "At least one Observer interface must be specified"
-                    );
-                    static_assert(
-                        Detail::AllInterfacesPolymorphic<ObserverInterfaces...>::value,
-                        "Every Observer interface must be polymorphic"
-                    );
-
-                    if (observer == nullptr) {
-                        throw InvalidObserverRegistrationException();
-                    }
-
-                    std::vector<std::pair<std::type_index, void*> > resolvedInterfaces;
-                    resolvedInterfaces.reserve(sizeof...(ObserverInterfaces));
-
-                    bool interfacesMatch = true;
-                    const int resolveInterfaces[] = {
-                        0,
-                        (interfacesMatch =
-                            _resolveInterface<ObserverInterfaces>(
-                                observer, resolvedInterfaces
-                            ) && interfacesMatch,
-                         0)...
-                    };
-                    (void)resolveInterfaces;
-
-                    if (!interfacesMatch) {
-                        throw ObserverInterfaceMismatchException();
-                    }
-
-                    std::vector<std::type_index> interfaceTypes;
-                    interfaceTypes.reserve(resolvedInterfaces.size());
-                    for (const auto& resolved : resolvedInterfaces) {
-                        interfaceTypes.push_back(resolved.first);
-                    }
-
-                    const auto existing = _registrations.find(observer);
-                    if (existing != _registrations.end()) {
-                        if (!_sameInterfaces(existing->second.interfaces, interfaceTypes)) {
-                            throw ObserverRegistrationConflictException();
-                        }
-                        throw DuplicateObserverRegistrationException();
-                    }
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    const std::vector<Detail::ResolvedInterface> resolvedInterfaces =
+                        Detail::ResolveInterfaces<ObserverInterfaces...>(observer);
+                    std::vector<std::size_t> interfaceIds = _validateRegistration(observer, resolvedInterfaces);
 
                     std::unique_ptr<ObserverHandle> handle(
                         new ObserverHandle(GetLifetimeControl(), observer));
-                    ObserverHandle* result = handle.get();
-                    std::vector<std::type_index> insertedBuckets;
-                    insertedBuckets.reserve(resolvedInterfaces.size());
+                    _addRegistration(
+                        observer, resolvedInterfaces,
+                        Registration{handle.get(), 0, std::move(interfaceIds)});
+                    return ObserverHandlePtr(handle.release());
+                }
 
-                    try {
-                        for (const auto& resolved : resolvedInterfaces) {
-                            _buckets[resolved.first].push_back(
-                                BucketEntry{result, resolved.second}
-                            );
-                            insertedBuckets.push_back(resolved.first);
-                        }
+                /// Registers `observer` like `RegisterObserverAs()`, returning an
+                /// `ObserverRegistration` instead of allocating a handle.
+                template <class... ObserverInterfaces>
+                ObserverRegistration RegisterObserverByValueAs(IObserver* observer) {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    const std::vector<Detail::ResolvedInterface> resolvedInterfaces =
+                        Detail::ResolveInterfaces<ObserverInterfaces...>(observer);
+                    std::vector<std::size_t> interfaceIds = _validateRegistration(observer, resolvedInterfaces);
+
+                    const std::uint32_t registration = _registrationIds.Next();
+                    _addRegistration(
+                        observer, resolvedInterfaces,
+                        Registration{nullptr, registration, std::move(interfaceIds)});
+                    return ObserverRegistration(*this, observer, registration);
+                }
 
-                        _registrations.emplace(
-                            observer,
-                            Registration{result, std::move(interfaceTypes)}
-                        );
-                    } catch (...) {
-                        Registration partial{result, std::move(insertedBuckets)};
-                        _removeFromBuckets(partial);
-                        throw;
-                    }
+                /// Registers every Observer in `observers` (any range of pointers
+                /// convertible to `IObserver*`) for the same interfaces, growing each
+                /// affected bucket at most once. Either every Observer is registered,
+                /// with handles returned in the same order, or an exception is thrown
+                /// and none is.
+                template <class... ObserverInterfaces, class ObserverRange>
+                ObserverHandleBatch RegisterObserversAs(const ObserverRange& observers) {
+                    const std::vector<IObserver*> candidates = Detail::CollectObservers(observers);
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    return _registerObserversAs<ObserverInterfaces...>(candidates);
+                }
 
-                    return ObserverHandlePtr(handle.release());
+                template <class... ObserverInterfaces>
+                ObserverHandleBatch RegisterObserversAs(std::initializer_list<IObserver*> observers) {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    return _registerObserversAs<ObserverInterfaces...>(
+                        std::vector<IObserver*>(observers));
                 }
 
                 void UnregisterObserver(IObserver* observer) override {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
                     const auto registration = _registrations.find(observer);
                     if (registration == _registrations.end()) { return; }
 
-                    registration->second.handle->InvalidateRegistration();
-                    _removeFromBuckets(registration->second);
+                    if (registration->second.handle != nullptr) {
+                        registration->second.handle->InvalidateRegistration();
+                    }
+                    _removeFromBuckets(observer, registration->second.interfaces);
                     _registrations.erase(registration);
+                    RecordUnregistrations(1);
+                }
+
+                /// Unregisters every registered Observer in `observers`, ignoring any
+                /// that are not registered.
+                /// Takes the registration guard once and sweeps each affected bucket
+                /// once, however many Observers are removed.
+                template <class ObserverRange>
+                void UnregisterObservers(const ObserverRange& observers) {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    std::vector<IObserver*> removed;
+                    std::vector<std::size_t> interfaces;
+                    for (IObserver* observer : observers) {
+                        const auto registration = _registrations.find(observer);
+                        if (registration == _registrations.end()) { continue; }
+
+                        if (registration->second.handle != nullptr) {
+                            registration->second.handle->InvalidateRegistration();
+                        }
+                        interfaces.insert(
+                            interfaces.end(),
+                            registration->second.interfaces.begin(),
+                            registration->second.interfaces.end());
+                        removed.push_back(observer);
+                        _registrations.erase(registration);
+                    }
+                    if (removed.empty()) { return; }
+
+                    std::sort(removed.begin(), removed.end(), std::less<IObserver*>());
+                    std::sort(interfaces.begin(), interfaces.end());
+                    interfaces.erase(std::unique(interfaces.begin(), interfaces.end()), interfaces.end());
+                    for (const std::size_t interfaceId : interfaces) {
+                        _removeFromBucket(interfaceId, [&removed](IObserver* entry) {
+                            return std::binary_search(
+                                removed.begin(), removed.end(), entry, std::less<IObserver*>());
+                        });
+                    }
+                    RecordUnregistrations(removed.size());
+                }
+
+                void UnregisterObservers(std::initializer_list<IObserver*> observers) {
+                    UnregisterObservers<std::initializer_list<IObserver*> >(observers);
+                }
+
+                /// Pre-allocates registration storage for `observerCount` Observers.
+                /// Buckets are not reserved, as how many Observers each interface
+                /// receives is only known at registration.
+                void Reserve(std::size_t observerCount) {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    _registrations.reserve(observerCount);
+                }
+
+                /// Dispatches notifications to more than `chunkSize` Observers across
+                /// `pool`, in chunks of `chunkSize`, or serially again when `pool` is
+                /// null. The notifying thread participates and returns once every
+                /// callback has completed; callbacks must therefore be safe to run
+                /// concurrently, and may register or unregister with this Observable
+                /// even though it is otherwise not thread-safe. Every callback runs
+                /// even if others throw, after which a `ParallelNotificationException`
+                /// carries their exceptions.
+                void SetParallelDispatch(
+                    std::shared_ptr<ParallelDispatchPool> pool,
+                    std::size_t chunkSize = 16) {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
+                    _parallelPool = std::move(pool);
+                    _parallelChunkSize = std::max<std::size_t>(chunkSize, 1);
                 }
 
                 bool IsObserverRegistered(IObserver* observer) override {
+                    std::unique_lock<std::recursive_mutex> guard = _guardRegistrations();
                     return _registrations.find(observer) != _registrations.end();
                 }
         };
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
 #include <memory>
 
+#include "ESPressio_BlockAllocator.hpp"
 #include "ESPressio_IObservable.hpp"
 #include "ESPressio_IObserver.hpp"
 
@@ -14,11 +16,20 @@ namespace ESPressio {
             private:
                 friend class Observable;
                 friend class ObservableWithBuckets;
+                friend class ShardedThreadSafeObservable;
                 friend class ThreadSafeObservable;
+                friend class ThreadSafeObservableWithBuckets;
+                friend class ThreadSafeSnapshotObservable;
+                template <class... ObserverInterfaces>
+                friend class StaticObservable;
+                template <class ObserverInterface>
+                friend class TypedObservable;
 
                 std::shared_ptr<Detail::ObservableLifetimeControl> _lifetimeControl;
                 std::atomic<IObserver*> _observer;
                 std::atomic<bool> _registered{true};
+                /// Allocated by the first callback timed for this registration.
+                std::atomic<Detail::LatencyHistogram*> _latencyHistogram{nullptr};
 
                 static std::shared_ptr<Detail::ObservableLifetimeControl>
                 GetValidatedLifetimeControl(IObservable* observable) {
@@ -49,6 +60,18 @@ namespace ESPressio {
                     _observer.store(nullptr);
                 }
 
+                Detail::LatencyHistogram& GetOrCreateLatencyHistogram() {
+                    Detail::LatencyHistogram* histogram =
+                        _latencyHistogram.load(std::memory_order_acquire);
+                    if (histogram != nullptr) { return *histogram; }
+                    std::unique_ptr<Detail::LatencyHistogram> created(new Detail::LatencyHistogram());
+                    if (_latencyHistogram.compare_exchange_strong(
+                            histogram, created.get(), std::memory_order_acq_rel)) {
+                        return *created.release();
+                    }
+                    return *histogram;
+                }
+
             private:
                 ObserverHandle(IObservable* observable, IObserver* observer)
                     : ObserverHandle(GetValidatedLifetimeControl(observable), observer) {}
@@ -67,6 +90,14 @@ namespace ESPressio {
                 ObserverHandle(ObserverHandle&&) = delete;
                 ObserverHandle& operator=(ObserverHandle&&) = delete;
 
+                static void* operator new(std::size_t size) {
+                    return Detail::ObservableBlockAllocator::Allocate(size);
+                }
+
+                static void operator delete(void* handle, std::size_t size) noexcept {
+                    Detail::ObservableBlockAllocator::Deallocate(handle, size);
+                }
+
                 ~ObserverHandle() noexcept override {
                     try {
                         Unregister();
@@ -74,6 +105,7 @@ namespace ESPressio {
                         // Destructors must not propagate exceptions. Explicitly call
                         // Unregister() when registration errors need to be observed.
                     }
+                    delete _latencyHistogram.load(std::memory_order_acquire);
                 }
 
                 void Unregister() override {
@@ -106,6 +138,12 @@ namespace ESPressio {
                 IObserver* GetObserver() override {
                     return _observer.load();
                 }
+
+                ObserverLatencyHistogram GetLatencyHistogram() const override {
+                    const Detail::LatencyHistogram* histogram =
+                        _latencyHistogram.load(std::memory_order_acquire);
+                    return histogram != nullptr ? histogram->GetSnapshot() : ObserverLatencyHistogram();
+                }
         };
 
     }
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "ESPressio_IObserver.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        /// A copy of the callback latencies recorded for one registration while
+        /// its Observable had latency tracking enabled. Bucket 0 counts
+        /// callbacks under 1 ns, and bucket `b` those taking [2^(b-1), 2^b) ns;
+        /// the last bucket also counts anything longer.
+        struct ObserverLatencyHistogram {
+            static constexpr std::size_t BucketCount = 40;
+
+            std::array<std::uint64_t, BucketCount> counts{};
+
+            std::uint64_t GetSampleCount() const noexcept {
+                std::uint64_t samples = 0;
+                for (const std::uint64_t count : counts) { samples += count; }
+                return samples;
+            }
+
+            /// Returns the upper bound, in nanoseconds, of the bucket holding the
+            /// `percentile` (0 to 100) sample, or 0 when nothing was recorded.
+            std::uint64_t GetPercentileNanoseconds(double percentile) const noexcept {
+                const std::uint64_t samples = GetSampleCount();
+                if (samples == 0) { return 0; }
+                const double rank = percentile / 100.0 * static_cast<double>(samples);
+                std::uint64_t seen = 0;
+                for (std::size_t bucket = 0; bucket < BucketCount; ++bucket) {
+                    seen += counts[bucket];
+                    if (counts[bucket] != 0 && static_cast<double>(seen) >= rank) {
+                        return std::uint64_t(1) << bucket;
+                    }
+                }
+                return std::uint64_t(1) << (BucketCount - 1);
+            }
+        };
+
+        /// Invoked on the notifying thread when an Observer's callback exceeds
+        /// the budget given to `EnableLatencyTracking()`. It may unregister
+        /// the Observer.
+        using SlowObserverHook =
+            std::function<void(IObserver* observer, std::chrono::nanoseconds elapsed)>;
+
+        namespace Detail {
+            /// Counts in relaxed atomics, so a snapshot may be read while a
+            /// notification records into it.
+            class LatencyHistogram {
+                private:
+                    std::atomic<std::uint64_t> _counts[ObserverLatencyHistogram::BucketCount];
+
+                    /// The bit length of `nanoseconds`, capped at the last bucket.
+                    static std::size_t _bucketOf(std::uint64_t nanoseconds) noexcept {
+                        std::size_t bits = 0;
+                        for (std::size_t shift = 32; shift > 0; shift /= 2) {
+                            if ((nanoseconds >> shift) != 0) {
+                                nanoseconds >>= shift;
+                                bits += shift;
+                            }
+                        }
+                        bits += nanoseconds != 0 ? 1 : 0;
+                        return bits < ObserverLatencyHistogram::BucketCount
+                            ? bits
+                            : ObserverLatencyHistogram::BucketCount - 1;
+                    }
+
+                public:
+                    LatencyHistogram() noexcept {
+                        for (std::atomic<std::uint64_t>& count : _counts) {
+                            count.store(0, std::memory_order_relaxed);
+                        }
+                    }
+
+                    LatencyHistogram(const LatencyHistogram&) = delete;
+                    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+                    void Record(std::uint64_t nanoseconds) noexcept {
+                        _counts[_bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+                    }
+
+                    ObserverLatencyHistogram GetSnapshot() const noexcept {
+                        ObserverLatencyHistogram snapshot;
+                        for (std::size_t bucket = 0; bucket < ObserverLatencyHistogram::BucketCount; ++bucket) {
+                            snapshot.counts[bucket] = _counts[bucket].load(std::memory_order_relaxed);
+                        }
+                        return snapshot;
+                    }
+            };
+
+            /// An Observable's latency tracking settings. Guarded as the owning
+            /// Observable guards its registrations.
+            class LatencyTracker {
+                public:
+                    using Clock = std::chrono::steady_clock;
+
+                private:
+                    bool _enabled = false;
+                    std::chrono::nanoseconds _budget = std::chrono::nanoseconds::max();
+                    SlowObserverHook _onSlowObserver;
+
+                public:
+                    bool IsEnabled() const noexcept {
+                        return _enabled;
+                    }
+
+                    void Enable(std::chrono::nanoseconds budget, SlowObserverHook onSlowObserver) {
+                        _onSlowObserver = std::move(onSlowObserver);
+                        _budget = budget;
+                        _enabled = true;
+                    }
+
+                    void Disable() noexcept {
+                        _enabled = false;
+                    }
+
+                    /// Records the callback to `observer` that ran from `start` to
+                    /// `end` in `histogram`, if any, then reports it if it exceeded
+                    /// the budget. The hook is copied first, so it may change these
+                    /// settings. Returns when the next callback's timing starts, so
+                    /// the loop reads the clock once per callback and the hook is
+                    /// never counted.
+                    Clock::time_point Record(
+                        LatencyHistogram* histogram,
+                        IObserver* observer,
+                        Clock::time_point start,
+                        Clock::time_point end) {
+                        const std::chrono::nanoseconds elapsed =
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+                        if (histogram != nullptr) {
+                            histogram->Record(static_cast<std::uint64_t>(elapsed.count()));
+                        }
+                        if (elapsed <= _budget || !_onSlowObserver) { return end; }
+                        const SlowObserverHook onSlowObserver = _onSlowObserver;
+                        onSlowObserver(observer, elapsed);
+                        return Clock::now();
+                    }
+            };
+        }
+
+    }
+
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_IObserver.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        namespace Detail {
+            /// Issues the non-zero ids that tell an Observer's successive
+            /// `ObserverRegistration`s apart. Guarded by the owning Observable.
+            class RegistrationIds {
+                private:
+                    std::uint32_t _last = 0;
+
+                public:
+                    std::uint32_t Next() noexcept {
+                        if (++_last == 0) { ++_last; }
+                        return _last;
+                    }
+            };
+        }
+
+        /// A move-only alternative to `ObserverHandlePtr`, returned by
+        /// `RegisterObserverByValue()` on `Observable`, `ThreadSafeObservable` and
+        /// `TypedObservable`, and `RegisterObserverByValueAs<...>()` on
+        /// `ObservableWithBuckets`.
+        /// It allocates nothing, so it can live inline in the Observer, and it
+        /// unregisters the Observer when destroyed or assigned over.
+        /// Unlike an `IObserverHandle` it is not told when its Observer is
+        /// unregistered by other means, so `GetObservable()` keeps returning the
+        /// Observable until that Observable begins destruction, and no latency
+        /// histogram is kept for it.
+        class ObserverRegistration {
+            private:
+                friend class Observable;
+                friend class ObservableWithBuckets;
+                friend class ThreadSafeObservable;
+                template <class ObserverInterface>
+                friend class TypedObservable;
+
+                Detail::ObservableLifetimeControl* _lifetimeControl = nullptr;
+                IObserver* _observer = nullptr;
+                /// Issued by the Observable; distinguishes this registration from a
+                /// later one of the same Observer.
+                std::uint32_t _registration = 0;
+
+                ObserverRegistration(
+                    IObservable& observable,
+                    IObserver* observer,
+                    std::uint32_t registration) noexcept
+                    : _lifetimeControl(observable._lifetimeControl.get()),
+                      _observer(observer),
+                      _registration(registration) {
+                    _lifetimeControl->AddReference();
+                }
+
+                void _release() noexcept {
+                    if (_lifetimeControl != nullptr) { _lifetimeControl->ReleaseReference(); }
+                    _lifetimeControl = nullptr;
+                    _observer = nullptr;
+                    _registration = 0;
+                }
+
+            public:
+                ObserverRegistration() noexcept = default;
+                ObserverRegistration(const ObserverRegistration&) = delete;
+                ObserverRegistration& operator=(const ObserverRegistration&) = delete;
+
+                ObserverRegistration(ObserverRegistration&& other) noexcept
+                    : _lifetimeControl(other._lifetimeControl),
+                      _observer(other._observer),
+                      _registration(other._registration) {
+                    other._lifetimeControl = nullptr;
+                    other._observer = nullptr;
+                    other._registration = 0;
+                }
+
+                /// Unregisters the current Observer, if any, before taking over
+                /// `other`. If unregistration throws, neither side changes.
+                ObserverRegistration& operator=(ObserverRegistration&& other) {
+                    if (this == &other) { return *this; }
+                    Unregister();
+                    _lifetimeControl = other._lifetimeControl;
+                    _observer = other._observer;
+                    _registration = other._registration;
+                    other._lifetimeControl = nullptr;
+                    other._observer = nullptr;
+                    other._registration = 0;
+                    return *this;
+                }
+
+                ~ObserverRegistration() {
+                    try {
+                        Unregister();
+                    } catch (...) {
+                        // Destructors must not propagate exceptions. Explicitly call
+                        // Unregister() when registration errors need to be observed.
+                    }
+                    _release();
+                }
+
+                /// Unregisters the Observer from the Observable if it still exists,
+                /// leaving this registration empty. If unregistration throws, the
+                /// registration is kept so it may be retried.
+                void Unregister() {
+                    if (_lifetimeControl == nullptr) { return; }
+
+                    IObservable* observable = _lifetimeControl->Acquire();
+                    if (observable != nullptr) {
+                        try {
+                            observable->UnregisterObserverRegistration(_observer, _registration);
+                        } catch (...) {
+                            _lifetimeControl->Release();
+                            throw;
+                        }
+                        _lifetimeControl->Release();
+                    }
+                    _release();
+                }
+
+                /// Returns the associated `IObservable`, or nullptr once it has begun
+                /// destruction or this registration is empty. The returned pointer is
+                /// non-owning and must not be retained.
+                IObservable* GetObservable() const {
+                    return _lifetimeControl != nullptr ? _lifetimeControl->Peek() : nullptr;
+                }
+
+                /// Returns the registered Observer, or nullptr if this registration
+                /// is empty.
+                IObserver* GetObserver() const noexcept {
+                    return _observer;
+                }
+
+                /// Returns `true` until the registration is unregistered or moved from.
+                explicit operator bool() const noexcept {
+                    return _lifetimeControl != nullptr;
+                }
+        };
+
+    }
+
+}
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        /// A fixed set of worker threads shared by the Observables configured with
+        /// `SetParallelDispatch()`. A parallel fan-out divides the Observers into
+        /// one contiguous range per participant (each worker and the notifying
+        /// thread). Each participant takes chunks from the front of its own range
+        /// and, once that is exhausted, steals the back half of another
+        /// participant's remaining range.
+        /// The pool runs one fan-out at a time. A fan-out requested while the pool
+        /// is busy, or from within a callback it is running, executes serially on
+        /// the calling thread instead of waiting.
+        class ParallelDispatchPool {
+            private:
+                /// Packs a participant's remaining `[begin, end)` into one word so
+                /// that the owner and thieves can claim from it with a single CAS.
+                /// Padded so that participants do not share a cache line.
+                struct Range {
+                    std::atomic<std::uint64_t> bounds{0};
+                    unsigned char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+                };
+
+                struct Job {
+                    void (*invoke)(void*, std::size_t);
+                    void* body;
+                    std::size_t chunkSize;
+                    std::mutex exceptionMutex;
+                    std::vector<std::exception_ptr> exceptions;
+                };
+
+                static constexpr std::uint64_t MaximumCount = UINT32_MAX;
+
+                std::vector<std::thread> _workers;
+                std::unique_ptr<Range[]> _ranges;
+                std::mutex _jobMutex;
+                std::mutex _mutex;
+                std::condition_variable _wake;
+                std::condition_variable _done;
+                Job* _job = nullptr;
+                std::size_t _generation = 0;
+                std::size_t _busyWorkers = 0;
+                bool _stopping = false;
+
+                static bool& _insidePool() noexcept {
+                    static thread_local bool insidePool = false;
+                    return insidePool;
+                }
+
+                /// Marks the current thread as running pool callbacks.
+                class PoolScope {
+                    private:
+                        bool _previous;
+
+                    public:
+                        PoolScope() noexcept : _previous(_insidePool()) { _insidePool() = true; }
+                        PoolScope(const PoolScope&) = delete;
+                        PoolScope& operator=(const PoolScope&) = delete;
+                        ~PoolScope() { _insidePool() = _previous; }
+                };
+
+                static std::uint64_t _pack(std::uint64_t begin, std::uint64_t end) noexcept {
+                    return (end << 32) | begin;
+                }
+
+                static std::size_t _begin(std::uint64_t bounds) noexcept {
+                    return static_cast<std::size_t>(bounds & MaximumCount);
+                }
+
+                static std::size_t _end(std::uint64_t bounds) noexcept {
+                    return static_cast<std::size_t>(bounds >> 32);
+                }
+
+                template <class Body>
+                static void _invoke(void* body, std::size_t index) {
+                    (*static_cast<Body*>(body))(index);
+                }
+
+                static void _run(Job& job, std::size_t begin, std::size_t end) {
+                    for (std::size_t index = begin; index < end; ++index) {
+                        try {
+                            job.invoke(job.body, index);
+                        } catch (...) {
+                            std::lock_guard<std::mutex> lock(job.exceptionMutex);
+                            job.exceptions.push_back(std::current_exception());
+                        }
+                    }
+                }
+
+                /// Claims up to `chunkSize` indices from the front of `range`.
+                static bool _takeChunk(
+                    Range& range,
+                    std::size_t chunkSize,
+                    std::size_t& begin,
+                    std::size_t& end) noexcept {
+                    std::uint64_t bounds = range.bounds.load(std::memory_order_acquire);
+                    for (;;) {
+                        begin = _begin(bounds);
+                        const std::size_t rangeEnd = _end(bounds);
+                        if (begin >= rangeEnd) { return false; }
+                        end = std::min(rangeEnd, begin + chunkSize);
+                        if (range.bounds.compare_exchange_weak(
+                                bounds, _pack(end, rangeEnd), std::memory_order_acq_rel)) {
+                            return true;
+                        }
+                    }
+                }
+
+                /// Moves the back half of another participant's remaining indices
+                /// into `self`'s (empty) range. Returns false once every range is
+                /// empty.
+                bool _steal(std::size_t self) noexcept {
+                    const std::size_t participants = _workers.size() + 1;
+                    for (std::size_t offset = 1; offset < participants; ++offset) {
+                        Range& victim = _ranges[(self + offset) % participants];
+                        std::uint64_t bounds = victim.bounds.load(std::memory_order_acquire);
+                        for (;;) {
+                            const std::size_t begin = _begin(bounds);
+                            const std::size_t end = _end(bounds);
+                            if (begin >= end) { break; }
+                            const std::size_t middle = end - (end - begin + 1) / 2;
+                            if (victim.bounds.compare_exchange_weak(
+                                    bounds, _pack(begin, middle), std::memory_order_acq_rel)) {
+                                _ranges[self].bounds.store(
+                                    _pack(middle, end), std::memory_order_release);
+                                return true;
+                            }
+                        }
+                    }
+                    return false;
+                }
+
+                void _participate(Job& job, std::size_t self) {
+                    PoolScope scope;
+                    std::size_t begin;
+                    std::size_t end;
+                    do {
+                        while (_takeChunk(_ranges[self], job.chunkSize, begin, end)) {
+                            _run(job, begin, end);
+                        }
+                    } while (_steal(self));
+                }
+
+                void _runWorker(std::size_t self) {
+                    std::size_t seenGeneration = 0;
+                    for (;;) {
+                        Job* job;
+                        {
+                            std::unique_lock<std::mutex> lock(_mutex);
+                            _wake.wait(lock, [this, seenGeneration]() {
+                                return _stopping || _generation != seenGeneration;
+                            });
+                            if (_stopping) { return; }
+                            seenGeneration = _generation;
+                            job = _job;
+                        }
+                        _participate(*job, self);
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        if (--_busyWorkers == 0) { _done.notify_one(); }
+                    }
+                }
+
+                template <class Body>
+                static std::vector<std::exception_ptr> _forEachSerially(
+                    std::size_t count, Body& body) {
+                    std::vector<std::exception_ptr> exceptions;
+                    for (std::size_t index = 0; index < count; ++index) {
+                        try {
+                            body(index);
+                        } catch (...) {
+                            exceptions.push_back(std::current_exception());
+                        }
+                    }
+                    return exceptions;
+                }
+
+            public:
+                /// Uses one worker per additional hardware thread.
+                ParallelDispatchPool()
+                    : ParallelDispatchPool(
+                        std::thread::hardware_concurrency() > 1
+                            ? std::thread::hardware_concurrency() - 1
+                            : 0) {}
+
+                /// `workerCount` threads are started in addition to the notifying
+                /// thread, which always participates.
+                explicit ParallelDispatchPool(std::size_t workerCount)
+                    : _ranges(new Range[workerCount + 1]) {
+                    _workers.reserve(workerCount);
+                    try {
+                        for (std::size_t worker = 1; worker <= workerCount; ++worker) {
+                            _workers.emplace_back(&ParallelDispatchPool::_runWorker, this, worker);
+                        }
+                    } catch (...) {
+                        Stop();
+                        throw;
+                    }
+                }
+
+                ParallelDispatchPool(const ParallelDispatchPool&) = delete;
+                ParallelDispatchPool& operator=(const ParallelDispatchPool&) = delete;
+
+                ~ParallelDispatchPool() {
+                    Stop();
+                }
+
+                std::size_t GetWorkerCount() const noexcept {
+                    return _workers.size();
+                }
+
+                /// Invokes `body(index)` for every index in `[0, count)`, in chunks of
+                /// `chunkSize`, and returns once every invocation has completed.
+                /// `body` is invoked concurrently and must be safe to call from any
+                /// thread. An exception thrown by one invocation does not prevent
+                /// the others; every exception is returned, in no particular order.
+                template <class Body>
+                std::vector<std::exception_ptr> ForEach(
+                    std::size_t count,
+                    std::size_t chunkSize,
+                    Body&& body) {
+                    chunkSize = std::max<std::size_t>(chunkSize, 1);
+                    if (_workers.empty() || count <= chunkSize || count > MaximumCount ||
+                        _insidePool()) {
+                        return _forEachSerially(count, body);
+                    }
+                    std::unique_lock<std::mutex> jobLock(_jobMutex, std::try_to_lock);
+                    if (!jobLock.owns_lock()) {
+                        return _forEachSerially(count, body);
+                    }
+
+                    using BodyType = typename std::remove_reference<Body>::type;
+                    Job job;
+                    job.invoke = &_invoke<BodyType>;
+                    job.body = static_cast<void*>(&body);
+                    job.chunkSize = chunkSize;
+
+                    const std::size_t participants = _workers.size() + 1;
+                    for (std::size_t participant = 0; participant < participants; ++participant) {
+                        _ranges[participant].bounds.store(
+                            _pack(count * participant / participants,
+                                  count * (participant + 1) / participants),
+                            std::memory_order_relaxed);
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _job = &job;
+                        _busyWorkers = _workers.size();
+                        ++_generation;
+                    }
+                    _wake.notify_all();
+
+                    _participate(job, 0);
+
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _done.wait(lock, [this]() { return _busyWorkers == 0; });
+                    _job = nullptr;
+                    return std::move(job.exceptions);
+                }
+
+                /// Stops and joins every worker. Must not be called concurrently with
+                /// `ForEach()`; later fan-outs run serially.
+                void Stop() noexcept {
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _stopping = true;
+                    }
+                    _wake.notify_all();
+                    for (std::thread& worker : _workers) {
+                        if (worker.joinable()) { worker.join(); }
+                    }
+                    _workers.clear();
+                }
+        };
+
+        namespace Detail {
+            /// The Observers targeted by one parallel fan-out, captured before it
+            /// starts, with a flag per target that callbacks unregistering an
+            /// Observer clear so later callbacks skip it. Keys are ascending.
+            class FanOutSnapshot {
+                public:
+                    struct Target {
+                        std::size_t key;
+                        void* observer;
+                    };
+
+                private:
+                    std::vector<Target> _targets;
+                    std::unique_ptr<std::atomic<bool>[]> _live;
+
+                public:
+                    explicit FanOutSnapshot(std::size_t capacity)
+                        : _live(new std::atomic<bool>[capacity]) {
+                        _targets.reserve(capacity);
+                    }
+
+                    void Add(std::size_t key, void* observer) {
+                        _live[_targets.size()].store(true, std::memory_order_relaxed);
+                        _targets.push_back(Target{key, observer});
+                    }
+
+                    std::size_t GetCount() const noexcept {
+                        return _targets.size();
+                    }
+
+                    /// Returns the Observer at `index`, or nullptr once it is skipped.
+                    void* GetLive(std::size_t index) const noexcept {
+                        return _live[index].load(std::memory_order_acquire)
+                            ? _targets[index].observer
+                            : nullptr;
+                    }
+
+                    void Skip(std::size_t key) noexcept {
+                        const auto target = std::lower_bound(
+                            _targets.begin(), _targets.end(), key,
+                            [](const Target& candidate, std::size_t value) {
+                                return candidate.key < value;
+                            });
+                        if (target != _targets.end() && target->key == key) {
+                            _live[target - _targets.begin()].store(false, std::memory_order_release);
+                        }
+                    }
+            };
+
+            /// Identifies the Observable whose parallel fan-out the current thread
+            /// is running callbacks for. While it is set, registration calls on
+            /// that Observable serialise on its fan-out mutex rather than its
+            /// usual guard, which the notifying thread holds throughout.
+            class FanOutParticipant {
+                private:
+                    const void* _previous;
+
+                    static const void*& _current() noexcept {
+                        static thread_local const void* current = nullptr;
+                        return current;
+                    }
+
+                public:
+                    explicit FanOutParticipant(const void* observable) noexcept
+                        : _previous(_current()) {
+                        _current() = observable;
+                    }
+
+                    FanOutParticipant(const FanOutParticipant&) = delete;
+                    FanOutParticipant& operator=(const FanOutParticipant&) = delete;
+
+                    ~FanOutParticipant() {
+                        _current() = _previous;
+                    }
+
+                    static bool IsParticipating(const void* observable) noexcept {
+                        return _current() == observable;
+                    }
+            };
+        }
+
+    }
+
+}
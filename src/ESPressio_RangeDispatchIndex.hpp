@@ -0,0 +1,328 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_InterfaceDispatchCache.hpp"
+#include "ESPressio_IObserver.hpp"
+#include "ESPressio_InterfaceId.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        class InvalidSubscriptionRangeException : public ObserverRegistrationException {
+            public:
+                InvalidSubscriptionRangeException()
+                    : ObserverRegistrationException(
+                        "A subscription range needs ordered, non-NaN bounds") {}
+        };
+
+        /// The closed interval of notified values a range registration is
+        /// interested in, e.g. `SubscriptionRange::Above(80.0)` or
+        /// `SubscriptionRange::Between(2.0, 3.0)`.
+        struct SubscriptionRange {
+            double lower;
+            double upper;
+
+            static SubscriptionRange Between(double lower, double upper) noexcept {
+                return SubscriptionRange{lower, upper};
+            }
+
+            static SubscriptionRange AtLeast(double lower) noexcept {
+                return SubscriptionRange{lower, std::numeric_limits<double>::infinity()};
+            }
+
+            static SubscriptionRange AtMost(double upper) noexcept {
+                return SubscriptionRange{-std::numeric_limits<double>::infinity(), upper};
+            }
+
+            /// Values strictly greater than `threshold`.
+            static SubscriptionRange Above(double threshold) noexcept {
+                return AtLeast(std::nextafter(threshold, std::numeric_limits<double>::infinity()));
+            }
+
+            /// Values strictly less than `threshold`.
+            static SubscriptionRange Below(double threshold) noexcept {
+                return AtMost(std::nextafter(threshold, -std::numeric_limits<double>::infinity()));
+            }
+
+            bool Contains(double value) const noexcept {
+                return lower <= value && value <= upper;
+            }
+        };
+
+        namespace Detail {
+            /// The `SubscriptionRange` of each range registration of an
+            /// Observable, with a centred interval tree answering which ranges
+            /// contain a value in O(log N + k).
+            /// The tree is rebuilt by the first query after a registration or
+            /// compaction, in O(N log N). A query copies out its matches before
+            /// any callback runs, so rebuilding from a nested notification is safe.
+            /// Like `InterfaceDispatchCache`, interface pointers are resolved per
+            /// interface on first use and then once per registration;
+            /// unregistration only nulls the slot, and `Compact()` drops members
+            /// for vacant slots when the Observable compacts.
+            /// Not synchronised: the owning Observable guards every call.
+            class RangeDispatchIndex {
+                public:
+                    using Entry = InterfaceDispatchCache::Entry;
+
+                private:
+                    static constexpr std::size_t NoNode = static_cast<std::size_t>(-1);
+
+                    struct Member {
+                        std::size_t slot;
+                        SubscriptionRange range;
+                    };
+
+                    /// Resolved interface pointers, parallel to `_members`.
+                    struct Column {
+                        void* (*resolve)(IObserver*);
+                        std::vector<void*> observers;
+                    };
+
+                    /// The members containing `center` are
+                    /// `_byLower[first, last)` and `_byUpper[first, last)`; the
+                    /// others lie wholly in the `left` or `right` subtree.
+                    struct Node {
+                        double center;
+                        std::size_t first;
+                        std::size_t last;
+                        std::size_t left;
+                        std::size_t right;
+                    };
+
+                    /// Ascending slot order.
+                    std::vector<Member> _members;
+                    /// Indexed by `Detail::InterfaceId`; null until materialised.
+                    std::vector<std::unique_ptr<Column> > _columns;
+                    std::vector<Node> _nodes;
+                    /// Member indices by ascending lower bound, per node.
+                    std::vector<std::size_t> _byLower;
+                    /// Member indices by descending upper bound, per node.
+                    std::vector<std::size_t> _byUpper;
+                    std::size_t _root = NoNode;
+                    bool _stale = false;
+                    /// Scratch for `Compact()`, grown by `Add()` to cover every
+                    /// indexed slot so compaction never allocates.
+                    std::vector<std::size_t> _compactedSlots;
+
+                    template <class ObserverType>
+                    static void* _resolve(IObserver* observer) {
+                        return static_cast<void*>(ObserverCast<ObserverType>(observer));
+                    }
+
+                    std::size_t _build(std::vector<std::size_t>& members) {
+                        if (members.empty()) { return NoNode; }
+
+                        // The median endpoint belongs to some member, so every
+                        // node holds at least one and each side at most half.
+                        std::vector<double> endpoints;
+                        endpoints.reserve(members.size() * 2);
+                        for (const std::size_t member : members) {
+                            endpoints.push_back(_members[member].range.lower);
+                            endpoints.push_back(_members[member].range.upper);
+                        }
+                        std::nth_element(
+                            endpoints.begin(), endpoints.begin() + members.size(), endpoints.end());
+                        const double center = endpoints[members.size()];
+
+                        std::vector<std::size_t> left;
+                        std::vector<std::size_t> right;
+                        const std::size_t first = _byLower.size();
+                        for (const std::size_t member : members) {
+                            const SubscriptionRange& range = _members[member].range;
+                            if (range.upper < center) {
+                                left.push_back(member);
+                            } else if (range.lower > center) {
+                                right.push_back(member);
+                            } else {
+                                _byLower.push_back(member);
+                                _byUpper.push_back(member);
+                            }
+                        }
+                        const std::size_t last = _byLower.size();
+                        std::sort(_byLower.begin() + first, _byLower.end(),
+                            [this](std::size_t a, std::size_t b) {
+                                return _members[a].range.lower < _members[b].range.lower;
+                            });
+                        std::sort(_byUpper.begin() + first, _byUpper.end(),
+                            [this](std::size_t a, std::size_t b) {
+                                return _members[a].range.upper > _members[b].range.upper;
+                            });
+                        members.clear();
+                        members.shrink_to_fit();
+
+                        const std::size_t node = _nodes.size();
+                        _nodes.push_back(Node{center, first, last, NoNode, NoNode});
+                        const std::size_t leftNode = _build(left);
+                        const std::size_t rightNode = _build(right);
+                        _nodes[node].left = leftNode;
+                        _nodes[node].right = rightNode;
+                        return node;
+                    }
+
+                    void _rebuild() {
+                        _nodes.clear();
+                        _byLower.clear();
+                        _byUpper.clear();
+                        _root = NoNode;
+                        std::vector<std::size_t> members(_members.size());
+                        for (std::size_t member = 0; member < members.size(); ++member) {
+                            members[member] = member;
+                        }
+                        _root = _build(members);
+                        _stale = false;
+                    }
+
+                    template <class Visit>
+                    void _query(double value, Visit&& visit) const {
+                        std::size_t node = _root;
+                        while (node != NoNode) {
+                            const Node& current = _nodes[node];
+                            if (value < current.center) {
+                                for (std::size_t index = current.first; index < current.last; ++index) {
+                                    const std::size_t member = _byLower[index];
+                                    if (_members[member].range.lower > value) { break; }
+                                    visit(member);
+                                }
+                                node = current.left;
+                            } else if (value > current.center) {
+                                for (std::size_t index = current.first; index < current.last; ++index) {
+                                    const std::size_t member = _byUpper[index];
+                                    if (_members[member].range.upper < value) { break; }
+                                    visit(member);
+                                }
+                                node = current.right;
+                            } else {
+                                for (std::size_t index = current.first; index < current.last; ++index) {
+                                    visit(_byLower[index]);
+                                }
+                                return;
+                            }
+                        }
+                    }
+
+                public:
+                    /// Throws `InvalidSubscriptionRangeException` unless `range` has
+                    /// ordered, non-NaN bounds.
+                    static void Validate(const SubscriptionRange& range) {
+                        if (!(range.lower <= range.upper)) {
+                            throw InvalidSubscriptionRangeException();
+                        }
+                    }
+
+                    /// Appends to `matches`, in ascending slot order, the live
+                    /// `ObserverType` Observers whose range contains `value`.
+                    template <class ObserverType>
+                    void Match(
+                        double value,
+                        const std::vector<ObserverSlot>& observers,
+                        std::vector<Entry>& matches) {
+                        if (_members.empty() || std::isnan(value)) { return; }
+
+                        const std::size_t interfaceId = InterfaceId<ObserverType>::Value();
+                        if (interfaceId >= _columns.size() || !_columns[interfaceId]) {
+                            std::unique_ptr<Column> column(
+                                new Column{&_resolve<ObserverType>, std::vector<void*>()});
+                            column->observers.reserve(_members.size());
+                            for (const Member& member : _members) {
+                                IObserver* observer = observers[member.slot].observer;
+                                column->observers.push_back(
+                                    observer != nullptr ? column->resolve(observer) : nullptr);
+                            }
+                            if (interfaceId >= _columns.size()) {
+                                _columns.resize(interfaceId + 1);
+                            }
+                            _columns[interfaceId] = std::move(column);
+                        }
+                        const std::vector<void*>& resolved = _columns[interfaceId]->observers;
+
+                        const auto visit = [&](std::size_t member) {
+                            const std::size_t slot = _members[member].slot;
+                            if (resolved[member] != nullptr && observers[slot].observer != nullptr) {
+                                matches.push_back(Entry{slot, resolved[member]});
+                            }
+                        };
+                        if (_stale) { _rebuild(); }
+                        const std::size_t firstMatch = matches.size();
+                        _query(value, visit);
+                        std::sort(matches.begin() + firstMatch, matches.end(),
+                            [](const Entry& a, const Entry& b) { return a.slot < b.slot; });
+                    }
+
+                    /// Indexes `observer`, registered in `slot` for `range`. `slot`
+                    /// must exceed every slot already indexed. Either the index is
+                    /// updated or, on exception, left unchanged.
+                    void Add(std::size_t slot, IObserver* observer, const SubscriptionRange& range) {
+                        if (_compactedSlots.size() <= slot) { _compactedSlots.resize(slot + 1); }
+                        _members.push_back(Member{slot, range});
+                        std::size_t extended = 0;
+                        try {
+                            for (; extended < _columns.size(); ++extended) {
+                                if (!_columns[extended]) { continue; }
+                                Column& column = *_columns[extended];
+                                column.observers.push_back(column.resolve(observer));
+                            }
+                        } catch (...) {
+                            for (std::size_t index = 0; index < extended; ++index) {
+                                if (_columns[index]) { _columns[index]->observers.pop_back(); }
+                            }
+                            _members.pop_back();
+                            throw;
+                        }
+                        _stale = true;
+                    }
+
+                    /// Drops members whose slot in `observers` is null and renumbers
+                    /// the remainder to the slots they occupy once `observers` has
+                    /// been compacted in order. Must be called before compacting.
+                    void Compact(const std::vector<ObserverSlot>& observers) noexcept {
+                        if (_members.empty()) { return; }
+
+                        const std::size_t indexedSlots =
+                            _compactedSlots.size() < observers.size() ? _compactedSlots.size() : observers.size();
+                        std::size_t liveSlots = 0;
+                        for (std::size_t slot = 0; slot < indexedSlots; ++slot) {
+                            _compactedSlots[slot] = liveSlots;
+                            if (observers[slot].observer != nullptr) { ++liveSlots; }
+                        }
+
+                        std::size_t kept = 0;
+                        for (std::size_t member = 0; member < _members.size(); ++member) {
+                            const std::size_t slot = _members[member].slot;
+                            if (observers[slot].observer == nullptr) { continue; }
+                            for (std::unique_ptr<Column>& column : _columns) {
+                                if (column) { column->observers[kept] = column->observers[member]; }
+                            }
+                            _members[kept++] = Member{_compactedSlots[slot], _members[member].range};
+                        }
+                        _members.resize(kept);
+                        for (std::unique_ptr<Column>& column : _columns) {
+                            if (column) { column->observers.resize(kept); }
+                        }
+                        _stale = true;
+                    }
+
+                    void Clear() noexcept {
+                        _members.clear();
+                        _columns.clear();
+                        _nodes.clear();
+                        _byLower.clear();
+                        _byUpper.clear();
+                        _root = NoNode;
+                        _stale = false;
+                    }
+            };
+        }
+
+    }
+
+}
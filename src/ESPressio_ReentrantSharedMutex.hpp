@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <system_error>
+#include <vector>
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        namespace Detail {
+            /// A reader/writer lock that each thread may re-acquire.
+            /// Nested shared acquisitions only count on the acquiring thread, so a
+            /// callback may notify again from within a notification even while a
+            /// writer waits, and the exclusive owner may re-lock it either way.
+            /// Writers are preferred: once one waits, threads not yet holding the
+            /// lock wait for it. A thread holding the lock shared must not lock
+            /// it exclusively; `lock()` throws rather than deadlock.
+            /// Uncontended shared acquisition is one compare-and-swap.
+            class ReentrantSharedMutex {
+                private:
+                    /// This thread's holds of one mutex.
+                    struct Hold {
+                        const ReentrantSharedMutex* mutex;
+                        std::size_t shared;
+                        std::size_t exclusive;
+                    };
+
+                    static constexpr std::size_t WriterBit = 1;
+                    static constexpr std::size_t Reader = 2;
+
+                    /// `WriterBit` while a writer holds or waits for the lock, plus
+                    /// `Reader` for every thread holding it shared.
+                    std::atomic<std::size_t> _state{0};
+                    /// Serialises writers.
+                    std::mutex _writerMutex;
+                    std::mutex _waitMutex;
+                    std::condition_variable _changed;
+
+                    static std::vector<Hold>& _holds() {
+                        static thread_local std::vector<Hold> holds;
+                        return holds;
+                    }
+
+                    Hold* _find() const noexcept {
+                        for (Hold& hold : _holds()) {
+                            if (hold.mutex == this) { return &hold; }
+                        }
+                        return nullptr;
+                    }
+
+                    void _release(Hold* hold) noexcept {
+                        std::vector<Hold>& holds = _holds();
+                        *hold = holds.back();
+                        holds.pop_back();
+                    }
+
+                public:
+                    ReentrantSharedMutex() = default;
+                    ReentrantSharedMutex(const ReentrantSharedMutex&) = delete;
+                    ReentrantSharedMutex& operator=(const ReentrantSharedMutex&) = delete;
+
+                    void lock_shared() {
+                        Hold* hold = _find();
+                        if (hold != nullptr) {
+                            ++hold->shared;
+                            return;
+                        }
+                        _holds().push_back(Hold{this, 1, 0});
+
+                        std::size_t state = _state.load(std::memory_order_relaxed);
+                        while ((state & WriterBit) != 0 ||
+                               !_state.compare_exchange_weak(
+                                   state, state + Reader,
+                                   std::memory_order_acquire, std::memory_order_relaxed)) {
+                            if ((state & WriterBit) == 0) { continue; }
+                            try {
+                                std::unique_lock<std::mutex> lock(_waitMutex);
+                                _changed.wait(lock, [this]() {
+                                    return (_state.load(std::memory_order_relaxed) & WriterBit) == 0;
+                                });
+                            } catch (...) {
+                                _holds().pop_back();
+                                throw;
+                            }
+                            state = _state.load(std::memory_order_relaxed);
+                        }
+                    }
+
+                    void unlock_shared() noexcept {
+                        Hold* hold = _find();
+                        if (--hold->shared > 0 || hold->exclusive > 0) { return; }
+                        _release(hold);
+                        if (_state.fetch_sub(Reader, std::memory_order_release) == WriterBit + Reader) {
+                            std::lock_guard<std::mutex> lock(_waitMutex);
+                            _changed.notify_all();
+                        }
+                    }
+
+                    void lock() {
+                        Hold* hold = _find();
+                        if (hold != nullptr) {
+                            if (hold->exclusive == 0) {
+                                throw std::system_error(
+                                    std::make_error_code(std::errc::resource_deadlock_would_occur));
+                            }
+                            ++hold->exclusive;
+                            return;
+                        }
+                        _holds().push_back(Hold{this, 0, 1});
+
+                        try {
+                            _writerMutex.lock();
+                        } catch (...) {
+                            _holds().pop_back();
+                            throw;
+                        }
+                        std::unique_lock<std::mutex> lock(_waitMutex);
+                        _state.fetch_or(WriterBit, std::memory_order_relaxed);
+                        while (_state.load(std::memory_order_acquire) != WriterBit) {
+                            _changed.wait(lock);
+                        }
+                    }
+
+                    /// Locks exclusively only if no other thread holds the lock.
+                    bool try_lock() noexcept {
+                        Hold* hold = _find();
+                        if (hold != nullptr) {
+                            if (hold->exclusive == 0) { return false; }
+                            ++hold->exclusive;
+                            return true;
+                        }
+                        try {
+                            _holds().push_back(Hold{this, 0, 1});
+                        } catch (...) {
+                            return false;
+                        }
+
+                        std::size_t unlocked = 0;
+                        if (!_writerMutex.try_lock()) {
+                            _holds().pop_back();
+                            return false;
+                        }
+                        if (!_state.compare_exchange_strong(
+                                unlocked, WriterBit, std::memory_order_acquire)) {
+                            _writerMutex.unlock();
+                            _holds().pop_back();
+                            return false;
+                        }
+                        return true;
+                    }
+
+                    void unlock() noexcept {
+                        Hold* hold = _find();
+                        if (--hold->exclusive > 0) { return; }
+                        _release(hold);
+                        {
+                            std::lock_guard<std::mutex> lock(_waitMutex);
+                            _state.fetch_and(~WriterBit, std::memory_order_release);
+                        }
+                        _changed.notify_all();
+                        _writerMutex.unlock();
+                    }
+
+                    /// Returns `true` if this thread holds the lock shared, and not
+                    /// exclusively.
+                    bool IsSharedByCurrentThread() const noexcept {
+                        const Hold* hold = _find();
+                        return hold != nullptr && hold->exclusive == 0;
+                    }
+            };
+        }
+
+    }
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_NotificationTransaction.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        namespace Detail {
+            /// The notifications queued on this thread while a run-to-completion
+            /// Observable dispatches, and the buffer retained between cascades to
+            /// avoid reallocating it.
+            struct CascadeState {
+                std::vector<std::unique_ptr<PendingNotification> > queued;
+                bool dispatching = false;
+
+                static CascadeState& Current() {
+                    static thread_local CascadeState state;
+                    return state;
+                }
+            };
+
+            inline bool IsCascadeDispatching() {
+                return CascadeState::Current().dispatching;
+            }
+
+            /// Queues an `ObserverType` notification behind those already queued on
+            /// this thread, retaining the Observable until it is delivered.
+            /// Requires `IsCascadeDispatching()`.
+            template <class ObserverType, class Dispatch, class Callback>
+            void QueueNotification(
+                std::shared_ptr<IObservable> notificationLifetime,
+                Dispatch&& dispatch,
+                Callback&& callback) {
+                using Pending = TypedPendingNotification<
+                    ObserverType,
+                    typename std::decay<Dispatch>::type,
+                    typename std::decay<Callback>::type
+                >;
+                std::unique_ptr<PendingNotification> pending(new Pending(
+                    std::move(notificationLifetime),
+                    std::forward<Dispatch>(dispatch),
+                    std::forward<Callback>(callback)));
+                CascadeState::Current().queued.push_back(std::move(pending));
+            }
+
+            /// Runs `notify` as the outermost run-to-completion dispatch on this
+            /// thread, then delivers, in the order they were queued, every
+            /// notification queued meanwhile, including those queued by their own
+            /// callbacks. Each is dispatched from this frame, so a cascade never
+            /// nests more than one notification deep. An exception propagates and
+            /// discards the notifications not yet delivered.
+            /// Requires `!IsCascadeDispatching()`.
+            template <class Notify>
+            void RunToCompletion(Notify&& notify) {
+                CascadeState& state = CascadeState::Current();
+                struct Cascade {
+                    CascadeState& state;
+                    explicit Cascade(CascadeState& current) noexcept : state(current) {
+                        state.dispatching = true;
+                    }
+                    ~Cascade() {
+                        state.queued.clear();
+                        state.dispatching = false;
+                    }
+                } cascade(state);
+
+                notify();
+                for (std::size_t index = 0; index < state.queued.size(); ++index) {
+                    const std::unique_ptr<PendingNotification> pending = std::move(state.queued[index]);
+                    pending->Deliver(nullptr, 0);
+                }
+            }
+        }
+
+    }
+
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_InterfaceDispatchCache.hpp"
+#include "ESPressio_IObserver.hpp"
+#include "ESPressio_ObserverHandle.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        /// A `ShardedThreadSafeObservable` is a Thread Safe `IUntypedObservable`
+        /// whose registrations are spread across independently locked shards,
+        /// chosen by hashing the Observer's address.
+        /// Registration, unregistration and `IsObserverRegistered()` lock only
+        /// the Observer's shard, so registration churn from many threads no
+        /// longer serialises on one mutex, and only waits for a notification
+        /// while that notification is dispatching the same shard.
+        /// Notifications are serialised with each other and walk the shards in
+        /// order, holding each shard's lock while dispatching it; Observers are
+        /// therefore notified in registration order within a shard, but not
+        /// across shards. As with `ThreadSafeObservable`, callbacks may register
+        /// or unregister any Observer; those registered during a notification
+        /// are first notified by the next one.
+        class ShardedThreadSafeObservable : public IUntypedObservable {
+            private:
+                /// Leading padding keeps each shard's lock off the cache line
+                /// holding the end of the previous shard.
+                struct Shard {
+                    unsigned char padding[64];
+                    std::recursive_mutex mutex;
+                    /// Registration slots in registration order; unregistered slots
+                    /// are nulled and reclaimed by `_compactIfWorthwhile()`.
+                    std::vector<Detail::ObserverSlot> observers;
+                    /// The notification epoch current when each slot registered.
+                    std::vector<std::uint64_t> epochs;
+                    std::unordered_map<IObserver*, std::size_t> slots;
+                    Detail::InterfaceDispatchCache dispatchCache;
+                    std::atomic<std::size_t> observerCount{0};
+                    std::size_t notificationDepth = 0;
+                    std::size_t vacantSlots = 0;
+                };
+
+                std::size_t _shardCount;
+                std::unique_ptr<Shard[]> _shards;
+                /// Serialises notifications, so that a callback holding one shard
+                /// may lock another without deadlocking against a second notifier.
+                std::recursive_mutex _dispatchMutex;
+                /// Advanced by every notification, which skips slots registered
+                /// at or after its own epoch.
+                std::atomic<std::uint64_t> _epoch{0};
+
+                Shard& _shardOf(IObserver* observer) noexcept {
+                    // Fibonacci hashing spreads the aligned addresses evenly.
+                    const std::uint64_t hash =
+                        static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(observer)) *
+                        UINT64_C(0x9E3779B97F4A7C15);
+                    return _shards[static_cast<std::size_t>(hash >> 32) % _shardCount];
+                }
+
+                bool _hasObservers() const noexcept {
+                    for (std::size_t index = 0; index < _shardCount; ++index) {
+                        if (_shards[index].observerCount.load(std::memory_order_acquire) > 0) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                /// Requires the shard's lock. Compaction is deferred until no
+                /// notification is dispatching the shard and at least half of its
+                /// slots are vacant.
+                static void _compactIfWorthwhile(Shard& shard) noexcept {
+                    if (shard.notificationDepth > 0 || shard.vacantSlots == 0 ||
+                        shard.vacantSlots * 2 < shard.observers.size()) {
+                        return;
+                    }
+                    shard.dispatchCache.Compact(shard.observers);
+                    std::size_t liveSlots = 0;
+                    for (std::size_t slot = 0; slot < shard.observers.size(); ++slot) {
+                        const Detail::ObserverSlot kept = shard.observers[slot];
+                        if (kept.observer == nullptr) { continue; }
+                        shard.slots.find(kept.observer)->second = liveSlots;
+                        shard.epochs[liveSlots] = shard.epochs[slot];
+                        shard.observers[liveSlots++] = kept;
+                    }
+                    shard.observers.resize(liveSlots);
+                    shard.epochs.resize(liveSlots);
+                    shard.vacantSlots = 0;
+                }
+
+                static void _finishNotification(Shard& shard) noexcept {
+                    --shard.notificationDepth;
+                    _compactIfWorthwhile(shard);
+                }
+
+                /// Invokes `dispatch(shard, epoch)` for every shard with Observers,
+                /// under that shard's lock.
+                template <class Dispatch>
+                void _forEachShard(Dispatch&& dispatch) {
+                    std::lock_guard<std::recursive_mutex> notifying(_dispatchMutex);
+                    const std::uint64_t epoch = _epoch.fetch_add(1, std::memory_order_acq_rel) + 1;
+                    for (std::size_t index = 0; index < _shardCount; ++index) {
+                        Shard& shard = _shards[index];
+                        if (shard.observerCount.load(std::memory_order_acquire) == 0) { continue; }
+                        std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+                        ++shard.notificationDepth;
+                        try {
+                            dispatch(shard, epoch);
+                        } catch (...) {
+                            _finishNotification(shard);
+                            throw;
+                        }
+                        _finishNotification(shard);
+                    }
+                }
+
+                template <class Callback>
+                void _withObservers(Callback&& callback) {
+                    _forEachShard([&callback](Shard& shard, std::uint64_t epoch) {
+                        const std::size_t observerCount = shard.observers.size();
+                        for (std::size_t slot = 0; slot < observerCount; ++slot) {
+                            IObserver* observer = shard.observers[slot].observer;
+                            if (observer != nullptr && shard.epochs[slot] < epoch) {
+                                callback(observer);
+                            }
+                        }
+                    });
+                }
+
+                /// Dispatch walks each shard's cached bucket of interface pointers.
+                template <class ObserverType, class Callback>
+                void _withObservers(Callback&& callback) {
+                    _forEachShard([&callback](Shard& shard, std::uint64_t epoch) {
+                        Detail::InterfaceDispatchCache::Bucket& bucket =
+                            shard.dispatchCache.GetBucket<ObserverType>(shard.observers);
+                        const std::size_t observerCount = bucket.entries.size();
+                        for (std::size_t index = 0; index < observerCount; ++index) {
+                            const Detail::InterfaceDispatchCache::Entry entry = bucket.entries[index];
+                            if (shard.observers[entry.slot].observer != nullptr &&
+                                shard.epochs[entry.slot] < epoch) {
+                                callback(static_cast<ObserverType*>(entry.observerInterface));
+                            }
+                        }
+                    });
+                }
+
+            protected:
+                class NotificationContext {
+                    private:
+                        friend class ShardedThreadSafeObservable;
+                        ShardedThreadSafeObservable& _observable;
+                        std::shared_ptr<IObservable> _notificationLifetime;
+                        NotificationContext(
+                            ShardedThreadSafeObservable& observable,
+                            std::shared_ptr<IObservable> notificationLifetime)
+                            : _observable(observable),
+                              _notificationLifetime(std::move(notificationLifetime)) {}
+
+                    public:
+                        template <class Callback>
+                        void WithObservers(Callback&& callback) {
+                            _observable._withObservers(
+                                std::forward<Callback>(callback));
+                        }
+
+                        template <class ObserverType, class Callback>
+                        void WithObservers(Callback&& callback) {
+                            _observable._withObservers<ObserverType>(
+                                std::forward<Callback>(callback));
+                        }
+                };
+
+                template <class Operation>
+                void ExecuteNotification(Operation&& operation) {
+                    if (!_hasObservers()) { return; }
+
+                    NotificationContext context(
+                        *this,
+                        AcquireNotificationLifetime());
+                    operation(context);
+                }
+
+            public:
+                static constexpr bool IsThreadSafe = true;
+
+                /// Uses one shard per hardware thread.
+                ShardedThreadSafeObservable()
+                    : ShardedThreadSafeObservable(
+                        std::max<std::size_t>(std::thread::hardware_concurrency(), 1)) {}
+
+                /// Spreads registrations across `shardCount` shards (at least one).
+                explicit ShardedThreadSafeObservable(std::size_t shardCount)
+                    : _shardCount(std::max<std::size_t>(shardCount, 1)),
+                      _shards(new Shard[_shardCount]) {}
+
+                ~ShardedThreadSafeObservable() override {
+                    BeginObservableDestruction();
+                    std::lock_guard<std::recursive_mutex> notifying(_dispatchMutex);
+                    for (std::size_t index = 0; index < _shardCount; ++index) {
+                        Shard& shard = _shards[index];
+                        std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+                        for (const Detail::ObserverSlot& slot : shard.observers) {
+                            if (slot.handle != nullptr) { slot.handle->InvalidateRegistration(); }
+                        }
+                        shard.observers.clear();
+                        shard.epochs.clear();
+                        shard.slots.clear();
+                        shard.dispatchCache.Clear();
+                        shard.observerCount.store(0, std::memory_order_release);
+                    }
+                }
+
+                std::size_t GetShardCount() const noexcept {
+                    return _shardCount;
+                }
+
+                ObserverHandlePtr RegisterObserver(IObserver* observer) override {
+                    if (observer == nullptr) {
+                        throw InvalidObserverRegistrationException();
+                    }
+                    Shard& shard = _shardOf(observer);
+                    std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+                    if (shard.slots.find(observer) != shard.slots.end()) {
+                        throw DuplicateObserverRegistrationException();
+                    }
+                    std::unique_ptr<ObserverHandle> handle(
+                        new ObserverHandle(GetLifetimeControl(), observer));
+
+                    const std::size_t slot = shard.observers.size();
+                    shard.observers.push_back(Detail::ObserverSlot{observer, handle.get()});
+                    try {
+                        shard.epochs.push_back(_epoch.load(std::memory_order_acquire));
+                        try {
+                            shard.slots.emplace(observer, slot);
+                            try {
+                                shard.dispatchCache.Add(slot, observer);
+                            } catch (...) {
+                                shard.slots.erase(observer);
+                                throw;
+                            }
+                        } catch (...) {
+                            shard.epochs.pop_back();
+                            throw;
+                        }
+                    } catch (...) {
+                        shard.observers.pop_back();
+                        throw;
+                    }
+                    shard.observerCount.fetch_add(1, std::memory_order_release);
+                    return ObserverHandlePtr(handle.release());
+                }
+
+                void UnregisterObserver(IObserver* observer) override {
+                    Shard& shard = _shardOf(observer);
+                    std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+                    const auto slot = shard.slots.find(observer);
+                    if (slot == shard.slots.end()) { return; }
+
+                    Detail::ObserverSlot& vacated = shard.observers[slot->second];
+                    if (vacated.handle != nullptr) { vacated.handle->InvalidateRegistration(); }
+                    vacated = Detail::ObserverSlot{nullptr, nullptr};
+                    shard.slots.erase(slot);
+                    ++shard.vacantSlots;
+                    shard.observerCount.fetch_sub(1, std::memory_order_acq_rel);
+                    _compactIfWorthwhile(shard);
+                }
+
+                bool IsObserverRegistered(IObserver* observer) override {
+                    Shard& shard = _shardOf(observer);
+                    if (shard.observerCount.load(std::memory_order_acquire) == 0) {
+                        return false;
+                    }
+
+                    std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+                    return shard.slots.find(observer) != shard.slots.end();
+                }
+        };
+
+    }
+
+}
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ESPressio_DeferredDestruction.hpp"
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_IObserver.hpp"
+#include "ESPressio_ObserverHandle.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        namespace Detail {
+            template <class ObserverInterface, class... ObserverInterfaces>
+            struct InterfaceIndex;
+
+            template <class ObserverInterface, class... RemainingInterfaces>
+            struct InterfaceIndex<ObserverInterface, ObserverInterface, RemainingInterfaces...>
+                : std::integral_constant<std::size_t, 0> {};
+
+            template <class ObserverInterface, class FirstInterface, class... RemainingInterfaces>
+            struct InterfaceIndex<ObserverInterface, FirstInterface, RemainingInterfaces...>
+                : std::integral_constant<
+                    std::size_t,
+                    1 + InterfaceIndex<ObserverInterface, RemainingInterfaces...>::value
+                > {};
+
+            template <class ObserverInterface, class... ObserverInterfaces>
+            struct ContainsInterface;
+
+            template <class ObserverInterface>
+            struct ContainsInterface<ObserverInterface> : std::false_type {};
+
+            template <class ObserverInterface, class FirstInterface, class... RemainingInterfaces>
+            struct ContainsInterface<ObserverInterface, FirstInterface, RemainingInterfaces...>
+                : std::integral_constant<
+                    bool,
+                    std::is_same<ObserverInterface, FirstInterface>::value ||
+                    ContainsInterface<ObserverInterface, RemainingInterfaces...>::value
+                > {};
+
+            template <class... ObserverInterfaces>
+            struct UniqueInterfaces;
+
+            template <>
+            struct UniqueInterfaces<> : std::true_type {};
+
+            template <class ObserverInterface, class... RemainingInterfaces>
+            struct UniqueInterfaces<ObserverInterface, RemainingInterfaces...>
+                : std::integral_constant<
+                    bool,
+                    !ContainsInterface<ObserverInterface, RemainingInterfaces...>::value &&
+                    UniqueInterfaces<RemainingInterfaces...>::value
+                > {};
+        }
+
+        /// A non-thread-safe Observable whose complete set of Observer interfaces
+        /// is fixed at compile time, e.g.
+        /// `StaticObservable<ITemperatureObserver, IPressureObserver>`.
+        /// Each interface has its own contiguous vector of typed interface
+        /// pointers, selected at compile time, so notification performs no
+        /// hashing, no casts and no type erasure. Requesting or registering an
+        /// interface outside the set is a compile error.
+        /// Registration lifetime follows the same `ObserverHandlePtr` model as the
+        /// other Observables.
+        template <class... ObserverInterfaces>
+        class StaticObservable : public IObservable, public Detail::DeferredDestruction {
+            static_assert(
+                sizeof...(ObserverInterfaces) > 0,
+                "At least one Observer interface must be specified"
+            );
+            static_assert(
+                sizeof...(ObserverInterfaces) <= 64,
+                "StaticObservable supports at most 64 Observer interfaces"
+            );
+            static_assert(
+                Detail::UniqueInterfaces<ObserverInterfaces...>::value,
+                "Every Observer interface may only be listed once"
+            );
+
+            private:
+                template <class ObserverInterface>
+                struct BucketEntry {
+                    ObserverHandle* handle;
+                    ObserverInterface* observer;
+                };
+
+                template <class ObserverInterface>
+                using Bucket = std::vector<BucketEntry<ObserverInterface> >;
+
+                using InterfaceMask = std::uint64_t;
+
+                struct Registration {
+                    ObserverHandle* handle;
+                    InterfaceMask interfaces;
+                };
+
+                std::tuple<Bucket<ObserverInterfaces>...> _buckets;
+                std::unordered_map<IObserver*, Registration> _registrations;
+                std::size_t _notificationDepth = 0;
+                bool _needsCompaction = false;
+
+                template <class ObserverInterface>
+                static constexpr InterfaceMask _maskOf() {
+                    return InterfaceMask(1) <<
+                        Detail::InterfaceIndex<ObserverInterface, ObserverInterfaces...>::value;
+                }
+
+                template <class ObserverType>
+                static constexpr InterfaceMask _implementedMask() {
+                    return _combine({
+                        (std::is_convertible<ObserverType*, ObserverInterfaces*>::value
+                            ? _maskOf<ObserverInterfaces>() : InterfaceMask(0))...
+                    });
+                }
+
+                static constexpr InterfaceMask _combine(std::initializer_list<InterfaceMask> masks) {
+                    InterfaceMask combined = 0;
+                    for (const InterfaceMask mask : masks) { combined |= mask; }
+                    return combined;
+                }
+
+                template <class ObserverInterface>
+                Bucket<ObserverInterface>& _bucket() noexcept {
+                    return std::get<Bucket<ObserverInterface> >(_buckets);
+                }
+
+                template <class ObserverInterface, class ObserverType>
+                void _append(ObserverHandle* handle, ObserverType* observer, InterfaceMask mask, std::true_type) {
+                    if ((mask & _maskOf<ObserverInterface>()) == 0) { return; }
+                    _bucket<ObserverInterface>().push_back(
+                        BucketEntry<ObserverInterface>{handle, observer});
+                }
+
+                template <class ObserverInterface, class ObserverType>
+                void _append(ObserverHandle*, ObserverType*, InterfaceMask, std::false_type) {}
+
+                template <class ObserverInterface>
+                void _removeFrom(ObserverHandle* handle, InterfaceMask mask) noexcept {
+                    if ((mask & _maskOf<ObserverInterface>()) == 0) { return; }
+                    Bucket<ObserverInterface>& bucket = _bucket<ObserverInterface>();
+                    if (_notificationDepth > 0) {
+                        for (BucketEntry<ObserverInterface>& entry : bucket) {
+                            if (entry.handle == handle) {
+                                entry.handle = nullptr;
+                                _needsCompaction = true;
+                            }
+                        }
+                    } else {
+                        bucket.erase(
+                            std::remove_if(
+                                bucket.begin(), bucket.end(),
+                                [handle](const BucketEntry<ObserverInterface>& entry) {
+                                    return entry.handle == handle;
+                                }),
+                            bucket.end());
+                    }
+                }
+
+                template <class ObserverInterface>
+                void _compact() noexcept {
+                    Bucket<ObserverInterface>& bucket = _bucket<ObserverInterface>();
+                    bucket.erase(
+                        std::remove_if(
+                            bucket.begin(), bucket.end(),
+                            [](const BucketEntry<ObserverInterface>& entry) {
+                                return entry.handle == nullptr;
+                            }),
+                        bucket.end());
+                }
+
+                void _removeFromBuckets(ObserverHandle* handle, InterfaceMask mask) noexcept {
+                    const int remove[] = {
+                        0, (_removeFrom<ObserverInterfaces>(handle, mask), 0)...
+                    };
+                    (void)remove;
+                }
+
+                void _finishNotification() {
+                    if (--_notificationDepth == 0 && _needsCompaction) {
+                        const int compact[] = {0, (_compact<ObserverInterfaces>(), 0)...};
+                        (void)compact;
+                        _needsCompaction = false;
+                    }
+                }
+
+                template <class ObserverType>
+                ObserverHandlePtr _register(ObserverType* observer, InterfaceMask mask) {
+                    static_assert(
+                        std::is_convertible<ObserverType*, IObserver*>::value,
+                        "Observers must derive from IObserver"
+                    );
+                    if (observer == nullptr) {
+                        throw InvalidObserverRegistrationException();
+                    }
+
+                    IObserver* untypedObserver = observer;
+                    const auto existing = _registrations.find(untypedObserver);
+                    if (existing != _registrations.end()) {
+                        if (existing->second.interfaces != mask) {
+                            throw ObserverRegistrationConflictException();
+                        }
+                        throw DuplicateObserverRegistrationException();
+                    }
+
+                    std::unique_ptr<ObserverHandle> handle(
+                        new ObserverHandle(GetLifetimeControl(), untypedObserver));
+                    try {
+                        const int append[] = {
+                            0,
+                            (_append<ObserverInterfaces>(
+                                handle.get(), observer, mask,
+                                std::integral_constant<
+                                    bool,
+                                    std::is_convertible<ObserverType*, ObserverInterfaces*>::value
+                                >()),
+                             0)...
+                        };
+                        (void)append;
+                        _registrations.emplace(
+                            untypedObserver, Registration{handle.get(), mask});
+                    } catch (...) {
+                        _removeFromBuckets(handle.get(), mask);
+                        throw;
+                    }
+                    return ObserverHandlePtr(handle.release());
+                }
+
+                template <class ObserverInterface, class Callback>
+                void _withObservers(Callback&& callback) {
+                    static_assert(
+                        Detail::ContainsInterface<ObserverInterface, ObserverInterfaces...>::value,
+                        "Observer interface is not supported by this StaticObservable"
+                    );
+                    Bucket<ObserverInterface>& bucket = _bucket<ObserverInterface>();
+                    ++_notificationDepth;
+                    const std::size_t observerCount = bucket.size();
+                    try {
+                        for (std::size_t index = 0; index < observerCount; ++index) {
+                            const BucketEntry<ObserverInterface> entry = bucket[index];
+                            if (entry.handle != nullptr) {
+                                callback(entry.observer);
+                            }
+                        }
+                    } catch (...) {
+                        _finishNotification();
+                        throw;
+                    }
+                    _finishNotification();
+                }
+
+            protected:
+                class NotificationContext {
+                    private:
+                        friend class StaticObservable;
+                        StaticObservable& _observable;
+                        Detail::NotificationLifetime _notificationLifetime;
+                        NotificationContext(
+                            StaticObservable& observable,
+                            std::shared_ptr<IObservable> notificationLifetime)
+                            : _observable(observable),
+                              _notificationLifetime(
+                                  observable, observable, std::move(notificationLifetime)) {}
+
+                    public:
+                        template <class ObserverInterface, class Callback>
+                        void WithObservers(Callback&& callback) {
+                            _observable.template _withObservers<ObserverInterface>(
+                                std::forward<Callback>(callback));
+                        }
+                };
+
+                template <class Operation>
+                void ExecuteNotification(Operation&& operation) {
+                    NotificationContext context(
+                        *this,
+                        IsDestructionDeferred()
+                            ? std::shared_ptr<IObservable>()
+                            : AcquireNotificationLifetime());
+                    operation(context);
+                }
+
+            public:
+                ~StaticObservable() override {
+                    BeginObservableDestruction();
+                    for (auto& registration : _registrations) {
+                        registration.second.handle->InvalidateRegistration();
+                    }
+                    _registrations.clear();
+                }
+
+                /// Registers `observer` for every interface of this Observable that
+                /// `ObserverType` implements. At least one must be implemented.
+                template <class ObserverType>
+                ObserverHandlePtr RegisterObserver(ObserverType* observer) {
+                    static_assert(
+                        _implementedMask<ObserverType>() != 0,
+                        "Observer implements none of this StaticObservable's interfaces"
+                    );
+                    return _register(observer, _implementedMask<ObserverType>());
+                }
+
+                /// Registers `observer` for exactly the requested interfaces, each of
+                /// which must belong to this Observable and be implemented by
+                /// `ObserverType`.
+                template <class... RequestedInterfaces, class ObserverType>
+                ObserverHandlePtr RegisterObserverAs(ObserverType* observer) {
+                    static_assert(
+                        sizeof...(RequestedInterfaces) > 0,
+                        "At least one Observer interface must be specified"
+                    );
+                    static_assert(
+                        _combine({(Detail::ContainsInterface<
+                            RequestedInterfaces, ObserverInterfaces...>::value
+                                ? InterfaceMask(0) : InterfaceMask(1))...}) == 0,
+                        "Observer interface is not supported by this StaticObservable"
+                    );
+                    static_assert(
+                        _combine({(std::is_convertible<
+                            ObserverType*, RequestedInterfaces*>::value
+                                ? InterfaceMask(0) : InterfaceMask(1))...}) == 0,
+                        "Observer does not implement every requested Observer interface"
+                    );
+                    return _register(
+                        observer, _combine({_maskOf<RequestedInterfaces>()...}));
+                }
+
+                void UnregisterObserver(IObserver* observer) override {
+                    const auto registration = _registrations.find(observer);
+                    if (registration == _registrations.end()) { return; }
+
+                    registration->second.handle->InvalidateRegistration();
+                    _removeFromBuckets(
+                        registration->second.handle, registration->second.interfaces);
+                    _registrations.erase(registration);
+                }
+
+                bool IsObserverRegistered(IObserver* observer) override {
+                    return _registrations.find(observer) != _registrations.end();
+                }
+        };
+
+    }
+
+}
@@ -1,60 +1,505 @@
 #pragma once
 
-#include <algorithm>
 #include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <initializer_list>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "ESPressio_IObservable.hpp"
+#include "ESPressio_InterfaceDispatchCache.hpp"
 #include "ESPressio_IObserver.hpp"
+#include "ESPressio_KeyedDispatchIndex.hpp"
+#include "ESPressio_NotificationTransaction.hpp"
+#include "ESPressio_ObservableInstrumentation.hpp"
 #include "ESPressio_ObserverHandle.hpp"
+#include "ESPressio_ObserverRegistration.hpp"
+#include "ESPressio_ParallelDispatchPool.hpp"
+#include "ESPressio_RangeDispatchIndex.hpp"
+#include "ESPressio_ReentrantSharedMutex.hpp"
+#include "ESPressio_RunToCompletion.hpp"
 
 namespace ESPressio {
 
     namespace Observable {
+
+        class ReentrantRegistrationException : public ObserverRegistrationException {
+            public:
+                ReentrantRegistrationException()
+                    : ObserverRegistrationException(
+                        "Observers cannot be registered from within a shared notification") {}
+        };
+
+        /// How a `ThreadSafeObservable` synchronises its notifications.
+        enum class ThreadSafeLocking {
+            /// One recursive mutex serialises notifications and registration.
+            Recursive,
+            /// Notifications share access and run in parallel with each other;
+            /// registration and reconfiguration take exclusive access.
+            ReaderWriter
+        };
    
         /// A `ThreadSafeObservable` is an object that can be observed by any number of `IObserver` descendant types
         /// This is a concrete implementation of `IObservable`, and is Thread Safe!
         /// Your Observers can Register or Unregister themselves at any time, and the `ThreadSafeObservable` will handle it!
-        class ThreadSafeObservable : public IUntypedObservable {
+        /// Notifications can optionally be fanned out across a
+        /// `ParallelDispatchPool`; see `SetParallelDispatch()`.
+        /// Observers registered with a `SubscriptionKey` can also be notified
+        /// per key, visiting only the Observers registered for that key, and
+        /// those registered with a `SubscriptionRange` per value, visiting only
+        /// the Observers whose range contains it.
+        /// Constructed with `ThreadSafeLocking::ReaderWriter`, concurrent
+        /// notifications proceed in parallel. A callback of such a notification
+        /// may still unregister any Observer: it is skipped at once and its slot
+        /// vacated by the next exclusive access. Registering an Observer, or
+        /// reconfiguring the Observable, from such a callback throws
+        /// `ReentrantRegistrationException`. Notifications fanned out in parallel
+        /// or timed by latency tracking take exclusive access.
+        /// With `EnableRunToCompletion()`, notifications raised by callbacks
+        /// are queued per thread rather than nested.
+        class ThreadSafeObservable : public IUntypedObservable, private Detail::ObservableCounters {
             private:
-                std::vector<IObserverHandle*> _observers;
+                /// Copyable, so that `SharedAccess::deferredSlots` can grow.
+                struct DeferredFlag {
+                    std::atomic<bool> deferred{false};
+
+                    DeferredFlag() = default;
+                    DeferredFlag(const DeferredFlag& other) noexcept
+                        : deferred(other.deferred.load(std::memory_order_relaxed)) {}
+                };
+
+                /// The state of `ThreadSafeLocking::ReaderWriter`.
+                struct SharedAccess {
+                    Detail::ReentrantSharedMutex mutex;
+                    /// Serialises materialising the dispatch indexes, which shared
+                    /// notifications do lazily.
+                    std::mutex indexMutex;
+                    /// Whether a callback of a shared notification has unregistered
+                    /// the Observer in each slot, so dispatch skips it without
+                    /// locking. Grown with the slots under exclusive access, and all
+                    /// clear whenever exclusive access is held.
+                    std::vector<DeferredFlag> deferredSlots;
+                    /// Guards `deferredUnregistrations`.
+                    std::mutex deferredMutex;
+                    /// The flagged slots, vacated by the next exclusive access.
+                    std::vector<std::size_t> deferredUnregistrations;
+                    std::atomic<std::size_t> deferredCount{0};
+                };
+
+                /// Holds `_mutex`, `_fanOutMutex` or `_sharedAccess->mutex` until
+                /// destroyed.
+                class RegistrationLock {
+                    private:
+                        std::recursive_mutex* _recursive = nullptr;
+                        Detail::ReentrantSharedMutex* _readerWriter = nullptr;
+                        bool _shared = false;
+
+                    public:
+                        explicit RegistrationLock(std::recursive_mutex& mutex)
+                            : _recursive(&mutex) {
+                            mutex.lock();
+                        }
+
+                        RegistrationLock(Detail::ReentrantSharedMutex& mutex, bool shared)
+                            : _readerWriter(&mutex), _shared(shared) {
+                            if (shared) {
+                                mutex.lock_shared();
+                            } else {
+                                mutex.lock();
+                            }
+                        }
+
+                        RegistrationLock(RegistrationLock&& other) noexcept
+                            : _recursive(other._recursive),
+                              _readerWriter(other._readerWriter),
+                              _shared(other._shared) {
+                            other._recursive = nullptr;
+                            other._readerWriter = nullptr;
+                        }
+
+                        RegistrationLock(const RegistrationLock&) = delete;
+                        RegistrationLock& operator=(const RegistrationLock&) = delete;
+                        RegistrationLock& operator=(RegistrationLock&&) = delete;
+
+                        ~RegistrationLock() {
+                            if (_recursive != nullptr) {
+                                _recursive->unlock();
+                            } else if (_readerWriter != nullptr && _shared) {
+                                _readerWriter->unlock_shared();
+                            } else if (_readerWriter != nullptr) {
+                                _readerWriter->unlock();
+                            }
+                        }
+                };
+
+                /// Registration slots in registration order; unregistered slots are
+                /// nulled and reclaimed by `_compactIfWorthwhile()`.
+                std::vector<Detail::ObserverSlot> _observers;
+                std::unordered_map<IObserver*, Detail::SlotIndex> _slots;
+                Detail::RegistrationIds _registrationIds;
+                Detail::InterfaceDispatchCache _dispatchCache;
+                Detail::KeyedDispatchIndex _keyedIndex;
+                Detail::RangeDispatchIndex _rangeIndex;
                 std::recursive_mutex _mutex;
                 std::atomic<std::size_t> _observerCount{0};
-                std::size_t _notificationDepth = 0;
-                bool _needsCompaction = false;
+                std::atomic<std::size_t> _notificationDepth{0};
+                std::size_t _vacantSlots = 0;
+                /// Serialises registration calls made by callbacks of a parallel
+                /// fan-out, while the notifying thread holds `_mutex` for them.
+                std::recursive_mutex _fanOutMutex;
+                std::shared_ptr<ParallelDispatchPool> _parallelPool;
+                std::size_t _parallelChunkSize = 0;
+                /// The Observers of the parallel fan-out in progress, if any.
+                Detail::FanOutSnapshot* _fanOut = nullptr;
+                /// Guarded by the registration guard; parallel fan-outs are not timed.
+                Detail::LatencyTracker _latencyTracker;
+                /// Null unless constructed with `ThreadSafeLocking::ReaderWriter`.
+                std::unique_ptr<SharedAccess> _sharedAccess;
+                std::atomic<bool> _runToCompletion{false};
+
+                /// Takes the registration guard: `_mutex` (exclusive access to
+                /// `_sharedAccess->mutex` in reader/writer mode), or `_fanOutMutex`
+                /// from within a callback of this Observable's parallel fan-out.
+                RegistrationLock _lockRegistrations() {
+                    if (Detail::FanOutParticipant::IsParticipating(this)) {
+                        return RegistrationLock(_fanOutMutex);
+                    }
+                    if (!_sharedAccess) { return RegistrationLock(_mutex); }
+                    if (_isSharedByCurrentThread()) {
+                        throw ReentrantRegistrationException();
+                    }
+                    RegistrationLock lock(_sharedAccess->mutex, false);
+                    _applyDeferredUnregistrations();
+                    return lock;
+                }
+
+                /// The guard for reading the registrations: shared access in
+                /// reader/writer mode, otherwise `_lockRegistrations()`.
+                RegistrationLock _lockReading() {
+                    if (!_sharedAccess || Detail::FanOutParticipant::IsParticipating(this)) {
+                        return _lockRegistrations();
+                    }
+                    return RegistrationLock(_sharedAccess->mutex, true);
+                }
+
+                /// The guard a notification holds: `_lockReading()`, unless it may
+                /// fan out in parallel or be timed, which need exclusive access.
+                RegistrationLock _lockNotification() {
+                    {
+                        RegistrationLock lock = _lockReading();
+                        if (!_sharedAccess || (!_parallelPool && !_latencyTracker.IsEnabled())) {
+                            return lock;
+                        }
+                    }
+                    return _lockRegistrations();
+                }
+
+                bool _isSharedByCurrentThread() const noexcept {
+                    return _sharedAccess && _sharedAccess->mutex.IsSharedByCurrentThread();
+                }
+
+                /// Serialises materialising the dispatch indexes in reader/writer
+                /// mode, where several notifications may do so at once.
+                std::unique_lock<std::mutex> _lockIndexes() {
+                    return _sharedAccess
+                        ? std::unique_lock<std::mutex>(_sharedAccess->indexMutex)
+                        : std::unique_lock<std::mutex>();
+                }
+
+                /// Whether a callback of a shared notification has unregistered
+                /// the Observer in `slot`, which is not yet vacated.
+                bool _isUnregistrationDeferred(std::size_t slot) const noexcept {
+                    return _sharedAccess &&
+                        _sharedAccess->deferredCount.load(std::memory_order_acquire) != 0 &&
+                        _sharedAccess->deferredSlots[slot].deferred.load(std::memory_order_acquire);
+                }
+
+                /// Requires the registration guard, before `_observers` grows to
+                /// `slotCount` slots.
+                void _reserveDeferredSlots(std::size_t slotCount) {
+                    if (!_sharedAccess || _sharedAccess->deferredSlots.size() >= slotCount) { return; }
+                    _sharedAccess->deferredSlots.resize(
+                        std::max(slotCount, _sharedAccess->deferredSlots.size() * 2));
+                }
+
+                /// Requires shared access. Invalidates the registration at once,
+                /// leaving its slot to `_applyDeferredUnregistrations()`.
+                void _deferUnregistration(IObserver* observer) {
+                    const auto slot = _slots.find(observer);
+                    if (slot == _slots.end()) { return; }
+                    const std::size_t index = slot->second.slot;
+                    if (_sharedAccess->deferredSlots[index].deferred.load(std::memory_order_acquire)) {
+                        return;
+                    }
 
-                bool _isObserverRegistered(IObserver* observer) const {
-                    for (IObserverHandle* handle : _observers) {
-                        if (handle != nullptr && handle->GetObserver() == observer) {
-                            return true;
+                    std::lock_guard<std::mutex> lock(_sharedAccess->deferredMutex);
+                    if (_sharedAccess->deferredSlots[index].deferred.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    _sharedAccess->deferredUnregistrations.push_back(index);
+                    // Only shared notifications run now, and they read no handle.
+                    Detail::ObserverSlot& vacated = _observers[index];
+                    if (vacated.handle != nullptr) {
+                        vacated.handle->InvalidateRegistration();
+                        vacated.handle = nullptr;
+                    }
+                    _sharedAccess->deferredCount.fetch_add(1, std::memory_order_release);
+                    _sharedAccess->deferredSlots[index].deferred.store(true, std::memory_order_release);
+                    _observerCount.fetch_sub(1, std::memory_order_acq_rel);
+                }
+
+                /// Requires exclusive access.
+                void _applyDeferredUnregistrations() noexcept {
+                    if (_sharedAccess->deferredCount.load(std::memory_order_acquire) == 0) { return; }
+                    std::lock_guard<std::mutex> lock(_sharedAccess->deferredMutex);
+                    for (const std::size_t slot : _sharedAccess->deferredUnregistrations) {
+                        _sharedAccess->deferredSlots[slot].deferred.store(false, std::memory_order_relaxed);
+                        _vacateSlot(_observers[slot].observer);
+                    }
+                    _sharedAccess->deferredUnregistrations.clear();
+                    _sharedAccess->deferredCount.store(0, std::memory_order_release);
+                    _compactIfWorthwhile();
+                }
+
+                /// Applies unregistrations deferred by a shared notification now,
+                /// if exclusive access is free; otherwise the next one does.
+                void _applyDeferredUnregistrationsIfIdle() noexcept {
+                    if (!_sharedAccess ||
+                        _sharedAccess->deferredCount.load(std::memory_order_acquire) == 0 ||
+                        _sharedAccess->mutex.IsSharedByCurrentThread() ||
+                        !_sharedAccess->mutex.try_lock()) {
+                        return;
+                    }
+                    _applyDeferredUnregistrations();
+                    _sharedAccess->mutex.unlock();
+                }
+
+                /// Runs `dispatch` under `_lockNotification()`.
+                template <class Dispatch>
+                void _notify(Dispatch&& dispatch) {
+                    {
+                        RegistrationLock lock = _lockNotification();
+                        dispatch();
+                    }
+                    _applyDeferredUnregistrationsIfIdle();
+                }
+
+                /// Requires `_mutex`. Compaction is deferred until no notification
+                /// is iterating and at least half of the slots are vacant, keeping
+                /// unregistration O(1) amortised without reordering Observers.
+                void _compactIfWorthwhile() noexcept {
+                    if (_notificationDepth > 0 || _vacantSlots == 0 ||
+                        _vacantSlots * 2 < _observers.size()) {
+                        return;
+                    }
+                    RecordCompaction();
+                    _dispatchCache.Compact(_observers);
+                    _keyedIndex.Compact(_observers);
+                    _rangeIndex.Compact(_observers);
+                    std::size_t liveSlots = 0;
+                    for (const Detail::ObserverSlot& slot : _observers) {
+                        if (slot.observer == nullptr) { continue; }
+                        _slots.find(slot.observer)->second.slot = liveSlots;
+                        _observers[liveSlots++] = slot;
+                    }
+                    _observers.resize(liveSlots);
+                    _vacantSlots = 0;
+                }
+
+                /// Requires `_mutex`.
+                bool _vacateSlot(IObserver* observer) noexcept {
+                    const auto slot = _slots.find(observer);
+                    if (slot == _slots.end()) { return false; }
+
+                    Detail::ObserverSlot& vacated = _observers[slot->second.slot];
+                    if (vacated.handle != nullptr) { vacated.handle->InvalidateRegistration(); }
+                    vacated = Detail::ObserverSlot{nullptr, nullptr};
+                    if (_fanOut != nullptr) { _fanOut->Skip(slot->second.slot); }
+                    _slots.erase(slot);
+                    ++_vacantSlots;
+                    RecordUnregistrations(1);
+                    return true;
+                }
+
+                ObserverHandleBatch _registerObservers(const std::vector<IObserver*>& observers) {
+                    for (IObserver* observer : observers) {
+                        if (observer == nullptr) {
+                            throw InvalidObserverRegistrationException();
                         }
                     }
-                    return false;
+
+                    // Declared before the lock so that handles discarded by a failed
+                    // registration are destroyed after it is released.
+                    ObserverHandleBatch handles;
+                    handles.reserve(observers.size());
+
+                    RegistrationLock lock = _lockRegistrations();
+                    const std::size_t firstSlot = _observers.size();
+                    _reserveDeferredSlots(firstSlot + observers.size());
+                    _observers.reserve(firstSlot + observers.size());
+                    _slots.reserve(_slots.size() + observers.size());
+
+                    std::size_t indexed = 0;
+                    try {
+                        for (; indexed < observers.size(); ++indexed) {
+                            const Detail::SlotIndex index{firstSlot + indexed, 0};
+                            if (!_slots.emplace(observers[indexed], index).second) {
+                                throw DuplicateObserverRegistrationException();
+                            }
+                        }
+                        for (IObserver* observer : observers) {
+                            handles.emplace_back(new ObserverHandle(GetLifetimeControl(), observer));
+                        }
+                        for (std::size_t index = 0; index < observers.size(); ++index) {
+                            _dispatchCache.Add(firstSlot + index, observers[index]);
+                        }
+                    } catch (...) {
+                        _dispatchCache.Truncate(firstSlot);
+                        for (std::size_t index = 0; index < indexed; ++index) {
+                            _slots.erase(observers[index]);
+                        }
+                        for (ObserverHandlePtr& handle : handles) {
+                            static_cast<ObserverHandle*>(handle.get())->InvalidateRegistration();
+                        }
+                        throw;
+                    }
+
+                    for (std::size_t index = 0; index < observers.size(); ++index) {
+                        _observers.push_back(Detail::ObserverSlot{
+                            observers[index], static_cast<ObserverHandle*>(handles[index].get())});
+                    }
+                    _observerCount.fetch_add(handles.size(), std::memory_order_release);
+                    RecordRegistrations(handles.size());
+                    return handles;
                 }
 
-                void _finishNotification() {
-                    if (--_notificationDepth == 0 && _needsCompaction) {
-                        _observers.erase(
-                            std::remove(_observers.begin(), _observers.end(), nullptr),
-                            _observers.end());
-                        _needsCompaction = false;
+                /// Requires the registration guard. `index(slot)` adds the Observer
+                /// to any keyed or range index, leaving it unchanged if it throws.
+                template <class Index>
+                void _addSlot(Detail::ObserverSlot added, std::uint32_t registration, Index&& index) {
+                    const std::size_t slot = _observers.size();
+                    _reserveDeferredSlots(slot + 1);
+                    _observers.push_back(added);
+                    try {
+                        _slots.emplace(added.observer, Detail::SlotIndex{slot, registration});
+                        try {
+                            _dispatchCache.Add(slot, added.observer);
+                            try {
+                                index(slot);
+                            } catch (...) {
+                                _dispatchCache.Truncate(slot);
+                                throw;
+                            }
+                        } catch (...) {
+                            _slots.erase(added.observer);
+                            throw;
+                        }
+                    } catch (...) {
+                        _observers.pop_back();
+                        throw;
+                    }
+                    _observerCount.fetch_add(1, std::memory_order_release);
+                    RecordRegistrations(1);
+                }
+
+                void _finishNotification() noexcept {
+                    --_notificationDepth;
+                    // Shared notifications leave compaction to exclusive access.
+                    if (_isSharedByCurrentThread()) { return; }
+                    _compactIfWorthwhile();
+                }
+
+                /// Requires the registration guard. Records a timed callback unless
+                /// it unregistered its own Observer, whose handle may be destroyed.
+                Detail::LatencyTracker::Clock::time_point _recordLatency(
+                    std::size_t slot,
+                    IObserver* observer,
+                    Detail::LatencyTracker::Clock::time_point start) {
+                    const auto end = Detail::LatencyTracker::Clock::now();
+                    const Detail::ObserverSlot& timed = _observers[slot];
+                    if (timed.observer != observer) { return end; }
+                    return _latencyTracker.Record(
+                        timed.handle != nullptr ? &timed.handle->GetOrCreateLatencyHistogram() : nullptr,
+                        observer,
+                        start,
+                        end);
+                }
+
+                /// Requires the registration guard.
+                bool _fanOutInParallel(std::size_t observerCount) const noexcept {
+                    return _parallelPool && observerCount > _parallelChunkSize && _fanOut == nullptr;
+                }
+
+                /// Requires the registration guard and a raised `_notificationDepth`.
+                /// The guard stays held by this thread for the whole fan-out, so
+                /// registration calls from other threads still wait for it.
+                template <class ObserverType, class Callback>
+                void _withObserversInParallel(Detail::FanOutSnapshot& snapshot, Callback& callback) {
+                    const std::shared_ptr<ParallelDispatchPool> pool = _parallelPool;
+                    _fanOut = &snapshot;
+                    std::vector<std::exception_ptr> exceptions;
+                    try {
+                        exceptions = pool->ForEach(
+                            snapshot.GetCount(), _parallelChunkSize,
+                            [this, &snapshot, &callback](std::size_t index) {
+                                Detail::FanOutParticipant participant(this);
+                                void* observer = snapshot.GetLive(index);
+                                if (observer != nullptr) {
+                                    callback(static_cast<ObserverType*>(observer));
+                                }
+                            });
+                    } catch (...) {
+                        _fanOut = nullptr;
+                        throw;
+                    }
+                    _fanOut = nullptr;
+                    if (!exceptions.empty()) {
+                        throw ParallelNotificationException(std::move(exceptions));
                     }
                 }
 
                 template <class Callback>
                 void _withObservers(Callback&& callback) {
-                    std::lock_guard<std::recursive_mutex> lock(_mutex);
+                    _notify([&]() { _withSlots(callback); });
+                }
+
+                /// Requires the notification guard.
+                template <class Callback>
+                void _withSlots(Callback& callback) {
                     ++_notificationDepth;
                     const std::size_t observerCount = _observers.size();
                     try {
-                        for (std::size_t index = 0; index < observerCount; ++index) {
-                            IObserverHandle* handle = _observers[index];
-                            if (handle != nullptr) {
-                                callback(handle->GetObserver());
+                        Detail::ObservableCounters::DispatchTally tally(*this);
+                        if (_fanOutInParallel(observerCount)) {
+                            Detail::FanOutSnapshot snapshot(observerCount);
+                            for (std::size_t slot = 0; slot < observerCount; ++slot) {
+                                IObserver* observer = _observers[slot].observer;
+                                if (observer != nullptr) { snapshot.Add(slot, observer); }
+                            }
+                            tally.Invoked(snapshot.GetCount());
+                            tally.Skipped(observerCount - snapshot.GetCount());
+                            _withObserversInParallel<IObserver>(snapshot, callback);
+                        } else {
+                            const bool timed = _latencyTracker.IsEnabled();
+                            Detail::LatencyTracker::Clock::time_point start;
+                            if (timed) { start = Detail::LatencyTracker::Clock::now(); }
+                            for (std::size_t index = 0; index < observerCount; ++index) {
+                                IObserver* observer = _observers[index].observer;
+                                if (observer == nullptr || _isUnregistrationDeferred(index)) {
+                                    tally.Skipped();
+                                    continue;
+                                }
+                                tally.Invoked();
+                                callback(observer);
+                                if (timed) { start = _recordLatency(index, observer, start); }
                             }
                         }
                     } catch (...) {
@@ -64,21 +509,82 @@ namespace ESPressio {
                     _finishNotification();
                 }
 
+                /// Dispatch walks the cached bucket of interface pointers resolved
+                /// when `ObserverType` was first notified or the Observer registered.
                 template <class ObserverType, class Callback>
                 void _withObservers(Callback&& callback) {
-                    std::lock_guard<std::recursive_mutex> lock(_mutex);
+                    _notify([&]() {
+                        Detail::InterfaceDispatchCache::Bucket* bucket;
+                        {
+                            std::unique_lock<std::mutex> indexes = _lockIndexes();
+                            bucket = &_dispatchCache.GetBucket<ObserverType>(_observers);
+                        }
+                        _withBucket<ObserverType>(*bucket, callback);
+                    });
+                }
+
+                /// As `_withObservers<ObserverType>()`, walking the bucket of the
+                /// Observers registered for `key`.
+                template <class ObserverType, class Callback>
+                void _withObservers(SubscriptionKey key, Callback&& callback) {
+                    _notify([&]() {
+                        Detail::InterfaceDispatchCache::Bucket* bucket;
+                        {
+                            std::unique_lock<std::mutex> indexes = _lockIndexes();
+                            bucket = _keyedIndex.GetBucket<ObserverType>(key, _observers);
+                        }
+                        if (bucket == nullptr) { return; }
+                        _withBucket<ObserverType>(*bucket, callback);
+                    });
+                }
+
+                /// As `_withObservers<ObserverType>()`, walking the Observers whose
+                /// range contains `value`.
+                template <class ObserverType, class Callback>
+                void _withObserversMatching(double value, Callback&& callback) {
+                    _notify([&]() {
+                        Detail::InterfaceDispatchCache::Bucket matching{nullptr, {}};
+                        {
+                            std::unique_lock<std::mutex> indexes = _lockIndexes();
+                            _rangeIndex.Match<ObserverType>(value, _observers, matching.entries);
+                        }
+                        if (matching.entries.empty()) { return; }
+                        _withBucket<ObserverType>(matching, callback);
+                    });
+                }
+
+                /// Requires the notification guard.
+                template <class ObserverType, class Callback>
+                void _withBucket(Detail::InterfaceDispatchCache::Bucket& bucket, Callback& callback) {
                     ++_notificationDepth;
-                    const std::size_t observerCount = _observers.size();
+                    const std::size_t observerCount = bucket.entries.size();
                     try {
-                        for (std::size_t index = 0; index < observerCount; ++index) {
-                            IObserverHandle* handle = _observers[index];
-                            if (handle == nullptr) {
-                                continue;
+                        Detail::ObservableCounters::DispatchTally tally(*this);
+                        if (_fanOutInParallel(observerCount)) {
+                            Detail::FanOutSnapshot snapshot(observerCount);
+                            for (const Detail::InterfaceDispatchCache::Entry& entry : bucket.entries) {
+                                if (_observers[entry.slot].observer != nullptr) {
+                                    snapshot.Add(entry.slot, entry.observerInterface);
+                                }
                             }
-                            ObserverType* observerAsT =
-                                dynamic_cast<ObserverType*>(handle->GetObserver());
-                            if (observerAsT != nullptr) {
-                                callback(observerAsT);
+                            tally.Invoked(snapshot.GetCount());
+                            tally.Skipped(observerCount - snapshot.GetCount());
+                            _withObserversInParallel<ObserverType>(snapshot, callback);
+                        } else {
+                            const bool timed = _latencyTracker.IsEnabled();
+                            Detail::LatencyTracker::Clock::time_point start;
+                            if (timed) { start = Detail::LatencyTracker::Clock::now(); }
+                            for (std::size_t index = 0; index < observerCount; ++index) {
+                                const Detail::InterfaceDispatchCache::Entry entry =
+                                    bucket.entries[index];
+                                IObserver* observer = _observers[entry.slot].observer;
+                                if (observer == nullptr || _isUnregistrationDeferred(entry.slot)) {
+                                    tally.Skipped();
+                                    continue;
+                                }
+                                tally.Invoked();
+                                callback(static_cast<ObserverType*>(entry.observerInterface));
+                                if (timed) { start = _recordLatency(entry.slot, observer, start); }
                             }
                         }
                     } catch (...) {
@@ -89,6 +595,14 @@ namespace ESPressio {
                 }
 
             protected:
+                void UnregisterObserverRegistration(IObserver* observer, std::uint32_t registration) override {
+                    RegistrationLock lock =
+                        _isSharedByCurrentThread() ? _lockReading() : _lockRegistrations();
+                    const auto slot = _slots.find(observer);
+                    if (slot == _slots.end() || slot->second.registration != registration) { return; }
+                    UnregisterObserver(observer);
+                }
+
                 class NotificationContext {
                     private:
                         friend class ThreadSafeObservable;
@@ -112,6 +626,22 @@ namespace ESPressio {
                             _observable._withObservers<ObserverType>(
                                 std::forward<Callback>(callback));
                         }
+
+                        /// Invokes `callback` only for the `ObserverType` Observers
+                        /// registered for `key`.
+                        template <class ObserverType, class Callback>
+                        void WithObservers(SubscriptionKey key, Callback&& callback) {
+                            _observable._withObservers<ObserverType>(
+                                key, std::forward<Callback>(callback));
+                        }
+
+                        /// Invokes `callback` only for the `ObserverType` Observers
+                        /// registered with a `SubscriptionRange` containing `value`.
+                        template <class ObserverType, class Callback>
+                        void WithObserversMatching(double value, Callback&& callback) {
+                            _observable._withObserversMatching<ObserverType>(
+                                value, std::forward<Callback>(callback));
+                        }
                 };
 
                 template <class Operation>
@@ -130,77 +660,248 @@ namespace ESPressio {
                             std::memory_order_acquire
                         ) == 0
                     ) {
+                        RecordNotification(0);
                         return;
                     }
 
-                    NotificationContext context(
-                        *this,
-                        AcquireNotificationLifetime());
-                    operation(context);
+                    const auto execute = [this, &operation]() {
+                        NotificationContext context(
+                            *this,
+                            AcquireNotificationLifetime());
+                        // Declared after the context, which may release the last owner.
+                        Detail::ObservableCounters::NotificationTimer timer(*this);
+                        operation(context);
+                    };
+                    if (_runToCompletion.load(std::memory_order_relaxed) &&
+                        !Detail::IsCascadeDispatching()) {
+                        Detail::RunToCompletion(execute);
+                        return;
+                    }
+                    execute();
+                }
+
+                /// Notifies every `ObserverType` Observer with `callback` or, while a
+                /// `NotificationTransaction` is open on this thread, defers it to
+                /// the transaction's commit. With `EnableRunToCompletion()`, one
+                /// raised while a run-to-completion notification dispatches on this
+                /// thread is queued behind it instead. `callback` is retained until
+                /// then, so it must capture by value.
+                template <class ObserverType, class Callback>
+                void ExecuteDeferrableNotification(Callback callback) {
+                    if (_observerCount.load(std::memory_order_acquire) == 0) { return; }
+                    const auto dispatch = [this](const std::function<void(ObserverType*)>& visit) {
+                        ExecuteNotification([&visit](NotificationContext& notification) {
+                            notification.WithObservers<ObserverType>(visit);
+                        });
+                    };
+                    if (Detail::IsTransactionOpen()) {
+                        Detail::DeferNotification<ObserverType>(
+                            AcquireNotificationLifetime(), dispatch, std::move(callback));
+                        return;
+                    }
+                    if (_runToCompletion.load(std::memory_order_relaxed) &&
+                        Detail::IsCascadeDispatching()) {
+                        Detail::QueueNotification<ObserverType>(
+                            AcquireNotificationLifetime(), dispatch, std::move(callback));
+                        return;
+                    }
+                    ExecuteNotification([&callback](NotificationContext& notification) {
+                        notification.WithObservers<ObserverType>(callback);
+                    });
                 }
 
             public:
+                static constexpr bool IsThreadSafe = true;
+
+                using Detail::ObservableCounters::GetStatistics;
+
+                /// Times every later serial callback, recording it in the Observer's
+                /// `IObserverHandle::GetLatencyHistogram()` and calling
+                /// `onSlowObserver`, if set, for callbacks longer than `budget`.
+                /// Callbacks fanned out by `SetParallelDispatch()` are not timed.
+                void EnableLatencyTracking(
+                    std::chrono::nanoseconds budget = std::chrono::nanoseconds::max(),
+                    SlowObserverHook onSlowObserver = SlowObserverHook()) {
+                    RegistrationLock lock = _lockRegistrations();
+                    _latencyTracker.Enable(budget, std::move(onSlowObserver));
+                }
+
+                /// Stops timing callbacks; recorded histograms are kept.
+                void DisableLatencyTracking() {
+                    RegistrationLock lock = _lockRegistrations();
+                    _latencyTracker.Disable();
+                }
+
+                /// Queues notifications raised through `ExecuteDeferrableNotification()`
+                /// while a run-to-completion notification dispatches on the same
+                /// thread, as `Observable::EnableRunToCompletion()` does. Each thread
+                /// delivers its own queue once its outermost notification, and the
+                /// registration guard it held, are released.
+                void EnableRunToCompletion() noexcept {
+                    _runToCompletion.store(true, std::memory_order_relaxed);
+                }
+
+                /// Delivers notifications raised by callbacks immediately again.
+                void DisableRunToCompletion() noexcept {
+                    _runToCompletion.store(false, std::memory_order_relaxed);
+                }
+
+                /// `locking` selects how notifications synchronise; see
+                /// `ThreadSafeLocking`.
+                explicit ThreadSafeObservable(ThreadSafeLocking locking = ThreadSafeLocking::Recursive)
+                    : _sharedAccess(locking == ThreadSafeLocking::ReaderWriter ? new SharedAccess() : nullptr) {}
+
                 ~ThreadSafeObservable() override {
                     BeginObservableDestruction();
-                    std::lock_guard<std::recursive_mutex> lock(_mutex);
-                    for (IObserverHandle* handle : _observers) {
-                        if (handle != nullptr) {
-                            static_cast<ObserverHandle*>(handle)->InvalidateRegistration();
-                        }
+                    RegistrationLock lock = _lockRegistrations();
+                    for (const Detail::ObserverSlot& slot : _observers) {
+                        if (slot.handle != nullptr) { slot.handle->InvalidateRegistration(); }
                     }
                     _observers.clear();
+                    _slots.clear();
+                    _dispatchCache.Clear();
+                    _keyedIndex.Clear();
+                    _rangeIndex.Clear();
                     _observerCount.store(0, std::memory_order_release);
                 }
 
                 ObserverHandlePtr RegisterObserver(IObserver* observer) override {
+                    return RegisterObserver(observer, std::initializer_list<SubscriptionKey>());
+                }
+
+                /// Registers `observer` like `RegisterObserver()`, additionally
+                /// notifying it from `WithObservers<ObserverType>(key, ...)`.
+                ObserverHandlePtr RegisterObserver(IObserver* observer, SubscriptionKey key) {
+                    return RegisterObserver(observer, {key});
+                }
+
+                /// Registers `observer` like `RegisterObserver()`, additionally
+                /// notifying it from `WithObservers<ObserverType>(key, ...)` for
+                /// every key in `keys`.
+                ObserverHandlePtr RegisterObserver(IObserver* observer, std::initializer_list<SubscriptionKey> keys) {
                     if (observer == nullptr) {
                         throw InvalidObserverRegistrationException();
                     }
-                    std::lock_guard<std::recursive_mutex> lock(_mutex);
-                    for (auto thisObserver : _observers) {
-                        if (thisObserver != nullptr &&
-                            thisObserver->GetObserver() == observer) {
-                            throw DuplicateObserverRegistrationException();
-                        }
+                    RegistrationLock lock = _lockRegistrations();
+                    if (_slots.find(observer) != _slots.end()) {
+                        throw DuplicateObserverRegistrationException();
                     }
                     std::unique_ptr<ObserverHandle> handle(
                         new ObserverHandle(GetLifetimeControl(), observer));
-                    _observers.push_back(handle.get());
-                    _observerCount.fetch_add(1, std::memory_order_release);
+                    _addSlot(Detail::ObserverSlot{observer, handle.get()}, 0, [&](std::size_t slot) {
+                        _keyedIndex.Add(slot, observer, keys);
+                    });
                     return ObserverHandlePtr(handle.release());
                 }
 
-                void UnregisterObserver(IObserver* observer) override {
-                    std::lock_guard<std::recursive_mutex> lock(_mutex);
-                    for (
-                        auto thisObserver = _observers.begin();
-                        thisObserver != _observers.end();
-                        ++thisObserver
-                    ) {
-                        if (
-                            *thisObserver == nullptr ||
-                            (*thisObserver)->GetObserver() != observer
-                        ) {
-                            continue;
-                        }
+                /// Registers `observer` like `RegisterObserver()`, additionally
+                /// notifying it from `WithObserversMatching<ObserverType>(value, ...)`
+                /// for every `value` within `range`. Throws
+                /// `InvalidSubscriptionRangeException` if `range` is unordered or NaN.
+                ObserverHandlePtr RegisterObserver(IObserver* observer, SubscriptionRange range) {
+                    if (observer == nullptr) {
+                        throw InvalidObserverRegistrationException();
+                    }
+                    Detail::RangeDispatchIndex::Validate(range);
+                    RegistrationLock lock = _lockRegistrations();
+                    if (_slots.find(observer) != _slots.end()) {
+                        throw DuplicateObserverRegistrationException();
+                    }
+                    std::unique_ptr<ObserverHandle> handle(
+                        new ObserverHandle(GetLifetimeControl(), observer));
+                    _addSlot(Detail::ObserverSlot{observer, handle.get()}, 0, [&](std::size_t slot) {
+                        _rangeIndex.Add(slot, observer, range);
+                    });
+                    return ObserverHandlePtr(handle.release());
+                }
+
+                /// Registers `observer` like `RegisterObserver()`, returning an
+                /// `ObserverRegistration` instead of allocating a handle.
+                ObserverRegistration RegisterObserverByValue(IObserver* observer) {
+                    if (observer == nullptr) {
+                        throw InvalidObserverRegistrationException();
+                    }
+                    RegistrationLock lock = _lockRegistrations();
+                    if (_slots.find(observer) != _slots.end()) {
+                        throw DuplicateObserverRegistrationException();
+                    }
+                    const std::uint32_t registration = _registrationIds.Next();
+                    _addSlot(Detail::ObserverSlot{observer, nullptr}, registration, [](std::size_t) {});
+                    return ObserverRegistration(*this, observer, registration);
+                }
 
-                        static_cast<ObserverHandle*>(
-                            *thisObserver
-                        )->InvalidateRegistration();
+                /// Registers every Observer in `observers` (any range of pointers
+                /// convertible to `IObserver*`) under a single lock acquisition,
+                /// growing storage at most once. Either every Observer is registered,
+                /// with handles returned in the same order, or an exception is thrown
+                /// and none is.
+                template <class ObserverRange>
+                ObserverHandleBatch RegisterObservers(const ObserverRange& observers) {
+                    const std::vector<IObserver*> candidates = Detail::CollectObservers(observers);
+                    return _registerObservers(candidates);
+                }
 
-                        _observerCount.fetch_sub(
-                            1,
-                            std::memory_order_acq_rel
-                        );
+                ObserverHandleBatch RegisterObservers(std::initializer_list<IObserver*> observers) {
+                    return _registerObservers(std::vector<IObserver*>(observers));
+                }
 
-                        if (_notificationDepth > 0) {
-                            *thisObserver = nullptr;
-                            _needsCompaction = true;
-                        } else {
-                            _observers.erase(thisObserver);
-                        }
+                void UnregisterObserver(IObserver* observer) override {
+                    if (_isSharedByCurrentThread()) {
+                        _deferUnregistration(observer);
+                        return;
+                    }
+                    RegistrationLock lock = _lockRegistrations();
+                    if (!_vacateSlot(observer)) { return; }
+                    _observerCount.fetch_sub(
+                        1,
+                        std::memory_order_acq_rel
+                    );
+                    _compactIfWorthwhile();
+                }
+
+                /// Unregisters every registered Observer in `observers` under a
+                /// single lock acquisition, ignoring any that are not registered.
+                template <class ObserverRange>
+                void UnregisterObservers(const ObserverRange& observers) {
+                    if (_isSharedByCurrentThread()) {
+                        for (IObserver* observer : observers) { _deferUnregistration(observer); }
                         return;
                     }
+                    RegistrationLock lock = _lockRegistrations();
+                    std::size_t vacated = 0;
+                    for (IObserver* observer : observers) {
+                        if (_vacateSlot(observer)) { ++vacated; }
+                    }
+                    if (vacated == 0) { return; }
+                    _observerCount.fetch_sub(vacated, std::memory_order_acq_rel);
+                    _compactIfWorthwhile();
+                }
+
+                void UnregisterObservers(std::initializer_list<IObserver*> observers) {
+                    UnregisterObservers<std::initializer_list<IObserver*> >(observers);
+                }
+
+                /// Pre-allocates storage for `observerCount` registered Observers.
+                void Reserve(std::size_t observerCount) {
+                    RegistrationLock lock = _lockRegistrations();
+                    _observers.reserve(observerCount);
+                    _slots.reserve(observerCount);
+                }
+
+                /// Dispatches notifications to more than `chunkSize` Observers across
+                /// `pool`, in chunks of `chunkSize`, or serially again when `pool` is
+                /// null. The notifying thread participates and returns once every
+                /// callback has completed; callbacks must therefore be safe to run
+                /// concurrently. Every callback runs even if others throw, after
+                /// which a `ParallelNotificationException` carries their exceptions.
+                /// Observers unregistered by a callback are skipped by callbacks not
+                /// yet started, but one already running on another thread completes.
+                void SetParallelDispatch(
+                    std::shared_ptr<ParallelDispatchPool> pool,
+                    std::size_t chunkSize = 16) {
+                    RegistrationLock lock = _lockRegistrations();
+                    _parallelPool = std::move(pool);
+                    _parallelChunkSize = std::max<std::size_t>(chunkSize, 1);
                 }
 
                 bool IsObserverRegistered(IObserver* observer) override {
@@ -212,8 +913,9 @@ namespace ESPressio {
                         return false;
                     }
 
-                    std::lock_guard<std::recursive_mutex> lock(_mutex);
-                    return _isObserverRegistered(observer);
+                    RegistrationLock lock = _lockReading();
+                    const auto slot = _slots.find(observer);
+                    return slot != _slots.end() && !_isUnregistrationDeferred(slot->second.slot);
                 }
         };
 
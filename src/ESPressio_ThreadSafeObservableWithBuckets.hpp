@@ -0,0 +1,297 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ESPressio_EpochReclaimer.hpp"
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_IObserver.hpp"
+#include "ESPressio_InterfaceId.hpp"
+#include "ESPressio_ObservableWithBuckets.hpp"
+#include "ESPressio_ObserverHandle.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        /// A Thread Safe counterpart to `ObservableWithBuckets`.
+        /// Observer interfaces are supplied explicitly at registration, so
+        /// notification performs no dynamic casts.
+        /// Every interface bucket is an independently published read-copy-update
+        /// snapshot: notifications take no lock, so notifications of the same or
+        /// different interfaces proceed in parallel, and registration changes
+        /// only replace the buckets of the interfaces they affect.
+        /// `UnregisterObserver()` called outside of a notification of this
+        /// Observable waits for in-flight notifications to finish, so the Observer
+        /// may be destroyed as soon as it returns. Unregistration from within a
+        /// callback does not wait: the Observer is skipped by every notification
+        /// not yet past it, but a callback already running on another thread may
+        /// still complete.
+        class ThreadSafeObservableWithBuckets : public IObservable {
+            private:
+                struct Registration {
+                    ObserverHandle* handle;
+                    std::atomic<IObserver*> observer;
+                    std::vector<std::size_t> interfaces;
+
+                    Registration(
+                        ObserverHandle* observerHandle,
+                        IObserver* registeredObserver,
+                        std::vector<std::size_t> registeredInterfaces)
+                        : handle(observerHandle),
+                          observer(registeredObserver),
+                          interfaces(std::move(registeredInterfaces)) {}
+                };
+
+                struct BucketEntry {
+                    Registration* registration;
+                    void* observerInterface;
+                };
+
+                using BucketSnapshot = std::vector<BucketEntry>;
+
+                /// Buckets are created on first registration of an interface and
+                /// retained until destruction; only their entries are replaced.
+                struct Bucket {
+                    std::atomic<BucketSnapshot*> entries{nullptr};
+
+                    ~Bucket() { delete entries.load(); }
+                };
+
+                /// Indexed by `Detail::InterfaceId`; null where no Observer has
+                /// registered the interface.
+                using Directory = std::vector<Bucket*>;
+
+                /// A bucket replacement prepared before any state is published.
+                struct PendingBucket {
+                    Bucket* bucket;
+                    std::unique_ptr<BucketSnapshot> entries;
+                };
+
+                Detail::EpochReclaimer _reclaimer;
+                std::atomic<Directory*> _directory{nullptr};
+                std::vector<std::unique_ptr<Bucket> > _ownedBuckets;
+                std::unordered_map<IObserver*, Registration*> _registrations;
+                std::atomic<std::size_t> _observerCount{0};
+
+                /// Requires the writer mutex.
+                Bucket* _findBucket(std::size_t interfaceId) const {
+                    const Directory* directory = _directory.load();
+                    if (directory == nullptr || interfaceId >= directory->size()) {
+                        return nullptr;
+                    }
+                    return (*directory)[interfaceId];
+                }
+
+                /// Requires the writer mutex and one reserved retirement per
+                /// pending bucket.
+                static void _publishBuckets(
+                    Detail::EpochReclaimer& reclaimer,
+                    std::vector<PendingBucket>& pending) noexcept {
+                    for (PendingBucket& replacement : pending) {
+                        BucketSnapshot* entries = replacement.entries.release();
+                        if (entries != nullptr && entries->empty()) {
+                            delete entries;
+                            entries = nullptr;
+                        }
+                        reclaimer.Retire(replacement.bucket->entries.exchange(entries));
+                    }
+                }
+
+                /// Dispatch uses the interface pointer resolved during registration.
+                template <class ObserverType, class Callback>
+                void _withObservers(Callback&& callback) {
+                    Detail::EpochReclaimer::ReadSection section(_reclaimer);
+                    const std::size_t interfaceId =
+                        Detail::InterfaceId<ObserverType>::Value();
+                    const Directory* directory = _directory.load();
+                    if (directory == nullptr || interfaceId >= directory->size()) { return; }
+                    const Bucket* bucket = (*directory)[interfaceId];
+                    if (bucket == nullptr) { return; }
+                    const BucketSnapshot* entries = bucket->entries.load();
+                    if (entries == nullptr) { return; }
+
+                    Detail::EpochReclaimer::DispatchFrame frame(this);
+                    for (const BucketEntry& entry : *entries) {
+                        if (entry.registration->observer.load(std::memory_order_acquire) != nullptr) {
+                            callback(static_cast<ObserverType*>(entry.observerInterface));
+                        }
+                    }
+                }
+
+            protected:
+                class NotificationContext {
+                    private:
+                        friend class ThreadSafeObservableWithBuckets;
+                        ThreadSafeObservableWithBuckets& _observable;
+                        std::shared_ptr<IObservable> _notificationLifetime;
+                        NotificationContext(
+                            ThreadSafeObservableWithBuckets& observable,
+                            std::shared_ptr<IObservable> notificationLifetime)
+                            : _observable(observable),
+                              _notificationLifetime(std::move(notificationLifetime)) {}
+
+                    public:
+                        template <class ObserverType, class Callback>
+                        void WithObservers(Callback&& callback) {
+                            _observable._withObservers<ObserverType>(
+                                std::forward<Callback>(callback));
+                        }
+                };
+
+                template <class Operation>
+                void ExecuteNotification(Operation&& operation) {
+                    if (_observerCount.load(std::memory_order_acquire) == 0) {
+                        return;
+                    }
+
+                    NotificationContext context(
+                        *this,
+                        AcquireNotificationLifetime());
+                    operation(context);
+                }
+
+            public:
+                static constexpr bool IsThreadSafe = true;
+
+                ~ThreadSafeObservableWithBuckets() override {
+                    BeginObservableDestruction();
+                    std::lock_guard<std::mutex> lock(_reclaimer.GetWriterMutex());
+                    for (auto& registration : _registrations) {
+                        registration.second->handle->InvalidateRegistration();
+                        delete registration.second;
+                    }
+                    _registrations.clear();
+                    delete _directory.exchange(nullptr);
+                    _ownedBuckets.clear();
+                    _observerCount.store(0, std::memory_order_release);
+                }
+
+                template <class... ObserverInterfaces>
+                ObserverHandlePtr RegisterObserverAs(IObserver* observer) {
+                    const std::vector<Detail::ResolvedInterface> resolvedInterfaces =
+                        Detail::ResolveInterfaces<ObserverInterfaces...>(observer);
+
+                    std::vector<std::size_t> interfaceIds =
+                        Detail::SortedInterfaceIds(resolvedInterfaces);
+
+                    std::lock_guard<std::mutex> lock(_reclaimer.GetWriterMutex());
+                    const auto existing = _registrations.find(observer);
+                    if (existing != _registrations.end()) {
+                        if (existing->second->interfaces != interfaceIds) {
+                            throw ObserverRegistrationConflictException();
+                        }
+                        throw DuplicateObserverRegistrationException();
+                    }
+
+                    std::unique_ptr<ObserverHandle> handle(
+                        new ObserverHandle(GetLifetimeControl(), observer));
+                    std::unique_ptr<Registration> registration(
+                        new Registration(handle.get(), observer, std::move(interfaceIds)));
+
+                    const Directory* currentDirectory = _directory.load();
+                    std::unique_ptr<Directory> nextDirectory;
+                    std::vector<std::unique_ptr<Bucket> > newBuckets;
+                    std::vector<PendingBucket> pending;
+                    pending.reserve(resolvedInterfaces.size());
+
+                    for (const auto& resolved : resolvedInterfaces) {
+                        Bucket* bucket = _findBucket(resolved.first);
+                        if (bucket == nullptr) {
+                            if (!nextDirectory) {
+                                nextDirectory.reset(
+                                    currentDirectory == nullptr
+                                        ? new Directory()
+                                        : new Directory(*currentDirectory));
+                            }
+                            if (resolved.first >= nextDirectory->size()) {
+                                nextDirectory->resize(resolved.first + 1, nullptr);
+                            }
+                            newBuckets.emplace_back(new Bucket());
+                            bucket = newBuckets.back().get();
+                            (*nextDirectory)[resolved.first] = bucket;
+                        }
+
+                        const BucketSnapshot* current = bucket->entries.load();
+                        std::unique_ptr<BucketSnapshot> entries(new BucketSnapshot());
+                        entries->reserve((current == nullptr ? 0 : current->size()) + 1);
+                        if (current != nullptr) {
+                            entries->insert(entries->end(), current->begin(), current->end());
+                        }
+                        entries->push_back(BucketEntry{registration.get(), resolved.second});
+                        pending.push_back(PendingBucket{bucket, std::move(entries)});
+                    }
+
+                    _ownedBuckets.reserve(_ownedBuckets.size() + newBuckets.size());
+                    _reclaimer.ReserveRetirements(pending.size() + 1);
+                    _registrations.emplace(observer, registration.get());
+
+                    for (std::unique_ptr<Bucket>& bucket : newBuckets) {
+                        _ownedBuckets.push_back(std::move(bucket));
+                    }
+                    if (nextDirectory) {
+                        _reclaimer.Retire(_directory.exchange(nextDirectory.release()));
+                    }
+                    _publishBuckets(_reclaimer, pending);
+                    _reclaimer.Reclaim();
+
+                    registration.release();
+                    _observerCount.fetch_add(1, std::memory_order_release);
+                    return ObserverHandlePtr(handle.release());
+                }
+
+                void UnregisterObserver(IObserver* observer) override {
+                    std::size_t retiredEpoch = 0;
+                    {
+                        std::lock_guard<std::mutex> lock(_reclaimer.GetWriterMutex());
+                        const auto found = _registrations.find(observer);
+                        if (found == _registrations.end()) { return; }
+                        Registration* registration = found->second;
+
+                        std::vector<PendingBucket> pending;
+                        pending.reserve(registration->interfaces.size());
+                        for (const std::size_t interfaceId : registration->interfaces) {
+                            Bucket* bucket = _findBucket(interfaceId);
+                            const BucketSnapshot* current = bucket->entries.load();
+                            std::unique_ptr<BucketSnapshot> entries(new BucketSnapshot());
+                            entries->reserve(current->size() - 1);
+                            for (const BucketEntry& entry : *current) {
+                                if (entry.registration != registration) {
+                                    entries->push_back(entry);
+                                }
+                            }
+                            pending.push_back(PendingBucket{bucket, std::move(entries)});
+                        }
+                        _reclaimer.ReserveRetirements(pending.size() + 1);
+
+                        registration->handle->InvalidateRegistration();
+                        registration->observer.store(nullptr);
+                        _registrations.erase(found);
+                        _observerCount.fetch_sub(1, std::memory_order_acq_rel);
+                        _publishBuckets(_reclaimer, pending);
+                        retiredEpoch = _reclaimer.Retire(registration);
+                        _reclaimer.Reclaim();
+                    }
+
+                    if (!Detail::EpochReclaimer::IsDispatching(this)) {
+                        _reclaimer.WaitForGracePeriod(retiredEpoch);
+                    }
+                }
+
+                bool IsObserverRegistered(IObserver* observer) override {
+                    if (_observerCount.load(std::memory_order_acquire) == 0) {
+                        return false;
+                    }
+                    std::lock_guard<std::mutex> lock(_reclaimer.GetWriterMutex());
+                    return _registrations.find(observer) != _registrations.end();
+                }
+        };
+
+    }
+
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "ESPressio_EpochReclaimer.hpp"
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_IObserver.hpp"
+#include "ESPressio_ObserverHandle.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        /// A `ThreadSafeSnapshotObservable` is a Thread Safe `IUntypedObservable`
+        /// using read-copy-update dispatch.
+        /// Notifications load an immutable snapshot of the Observer list without
+        /// taking a lock, so concurrent notifications never serialise and
+        /// registration is never blocked by a slow Observer callback.
+        /// Registration and unregistration publish a new snapshot; superseded
+        /// snapshots are reclaimed once every notification that could still be
+        /// reading them has finished (two-epoch grace periods).
+        /// `UnregisterObserver()` called outside of a notification of this
+        /// Observable waits for in-flight notifications to finish, so the Observer
+        /// may be destroyed as soon as it returns. Unregistration from within a
+        /// callback does not wait: the Observer is skipped by every notification
+        /// not yet past it, but a callback already running on another thread may
+        /// still complete.
+        class ThreadSafeSnapshotObservable : public IUntypedObservable {
+            private:
+                struct Registration {
+                    ObserverHandle* handle;
+                    std::atomic<IObserver*> observer;
+
+                    Registration(ObserverHandle* observerHandle, IObserver* registeredObserver)
+                        : handle(observerHandle), observer(registeredObserver) {}
+                };
+
+                using Snapshot = std::vector<Registration*>;
+
+                Detail::EpochReclaimer _reclaimer;
+                std::atomic<Snapshot*> _snapshot{nullptr};
+                std::atomic<std::size_t> _observerCount{0};
+
+                /// Requires the writer mutex and capacity for two retirements.
+                std::size_t _publish(Snapshot* next, Registration* retiredRegistration) noexcept {
+                    _reclaimer.Retire(_snapshot.exchange(next));
+                    const std::size_t epoch = _reclaimer.Retire(retiredRegistration);
+                    _reclaimer.Reclaim();
+                    return epoch;
+                }
+
+                static Registration* _findRegistration(const Snapshot* snapshot, IObserver* observer) {
+                    if (snapshot == nullptr) { return nullptr; }
+                    for (Registration* registration : *snapshot) {
+                        if (registration->observer.load() == observer) { return registration; }
+                    }
+                    return nullptr;
+                }
+
+                template <class Callback>
+                void _withObservers(Callback&& callback) {
+                    Detail::EpochReclaimer::ReadSection section(_reclaimer);
+                    Detail::EpochReclaimer::DispatchFrame frame(this);
+                    const Snapshot* snapshot = _snapshot.load();
+                    if (snapshot == nullptr) { return; }
+                    for (Registration* registration : *snapshot) {
+                        IObserver* observer = registration->observer.load(std::memory_order_acquire);
+                        if (observer != nullptr) {
+                            callback(observer);
+                        }
+                    }
+                }
+
+                template <class ObserverType, class Callback>
+                void _withObservers(Callback&& callback) {
+                    Detail::EpochReclaimer::ReadSection section(_reclaimer);
+                    Detail::EpochReclaimer::DispatchFrame frame(this);
+                    const Snapshot* snapshot = _snapshot.load();
+                    if (snapshot == nullptr) { return; }
+                    for (Registration* registration : *snapshot) {
+                        IObserver* observer = registration->observer.load(std::memory_order_acquire);
+                        if (observer == nullptr) {
+                            continue;
+                        }
+                        ObserverType* observerAsT = ObserverCast<ObserverType>(observer);
+                        if (observerAsT != nullptr) {
+                            callback(observerAsT);
+                        }
+                    }
+                }
+
+            protected:
+                class NotificationContext {
+                    private:
+                        friend class ThreadSafeSnapshotObservable;
+                        ThreadSafeSnapshotObservable& _observable;
+                        std::shared_ptr<IObservable> _notificationLifetime;
+                        NotificationContext(
+                            ThreadSafeSnapshotObservable& observable,
+                            std::shared_ptr<IObservable> notificationLifetime)
+                            : _observable(observable),
+                              _notificationLifetime(std::move(notificationLifetime)) {}
+
+                    public:
+                        template <class Callback>
+                        void WithObservers(Callback&& callback) {
+                            _observable._withObservers(
+                                std::forward<Callback>(callback));
+                        }
+
+                        template <class ObserverType, class Callback>
+                        void WithObservers(Callback&& callback) {
+                            _observable._withObservers<ObserverType>(
+                                std::forward<Callback>(callback));
+                        }
+                };
+
+                template <class Operation>
+                void ExecuteNotification(Operation&& operation) {
+                    if (_observerCount.load(std::memory_order_acquire) == 0) {
+                        return;
+                    }
+
+                    NotificationContext context(
+                        *this,
+                        AcquireNotificationLifetime());
+                    operation(context);
+                }
+
+            public:
+                static constexpr bool IsThreadSafe = true;
+
+                ~ThreadSafeSnapshotObservable() override {
+                    BeginObservableDestruction();
+                    std::lock_guard<std::mutex> lock(_reclaimer.GetWriterMutex());
+                    Snapshot* snapshot = _snapshot.exchange(nullptr);
+                    if (snapshot != nullptr) {
+                        for (Registration* registration : *snapshot) {
+                            registration->handle->InvalidateRegistration();
+                            delete registration;
+                        }
+                        delete snapshot;
+                    }
+                    _observerCount.store(0, std::memory_order_release);
+                }
+
+                ObserverHandlePtr RegisterObserver(IObserver* observer) override {
+                    if (observer == nullptr) {
+                        throw InvalidObserverRegistrationException();
+                    }
+                    std::lock_guard<std::mutex> lock(_reclaimer.GetWriterMutex());
+                    const Snapshot* current = _snapshot.load();
+                    if (_findRegistration(current, observer) != nullptr) {
+                        throw DuplicateObserverRegistrationException();
+                    }
+
+                    std::unique_ptr<ObserverHandle> handle(
+                        new ObserverHandle(GetLifetimeControl(), observer));
+                    std::unique_ptr<Registration> registration(
+                        new Registration(handle.get(), observer));
+                    std::unique_ptr<Snapshot> next(new Snapshot());
+                    next->reserve((current == nullptr ? 0 : current->size()) + 1);
+                    if (current != nullptr) {
+                        next->insert(next->end(), current->begin(), current->end());
+                    }
+                    next->push_back(registration.get());
+                    _reclaimer.ReserveRetirements(2);
+
+                    registration.release();
+                    _publish(next.release(), nullptr);
+                    _observerCount.fetch_add(1, std::memory_order_release);
+                    return ObserverHandlePtr(handle.release());
+                }
+
+                void UnregisterObserver(IObserver* observer) override {
+                    if (observer == nullptr) { return; }
+
+                    std::size_t retiredEpoch = 0;
+                    {
+                        std::lock_guard<std::mutex> lock(_reclaimer.GetWriterMutex());
+                        const Snapshot* current = _snapshot.load();
+                        Registration* registration = _findRegistration(current, observer);
+                        if (registration == nullptr) { return; }
+
+                        std::unique_ptr<Snapshot> next;
+                        if (current->size() > 1) {
+                            next.reset(new Snapshot());
+                            next->reserve(current->size() - 1);
+                            for (Registration* retained : *current) {
+                                if (retained != registration) { next->push_back(retained); }
+                            }
+                        }
+                        _reclaimer.ReserveRetirements(2);
+
+                        registration->handle->InvalidateRegistration();
+                        registration->observer.store(nullptr);
+                        _observerCount.fetch_sub(1, std::memory_order_acq_rel);
+                        retiredEpoch = _publish(next.release(), registration);
+                    }
+
+                    if (!Detail::EpochReclaimer::IsDispatching(this)) {
+                        _reclaimer.WaitForGracePeriod(retiredEpoch);
+                    }
+                }
+
+                bool IsObserverRegistered(IObserver* observer) override {
+                    if (
+                        observer == nullptr ||
+                        _observerCount.load(std::memory_order_acquire) == 0
+                    ) {
+                        return false;
+                    }
+
+                    Detail::EpochReclaimer::ReadSection section(_reclaimer);
+                    return _findRegistration(_snapshot.load(), observer) != nullptr;
+                }
+        };
+
+    }
+
+}
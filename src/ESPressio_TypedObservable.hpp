@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ESPressio_DeferredDestruction.hpp"
+#include "ESPressio_IObservable.hpp"
+#include "ESPressio_IObserver.hpp"
+#include "ESPressio_ObserverHandle.hpp"
+#include "ESPressio_ObserverRegistration.hpp"
+
+namespace ESPressio {
+
+    namespace Observable {
+
+        /// A non-thread-safe Observable notifying exactly one Observer interface,
+        /// e.g. `TypedObservable<ITemperatureObserver>`.
+        /// Registered Observers are stored as a contiguous array of
+        /// `ObserverInterface*`, with their handles kept out of line, so
+        /// notification walks that array with no casts, no atomics and no
+        /// handle indirection.
+        /// Observers may register or unregister during a callback; those
+        /// registered during a notification are first notified by the next one.
+        template <class ObserverInterface>
+        class TypedObservable : public IObservable, public Detail::DeferredDestruction {
+            private:
+                struct Registration {
+                    std::size_t slot;
+                    /// Null for registrations returned by value.
+                    ObserverHandle* handle;
+                    std::uint32_t registration;
+                };
+
+                /// Dispatched directly in registration order; unregistered slots
+                /// are nulled and reclaimed by `_compactIfWorthwhile()`.
+                std::vector<ObserverInterface*> _observers;
+                /// The `IObserver` registered in each slot of `_observers`, read
+                /// only to re-index `_registrations` during compaction.
+                std::vector<IObserver*> _slotObservers;
+                std::unordered_map<IObserver*, Registration> _registrations;
+                Detail::RegistrationIds _registrationIds;
+                std::size_t _notificationDepth = 0;
+                std::size_t _vacantSlots = 0;
+
+                template <class ObserverType>
+                static void _validate(ObserverType* observer) {
+                    static_assert(
+                        std::is_convertible<ObserverType*, ObserverInterface*>::value,
+                        "Observer does not implement this TypedObservable's interface"
+                    );
+                    static_assert(
+                        std::is_convertible<ObserverType*, IObserver*>::value,
+                        "Observers must derive from IObserver"
+                    );
+                    if (observer == nullptr) {
+                        throw InvalidObserverRegistrationException();
+                    }
+                }
+
+                void _compactIfWorthwhile() noexcept {
+                    if (_notificationDepth > 0 || _vacantSlots == 0 ||
+                        _vacantSlots * 2 < _observers.size()) {
+                        return;
+                    }
+                    std::size_t liveSlots = 0;
+                    for (std::size_t slot = 0; slot < _observers.size(); ++slot) {
+                        if (_observers[slot] == nullptr) { continue; }
+                        _registrations.find(_slotObservers[slot])->second.slot = liveSlots;
+                        _observers[liveSlots] = _observers[slot];
+                        _slotObservers[liveSlots] = _slotObservers[slot];
+                        ++liveSlots;
+                    }
+                    _observers.resize(liveSlots);
+                    _slotObservers.resize(liveSlots);
+                    _vacantSlots = 0;
+                }
+
+                void _addSlot(
+                    IObserver* observer,
+                    ObserverInterface* observerInterface,
+                    ObserverHandle* handle,
+                    std::uint32_t registration) {
+                    const std::size_t slot = _observers.size();
+                    _observers.push_back(observerInterface);
+                    try {
+                        _slotObservers.push_back(observer);
+                        try {
+                            _registrations.emplace(observer, Registration{slot, handle, registration});
+                        } catch (...) {
+                            _slotObservers.pop_back();
+                            throw;
+                        }
+                    } catch (...) {
+                        _observers.pop_back();
+                        throw;
+                    }
+                }
+
+                void _finishNotification() noexcept {
+                    --_notificationDepth;
+                    _compactIfWorthwhile();
+                }
+
+                template <class Callback>
+                void _withObservers(Callback&& callback) {
+                    ++_notificationDepth;
+                    const std::size_t observerCount = _observers.size();
+                    try {
+                        for (std::size_t index = 0; index < observerCount; ++index) {
+                            ObserverInterface* observer = _observers[index];
+                            if (observer != nullptr) { callback(observer); }
+                        }
+                    } catch (...) {
+                        _finishNotification();
+                        throw;
+                    }
+                    _finishNotification();
+                }
+
+            protected:
+                void UnregisterObserverRegistration(IObserver* observer, std::uint32_t registration) override {
+                    const auto existing = _registrations.find(observer);
+                    if (existing == _registrations.end() || existing->second.registration != registration) {
+                        return;
+                    }
+                    UnregisterObserver(observer);
+                }
+
+                class NotificationContext {
+                    private:
+                        friend class TypedObservable;
+                        TypedObservable& _observable;
+                        Detail::NotificationLifetime _notificationLifetime;
+                        NotificationContext(
+                            TypedObservable& observable,
+                            std::shared_ptr<IObservable> notificationLifetime)
+                            : _observable(observable),
+                              _notificationLifetime(
+                                  observable, observable, std::move(notificationLifetime)) {}
+
+                    public:
+                        /// Invokes `callback` with the `ObserverInterface*` of every
+                        /// registered Observer.
+                        template <class Callback>
+                        void WithObservers(Callback&& callback) {
+                            _observable._withObservers(std::forward<Callback>(callback));
+                        }
+                };
+
+                template <class Operation>
+                void ExecuteNotification(Operation&& operation) {
+                    NotificationContext context(
+                        *this,
+                        IsDestructionDeferred()
+                            ? std::shared_ptr<IObservable>()
+                            : AcquireNotificationLifetime());
+                    operation(context);
+                }
+
+            public:
+                ~TypedObservable() override {
+                    BeginObservableDestruction();
+                    for (auto& registration : _registrations) {
+                        if (registration.second.handle != nullptr) {
+                            registration.second.handle->InvalidateRegistration();
+                        }
+                    }
+                    _observers.clear();
+                    _slotObservers.clear();
+                    _registrations.clear();
+                }
+
+                template <class ObserverType>
+                ObserverHandlePtr RegisterObserver(ObserverType* observer) {
+                    _validate(observer);
+                    IObserver* untypedObserver = observer;
+                    if (_registrations.find(untypedObserver) != _registrations.end()) {
+                        throw DuplicateObserverRegistrationException();
+                    }
+                    std::unique_ptr<ObserverHandle> handle(
+                        new ObserverHandle(GetLifetimeControl(), untypedObserver));
+                    _addSlot(untypedObserver, observer, handle.get(), 0);
+                    return ObserverHandlePtr(handle.release());
+                }
+
+                /// Registers `observer` like `RegisterObserver()`, returning an
+                /// `ObserverRegistration` instead of allocating a handle.
+                template <class ObserverType>
+                ObserverRegistration RegisterObserverByValue(ObserverType* observer) {
+                    _validate(observer);
+                    IObserver* untypedObserver = observer;
+                    if (_registrations.find(untypedObserver) != _registrations.end()) {
+                        throw DuplicateObserverRegistrationException();
+                    }
+                    const std::uint32_t registration = _registrationIds.Next();
+                    _addSlot(untypedObserver, observer, nullptr, registration);
+                    return ObserverRegistration(*this, untypedObserver, registration);
+                }
+
+                void UnregisterObserver(IObserver* observer) override {
+                    const auto registration = _registrations.find(observer);
+                    if (registration == _registrations.end()) { return; }
+
+                    if (registration->second.handle != nullptr) {
+                        registration->second.handle->InvalidateRegistration();
+                    }
+                    _observers[registration->second.slot] = nullptr;
+                    _registrations.erase(registration);
+                    ++_vacantSlots;
+                    _compactIfWorthwhile();
+                }
+
+                /// Pre-allocates storage for `observerCount` registered Observers.
+                void Reserve(std::size_t observerCount) {
+                    _observers.reserve(observerCount);
+                    _slotObservers.reserve(observerCount);
+                    _registrations.reserve(observerCount);
+                }
+
+                bool IsObserverRegistered(IObserver* observer) override {
+                    return _registrations.find(observer) != _registrations.end();
+                }
+        };
+
+    }
+
+}
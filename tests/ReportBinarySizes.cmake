@@ -0,0 +1,13 @@
+# Prints the size in bytes of each file in BINARIES.
+# Usage: cmake -DBINARIES=<file>;<file>... -P ReportBinarySizes.cmake
+foreach(binary IN LISTS BINARIES)
+    if(CMAKE_VERSION VERSION_LESS 3.14)
+        file(READ ${binary} contents HEX)
+        string(LENGTH "${contents}" hex_digits)
+        math(EXPR size "${hex_digits} / 2")
+    else()
+        file(SIZE ${binary} size)
+    endif()
+    get_filename_component(name ${binary} NAME)
+    message(STATUS "${name}: ${size} bytes")
+endforeach()
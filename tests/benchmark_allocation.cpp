@@ -0,0 +1,123 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "ESPressio_Observable.hpp"
+#include "ESPressio_ObservableWithBuckets.hpp"
+#include "ESPressio_ObserverRegistration.hpp"
+#include "ESPressio_ThreadSafeObservable.hpp"
+
+// Built twice: once with the default heap allocation and once with
+// ESPRESSIO_OBSERVABLE_POOLED_ALLOCATION=1, so the two reports can be compared.
+
+namespace {
+
+    std::atomic<std::size_t> heapAllocations{0};
+    std::atomic<std::size_t> heapBytes{0};
+
+}
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    heapBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* block = std::malloc(size == 0 ? 1 : size)) { return block; }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+using namespace ESPressio::Observable;
+
+namespace {
+
+    struct ISensor {
+        virtual ~ISensor() = default;
+        virtual void OnReading(int value) = 0;
+    };
+
+    struct SensorObserver final : ObserverOf<ISensor> {
+        int total = 0;
+        void OnReading(int value) override { total += value; }
+    };
+
+    class ChurnObservable final : public Observable {};
+    class ChurnThreadSafeObservable final : public ThreadSafeObservable {};
+    class ChurnBucketObservable final : public ObservableWithBuckets {};
+
+    template <class Operation>
+    void Measure(const char* name, std::size_t iterations, Operation&& operation) {
+        for (std::size_t index = 0; index < iterations / 10; ++index) { operation(); }
+
+        const std::size_t allocationsBefore = heapAllocations.load();
+        const std::size_t bytesBefore = heapBytes.load();
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t index = 0; index < iterations; ++index) { operation(); }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const std::size_t allocations = heapAllocations.load() - allocationsBefore;
+        const std::size_t bytes = heapBytes.load() - bytesBefore;
+
+        std::printf("%-48s %10.2f ns/op %8.3f heap allocations/op %8.1f heap bytes/op\n",
+            name,
+            std::chrono::duration<double, std::nano>(elapsed).count() /
+                static_cast<double>(iterations),
+            static_cast<double>(allocations) / static_cast<double>(iterations),
+            static_cast<double>(bytes) / static_cast<double>(iterations));
+    }
+
+}
+
+int main() {
+    const std::size_t iterations = 200000;
+    std::printf("allocation strategy: %s\n",
+        ESPRESSIO_OBSERVABLE_POOLED_ALLOCATION ? "slab pool" : "heap");
+
+    // Memory held by the Observer for each registration, beside the heap
+    // bytes reported below; an ObserverHandlePtr also owns a heap handle.
+    std::printf("per registration: ObserverHandlePtr %zu + ObserverHandle %zu bytes, "
+        "ObserverRegistration %zu bytes\n",
+        sizeof(ObserverHandlePtr), sizeof(ObserverHandle), sizeof(ObserverRegistration));
+
+    SensorObserver observer;
+    auto observable = std::make_shared<ChurnObservable>();
+    Measure("Observable register/unregister", iterations, [&]() {
+        ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+    });
+    Measure("Observable register/unregister by value", iterations, [&]() {
+        ObserverRegistration registration = observable->RegisterObserverByValue(&observer);
+    });
+
+    auto threadSafeObservable = std::make_shared<ChurnThreadSafeObservable>();
+    Measure("ThreadSafeObservable register/unregister", iterations, [&]() {
+        ObserverHandlePtr handle = threadSafeObservable->RegisterObserver(&observer);
+    });
+    Measure("ThreadSafeObservable register/unregister by value", iterations, [&]() {
+        ObserverRegistration registration =
+            threadSafeObservable->RegisterObserverByValue(&observer);
+    });
+
+    auto bucketObservable = std::make_shared<ChurnBucketObservable>();
+    Measure("ObservableWithBuckets register/unregister", iterations, [&]() {
+        ObserverHandlePtr handle = bucketObservable->RegisterObserverAs<ISensor>(&observer);
+    });
+    Measure("ObservableWithBuckets register/unregister by value", iterations, [&]() {
+        ObserverRegistration registration =
+            bucketObservable->RegisterObserverByValueAs<ISensor>(&observer);
+    });
+
+    Measure("Observable construct/destroy", iterations, []() {
+        ChurnObservable transient;
+    });
+
+    return 0;
+}
@@ -0,0 +1,1034 @@
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "ESPressio_AsyncObservable.hpp"
+#include "ESPressio_InterfaceId.hpp"
+#include "ESPressio_NotificationTransaction.hpp"
+#include "ESPressio_Observable.hpp"
+#include "ESPressio_ObservableInstrumentation.hpp"
+#include "ESPressio_ObservableValue.hpp"
+#include "ESPressio_ObservableWithBuckets.hpp"
+#include "ESPressio_ParallelDispatchPool.hpp"
+#include "ESPressio_ShardedThreadSafeObservable.hpp"
+#include "ESPressio_StaticObservable.hpp"
+#include "ESPressio_ThreadSafeObservable.hpp"
+#include "ESPressio_TypedObservable.hpp"
+
+using namespace ESPressio::Observable;
+
+namespace {
+
+    template <class Value>
+    inline void DoNotOptimize(const Value& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    template <class Operation>
+    double MeasureNanoseconds(std::size_t iterations, Operation&& operation) {
+        for (std::size_t index = 0; index < iterations / 10; ++index) { operation(); }
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t index = 0; index < iterations; ++index) { operation(); }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() /
+            static_cast<double>(iterations);
+    }
+
+    /// The dimensions a dispatch measurement was taken at; negative values
+    /// are not applicable and omitted from the JSON report.
+    struct DispatchParameters {
+        const char* observable;
+        const char* dispatch;
+        long observers;
+        int depth;
+        double hitRatio;
+    };
+
+    struct BenchmarkResult {
+        std::string name;
+        double nanoseconds;
+        DispatchParameters parameters;
+    };
+
+    std::vector<BenchmarkResult>& Results() {
+        static std::vector<BenchmarkResult> results;
+        return results;
+    }
+
+    void Report(
+        const char* name,
+        double nanoseconds,
+        DispatchParameters parameters = DispatchParameters{nullptr, nullptr, -1, -1, -1.0}) {
+        std::printf("%-48s %10.2f ns/op\n", name, nanoseconds);
+        Results().push_back(BenchmarkResult{name, nanoseconds, parameters});
+    }
+
+    void WriteJsonString(std::FILE* file, const char* text) {
+        std::fputc('"', file);
+        for (; *text != '\0'; ++text) {
+            if (*text == '"' || *text == '\\') { std::fputc('\\', file); }
+            std::fputc(*text, file);
+        }
+        std::fputc('"', file);
+    }
+
+    /// Compiling instrumentation out must leave the Observables unchanged.
+    static_assert(
+        ESPRESSIO_OBSERVABLE_INSTRUMENTATION || std::is_empty<Detail::ObservableCounters>::value,
+        "Disabled instrumentation must add no storage");
+
+    /// Writes every reported result as `{"benchmarks": [...]}`, one object
+    /// per result with its name, ns/op and any dispatch dimensions.
+    bool WriteJsonReport(const char* path, bool quick) {
+        std::FILE* file = std::fopen(path, "w");
+        if (file == nullptr) { return false; }
+        std::fprintf(file, "{\n  \"quick\": %s,\n  \"instrumentation\": %s,\n  \"rtti\": %s,\n  \"benchmarks\": [",
+            quick ? "true" : "false",
+            ESPRESSIO_OBSERVABLE_INSTRUMENTATION ? "true" : "false",
+            ESPRESSIO_OBSERVABLE_NO_RTTI ? "false" : "true");
+        const std::vector<BenchmarkResult>& results = Results();
+        for (std::size_t index = 0; index < results.size(); ++index) {
+            const BenchmarkResult& result = results[index];
+            const DispatchParameters& parameters = result.parameters;
+            std::fprintf(file, "%s\n    {\"name\": ", index == 0 ? "" : ",");
+            WriteJsonString(file, result.name.c_str());
+            std::fprintf(file, ", \"ns_per_op\": %.3f", result.nanoseconds);
+            if (parameters.observable != nullptr) {
+                std::fprintf(file, ", \"observable\": ");
+                WriteJsonString(file, parameters.observable);
+            }
+            if (parameters.dispatch != nullptr) {
+                std::fprintf(file, ", \"dispatch\": ");
+                WriteJsonString(file, parameters.dispatch);
+            }
+            if (parameters.observers >= 0) {
+                std::fprintf(file, ", \"observers\": %ld", parameters.observers);
+                if (parameters.observers > 0) {
+                    std::fprintf(file, ", \"ns_per_observer\": %.3f",
+                        result.nanoseconds / static_cast<double>(parameters.observers));
+                }
+            }
+            if (parameters.depth >= 0) {
+                std::fprintf(file, ", \"depth\": %d", parameters.depth);
+            }
+            if (parameters.hitRatio >= 0.0) {
+                std::fprintf(file, ", \"hit_ratio\": %.2f", parameters.hitRatio);
+            }
+            std::fputc('}', file);
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+        return std::fclose(file) == 0;
+    }
+
+    struct ISensor {
+        virtual ~ISensor() = default;
+        virtual void OnReading(int value) = 0;
+    };
+
+    struct IAlarm {
+        virtual ~IAlarm() = default;
+        virtual void OnAlarm() = 0;
+    };
+
+    struct IStatus {
+        virtual ~IStatus() = default;
+        virtual void OnStatus() = 0;
+    };
+
+    struct SensorObserver final : ObserverOf<ISensor, IAlarm, IStatus> {
+        int total = 0;
+        void OnReading(int value) override { total += value; }
+        void OnAlarm() override { ++total; }
+        void OnStatus() override { --total; }
+    };
+
+    class BenchmarkBucketObservable final : public ObservableWithBuckets {
+        public:
+            void NotifyReading(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<ISensor>(
+                        [value](ISensor* observer) { observer->OnReading(value); });
+                });
+            }
+    };
+
+    class BenchmarkStaticObservable final
+        : public StaticObservable<ISensor, IAlarm, IStatus> {
+        public:
+            void NotifyReading(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<ISensor>(
+                        [value](ISensor* observer) { observer->OnReading(value); });
+                });
+            }
+    };
+
+    class BenchmarkSensorObservable final : public Observable {
+        public:
+            void NotifyReading(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<ISensor>(
+                        [value](ISensor* observer) { observer->OnReading(value); });
+                });
+            }
+    };
+
+    class BenchmarkTypedObservable final : public TypedObservable<ISensor> {
+        public:
+            void NotifyReading(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers(
+                        [value](ISensor* observer) { observer->OnReading(value); });
+                });
+            }
+    };
+
+    class BenchmarkUntypedObservable final : public Observable {};
+
+    class BenchmarkDeferrableObservable final : public Observable {
+        public:
+            void NotifyReading(int value) {
+                ExecuteDeferrableNotification<ISensor>(
+                    [value](ISensor* observer) { observer->OnReading(value); });
+            }
+    };
+
+    class BenchmarkThreadSafeObservable final : public ThreadSafeObservable {
+        public:
+            explicit BenchmarkThreadSafeObservable(ThreadSafeLocking locking = ThreadSafeLocking::Recursive)
+                : ThreadSafeObservable(locking) {}
+
+            void NotifyReading(int value) {
+                ExecuteNotification([value](NotificationContext& notification) {
+                    notification.WithObservers<ISensor>(
+                        [value](ISensor* observer) { observer->OnReading(value); });
+                });
+            }
+
+            void NotifyReading(SubscriptionKey key, int value) {
+                ExecuteNotification([key, value](NotificationContext& notification) {
+                    notification.WithObservers<ISensor>(
+                        key, [value](ISensor* observer) { observer->OnReading(value); });
+                });
+            }
+
+            void NotifyMatchingReading(int value) {
+                ExecuteNotification([value](NotificationContext& notification) {
+                    notification.WithObserversMatching<ISensor>(
+                        value, [value](ISensor* observer) { observer->OnReading(value); });
+                });
+            }
+    };
+
+    class BenchmarkAsyncObservable final : public AsyncObservable {
+        public:
+            BenchmarkAsyncObservable(std::size_t queueCapacity, AsyncDispatchMode mode)
+                : AsyncObservable(queueCapacity, mode) {}
+
+            /// Retries while the queue is full, so back-pressure from the
+            /// dispatcher thread is included in the producer's cost.
+            void NotifyReading(int value) {
+                while (!TryExecuteNotification([value](NotificationContext& notification) {
+                    notification.WithObservers<ISensor>(
+                        [value](ISensor* observer) { observer->OnReading(value); });
+                })) {
+                    std::this_thread::yield();
+                }
+            }
+
+            /// Sets `delivered` once every earlier notification has been delivered.
+            void NotifyDelivered(std::atomic<bool>& delivered) {
+                std::atomic<bool>* flag = &delivered;
+                while (!TryExecuteNotification([flag](NotificationContext&) {
+                    flag->store(true, std::memory_order_release);
+                })) {
+                    std::this_thread::yield();
+                }
+            }
+    };
+
+    struct ReadingObserver final : ObserverOf<IValueObserver<int> > {
+        int total = 0;
+        void OnValueChanged(const int&, const int& current) override { total += current; }
+    };
+
+    /// One `ISensor` notification to 16 Observers through each Observable
+    /// able to notify a single interface.
+    void BenchmarkSingleInterfaceDispatch(std::size_t iterations) {
+        std::vector<SensorObserver> observers(16);
+        std::vector<ObserverHandlePtr> handles;
+
+        auto observable = std::make_shared<BenchmarkSensorObservable>();
+        auto typed = std::make_shared<BenchmarkTypedObservable>();
+        for (SensorObserver& observer : observers) {
+            handles.push_back(observable->RegisterObserver(&observer));
+            handles.push_back(typed->RegisterObserver(&observer));
+        }
+        Report("Observable notify ISensor (16 observers)",
+            MeasureNanoseconds(iterations, [&]() { observable->NotifyReading(1); }));
+        Report("TypedObservable<ISensor> notify (16 observers)",
+            MeasureNanoseconds(iterations, [&]() { typed->NotifyReading(1); }));
+        DoNotOptimize(observers.front().total);
+    }
+
+    /// An Observer interested in one sensor, ignoring readings of the others.
+    struct FilteringSensorObserver final : ObserverOf<ISensor> {
+        int sensor = 0;
+        int total = 0;
+        void OnReading(int value) override {
+            if (value == sensor) { total += value; }
+        }
+    };
+
+    /// One reading on a bus of 4096 Observers, 4 per sensor: broadcast with each
+    /// Observer filtering, then delivered through the reading's key.
+    void BenchmarkKeyedSubscriptions(std::size_t iterations) {
+        const int sensors = 1024;
+        auto observable = std::make_shared<BenchmarkThreadSafeObservable>();
+        std::vector<FilteringSensorObserver> observers(4 * sensors);
+        std::vector<ObserverHandlePtr> handles;
+        for (std::size_t index = 0; index < observers.size(); ++index) {
+            observers[index].sensor = static_cast<int>(index) % sensors;
+            handles.push_back(observable->RegisterObserver(
+                &observers[index], static_cast<SubscriptionKey>(observers[index].sensor)));
+        }
+
+        int sensor = 0;
+        Report("ThreadSafeObservable reading (4096 observers), filtered",
+            MeasureNanoseconds(iterations, [&]() {
+                observable->NotifyReading(sensor);
+                sensor = (sensor + 1) % sensors;
+            }));
+        Report("ThreadSafeObservable reading (4096 observers), keyed",
+            MeasureNanoseconds(iterations, [&]() {
+                observable->NotifyReading(static_cast<SubscriptionKey>(sensor), sensor);
+                sensor = (sensor + 1) % sensors;
+            }));
+        DoNotOptimize(observers.back().total);
+    }
+
+    /// An Observer alarming on readings within its band, ignoring the rest.
+    struct BandSensorObserver final : ObserverOf<ISensor> {
+        int lower = 0;
+        int upper = 0;
+        int alarms = 0;
+        void OnReading(int value) override {
+            if (lower <= value && value <= upper) { ++alarms; }
+        }
+    };
+
+    /// One reading on a bus of 4096 Observers with overlapping bands of width
+    /// 8, so about 8 contain each reading: broadcast with each Observer
+    /// filtering, then delivered only to the bands containing the reading.
+    void BenchmarkRangeSubscriptions(std::size_t iterations) {
+        const int observerCount = 4096;
+        auto observable = std::make_shared<BenchmarkThreadSafeObservable>();
+        std::vector<BandSensorObserver> observers(observerCount);
+        std::vector<ObserverHandlePtr> handles;
+        for (int index = 0; index < observerCount; ++index) {
+            observers[index].lower = index;
+            observers[index].upper = index + 7;
+            handles.push_back(observable->RegisterObserver(
+                &observers[index], SubscriptionRange::Between(index, index + 7)));
+        }
+
+        int reading = 0;
+        Report("ThreadSafeObservable reading (4096 bands), filtered",
+            MeasureNanoseconds(iterations, [&]() {
+                observable->NotifyReading(reading);
+                reading = (reading + 1) % observerCount;
+            }));
+        Report("ThreadSafeObservable reading (4096 bands), range-indexed",
+            MeasureNanoseconds(iterations, [&]() {
+                observable->NotifyMatchingReading(reading);
+                reading = (reading + 1) % observerCount;
+            }));
+        DoNotOptimize(observers.back().alarms);
+    }
+
+    /// A burst of 16 sensor writes to 16 Observers, notified per write and
+    /// coalesced into one notification.
+    void BenchmarkObservableValueBurst(std::size_t iterations) {
+        auto reading = std::make_shared<ObservableValue<int> >();
+        std::vector<ReadingObserver> observers(16);
+        std::vector<ObserverHandlePtr> handles;
+        for (ReadingObserver& observer : observers) {
+            handles.push_back(reading->RegisterObserver(&observer));
+        }
+
+        int next = 0;
+        Report("ObservableValue burst of 16 writes", MeasureNanoseconds(iterations, [&]() {
+            for (int write = 0; write < 16; ++write) { reading->Set(++next); }
+        }));
+        Report("ObservableValue coalesced burst of 16 writes", MeasureNanoseconds(iterations, [&]() {
+            reading->Coalesce([&]() {
+                for (int write = 0; write < 16; ++write) { reading->Set(++next); }
+            });
+        }));
+        DoNotOptimize(observers.front().total);
+    }
+
+    /// An Observer that recomputes a value derived from several sources
+    /// whenever any of them changes.
+    struct DependentObserver final : ObserverOf<ISensor> {
+        std::uint32_t derived = 1;
+        void OnReading(int value) override {
+            for (int round = 0; round < 64; ++round) {
+                derived = derived * 1664525u + 1013904223u + static_cast<std::uint32_t>(value);
+            }
+        }
+    };
+
+    /// One update to six Observables that the same 16 Observers depend on,
+    /// notified per Observable and within a `NotificationTransaction`.
+    void BenchmarkNotificationTransaction(std::size_t iterations) {
+        std::vector<std::shared_ptr<BenchmarkDeferrableObservable> > sources;
+        std::vector<DependentObserver> observers(16);
+        std::vector<ObserverHandlePtr> handles;
+        for (int source = 0; source < 6; ++source) {
+            sources.push_back(std::make_shared<BenchmarkDeferrableObservable>());
+            for (DependentObserver& observer : observers) {
+                handles.push_back(sources.back()->RegisterObserver(&observer));
+            }
+        }
+
+        int next = 0;
+        Report("Update of 6 dependencies, notified each", MeasureNanoseconds(iterations, [&]() {
+            for (const auto& source : sources) { source->NotifyReading(++next); }
+        }));
+        Report("Update of 6 dependencies, in a transaction", MeasureNanoseconds(iterations, [&]() {
+            NotificationTransaction transaction;
+            for (const auto& source : sources) { source->NotifyReading(++next); }
+            transaction.Commit();
+        }));
+        DoNotOptimize(observers.front().derived);
+    }
+
+    /// Re-raises every reading, less one, on the Observable it observes, so
+    /// one notification cascades into `value` more.
+    struct CascadingObserver final : ObserverOf<ISensor> {
+        BenchmarkDeferrableObservable* observable = nullptr;
+        void OnReading(int value) override {
+            if (value > 0) { observable->NotifyReading(value - 1); }
+        }
+    };
+
+    /// A cascade of 64 notifications raised by a callback, each nested in the
+    /// last and queued by run-to-completion.
+    void BenchmarkRunToCompletion(std::size_t iterations) {
+        auto observable = std::make_shared<BenchmarkDeferrableObservable>();
+        CascadingObserver cascading;
+        cascading.observable = observable.get();
+        SensorObserver observer;
+        ObserverHandlePtr cascadingHandle = observable->RegisterObserver(&cascading);
+        ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+
+        Report("Cascade of 64 notifications, nested", MeasureNanoseconds(iterations, [&]() {
+            observable->NotifyReading(63);
+        }));
+        observable->EnableRunToCompletion();
+        Report("Cascade of 64 notifications, run to completion", MeasureNanoseconds(iterations, [&]() {
+            observable->NotifyReading(63);
+        }));
+        DoNotOptimize(observer.total);
+    }
+
+    /// One notification to 16 Observers with latency tracking disabled, then
+    /// enabled with a budget no callback exceeds.
+    void BenchmarkLatencyTracking(std::size_t iterations) {
+        auto observable = std::make_shared<BenchmarkDeferrableObservable>();
+        std::vector<SensorObserver> observers(16);
+        std::vector<ObserverHandlePtr> handles;
+        for (SensorObserver& observer : observers) {
+            handles.push_back(observable->RegisterObserver(&observer));
+        }
+
+        Report("Observable notify (16 observers), latency untracked",
+            MeasureNanoseconds(iterations, [&]() { observable->NotifyReading(1); }));
+        observable->EnableLatencyTracking(
+            std::chrono::seconds(1), [](IObserver*, std::chrono::nanoseconds) {});
+        Report("Observable notify (16 observers), latency tracked",
+            MeasureNanoseconds(iterations, [&]() { observable->NotifyReading(1); }));
+        DoNotOptimize(handles.front()->GetLatencyHistogram().GetSampleCount());
+    }
+
+    /// One notification to a single Observer, retaining the Observable through
+    /// `shared_from_this()` and then counting it as `MakeObservable()` allows.
+    void BenchmarkNotificationLifetime(std::size_t iterations) {
+        std::shared_ptr<BenchmarkDeferrableObservable> observables[] = {
+            std::make_shared<BenchmarkDeferrableObservable>(),
+            MakeObservable<BenchmarkDeferrableObservable>()
+        };
+        const char* names[] = {
+            "Observable notify (1 observer), make_shared",
+            "Observable notify (1 observer), MakeObservable"
+        };
+        SensorObserver observer;
+        for (std::size_t index = 0; index < 2; ++index) {
+            ObserverHandlePtr handle = observables[index]->RegisterObserver(&observer);
+            Report(names[index], MeasureNanoseconds(iterations, [&]() {
+                observables[index]->NotifyReading(1);
+            }));
+        }
+        DoNotOptimize(observer);
+    }
+
+    /// An Observer whose callback does enough independent work to be worth
+    /// running in parallel.
+    struct HeavySensorObserver final : ObserverOf<ISensor, IAlarm, IStatus> {
+        std::uint32_t state = 1;
+        void OnReading(int value) override {
+            for (int round = 0; round < 2000; ++round) {
+                state = state * 1664525u + 1013904223u + static_cast<std::uint32_t>(value);
+            }
+        }
+        void OnAlarm() override {}
+        void OnStatus() override {}
+    };
+
+    /// One notification to 4096 CPU-heavy Observers, fanned out across pools of
+    /// increasing size; the one-thread row is serial dispatch.
+    void BenchmarkParallelFanOutScaling() {
+        const std::size_t observerCount = 4096;
+        std::vector<HeavySensorObserver> observers(observerCount);
+        const std::size_t hardwareThreads =
+            std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+        std::vector<std::size_t> threadCounts;
+        for (std::size_t threads = 1; threads < hardwareThreads; threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(hardwareThreads);
+
+        for (const std::size_t threads : threadCounts) {
+            auto observable = std::make_shared<BenchmarkThreadSafeObservable>();
+            std::vector<ObserverHandlePtr> handles;
+            for (HeavySensorObserver& observer : observers) {
+                handles.push_back(observable->RegisterObserver(&observer));
+            }
+            if (threads > 1) {
+                observable->SetParallelDispatch(
+                    std::make_shared<ParallelDispatchPool>(threads - 1), 64);
+            }
+
+            char name[64];
+            std::snprintf(name, sizeof(name),
+                "ThreadSafeObservable fan-out (%zu threads)", threads);
+            Report(name, MeasureNanoseconds(20, [&]() { observable->NotifyReading(1); }));
+        }
+        DoNotOptimize(observers.front().state);
+    }
+
+    /// Wall time per register+unregister pair while `threads` threads each
+    /// churn 256 Observers of one shared Observable.
+    template <class ObservableType>
+    double MeasureRegistrationChurn(std::shared_ptr<ObservableType> observable, std::size_t threads) {
+        const std::size_t observersPerThread = 256;
+        const std::size_t rounds = 20;
+        std::atomic<bool> start{false};
+        std::vector<std::thread> workers;
+        for (std::size_t thread = 0; thread < threads; ++thread) {
+            workers.emplace_back([&]() {
+                std::vector<SensorObserver> observers(observersPerThread);
+                std::vector<ObserverHandlePtr> handles(observersPerThread);
+                while (!start.load()) { std::this_thread::yield(); }
+                for (std::size_t round = 0; round < rounds; ++round) {
+                    for (std::size_t index = 0; index < observersPerThread; ++index) {
+                        handles[index] = observable->RegisterObserver(&observers[index]);
+                    }
+                    for (ObserverHandlePtr& handle : handles) { handle.reset(); }
+                }
+            });
+        }
+        const auto begin = std::chrono::steady_clock::now();
+        start.store(true);
+        for (std::thread& worker : workers) { worker.join(); }
+        const auto elapsed = std::chrono::steady_clock::now() - begin;
+        return std::chrono::duration<double, std::nano>(elapsed).count() /
+            static_cast<double>(threads * rounds * observersPerThread);
+    }
+
+    /// Registration churn from 1 to every hardware thread, against one
+    /// registration mutex and against one shard per hardware thread.
+    void BenchmarkShardedRegistrationScaling() {
+        const std::size_t hardwareThreads =
+            std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        std::vector<std::size_t> threadCounts;
+        for (std::size_t threads = 1; threads < hardwareThreads; threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(hardwareThreads);
+
+        for (const std::size_t threads : threadCounts) {
+            char name[64];
+            std::snprintf(name, sizeof(name),
+                "ThreadSafeObservable register churn (%zu threads)", threads);
+            Report(name, MeasureRegistrationChurn(std::make_shared<ThreadSafeObservable>(), threads));
+            std::snprintf(name, sizeof(name),
+                "ShardedThreadSafeObservable register churn (%zu threads)", threads);
+            Report(name, MeasureRegistrationChurn(
+                std::make_shared<ShardedThreadSafeObservable>(), threads));
+        }
+    }
+
+    /// Keeps no state, so that several threads may notify it at once.
+    struct StatelessSensorObserver final : ObserverOf<ISensor> {
+        void OnReading(int value) override {
+            std::uint32_t state = static_cast<std::uint32_t>(value);
+            for (int round = 0; round < 200; ++round) { state = state * 1664525u + 1013904223u; }
+            DoNotOptimize(state);
+        }
+    };
+
+    /// Wall time per notification while `threads` threads each notify 64
+    /// Observers of one shared Observable.
+    double MeasureContendedNotification(ThreadSafeLocking locking, std::size_t threads) {
+        const std::size_t notificationsPerThread = 2000;
+        auto observable = std::make_shared<BenchmarkThreadSafeObservable>(locking);
+        std::vector<StatelessSensorObserver> observers(64);
+        std::vector<ObserverHandlePtr> handles;
+        for (StatelessSensorObserver& observer : observers) {
+            handles.push_back(observable->RegisterObserver(&observer));
+        }
+
+        std::atomic<bool> start{false};
+        std::vector<std::thread> workers;
+        for (std::size_t thread = 0; thread < threads; ++thread) {
+            workers.emplace_back([&]() {
+                while (!start.load()) { std::this_thread::yield(); }
+                for (std::size_t index = 0; index < notificationsPerThread; ++index) {
+                    observable->NotifyReading(static_cast<int>(index));
+                }
+            });
+        }
+        const auto begin = std::chrono::steady_clock::now();
+        start.store(true);
+        for (std::thread& worker : workers) { worker.join(); }
+        const auto elapsed = std::chrono::steady_clock::now() - begin;
+        return std::chrono::duration<double, std::nano>(elapsed).count() /
+            static_cast<double>(threads * notificationsPerThread);
+    }
+
+    /// Notifications from 1 to every hardware thread, serialised by the
+    /// recursive mutex against sharing `ThreadSafeLocking::ReaderWriter`.
+    void BenchmarkContendedNotification() {
+        const std::size_t hardwareThreads =
+            std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        std::vector<std::size_t> threadCounts;
+        for (std::size_t threads = 1; threads < hardwareThreads; threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(hardwareThreads);
+
+        for (const std::size_t threads : threadCounts) {
+            char name[64];
+            std::snprintf(name, sizeof(name),
+                "ThreadSafeObservable recursive notify (%zu threads)", threads);
+            Report(name, MeasureContendedNotification(ThreadSafeLocking::Recursive, threads));
+            std::snprintf(name, sizeof(name),
+                "ThreadSafeObservable reader/writer notify (%zu threads)", threads);
+            Report(name, MeasureContendedNotification(ThreadSafeLocking::ReaderWriter, threads));
+        }
+    }
+
+    /// The cost the notifying thread pays: synchronous delivery to every
+    /// Observer against enqueueing for the dispatcher thread. The end-to-end
+    /// figure is the time until the dispatcher has delivered every reading.
+    void BenchmarkAsyncNotification(std::size_t iterations) {
+        const std::size_t observerCount = 16;
+        std::vector<SensorObserver> observers(observerCount);
+
+        {
+            auto observable = std::make_shared<BenchmarkThreadSafeObservable>();
+            std::vector<ObserverHandlePtr> handles;
+            for (SensorObserver& observer : observers) {
+                handles.push_back(observable->RegisterObserver(&observer));
+            }
+            Report("ThreadSafeObservable notify (16 observers)",
+                MeasureNanoseconds(iterations, [&]() { observable->NotifyReading(1); }));
+        }
+
+        {
+            const std::size_t burst = 4096;
+            auto observable = std::make_shared<BenchmarkAsyncObservable>(
+                burst, AsyncDispatchMode::Manual);
+            std::vector<ObserverHandlePtr> handles;
+            for (SensorObserver& observer : observers) {
+                handles.push_back(observable->RegisterObserver(&observer));
+            }
+            std::chrono::steady_clock::duration enqueueing{};
+            for (std::size_t queued = 0; queued < iterations; queued += burst) {
+                const auto start = std::chrono::steady_clock::now();
+                for (std::size_t index = 0; index < burst; ++index) {
+                    observable->NotifyReading(1);
+                }
+                enqueueing += std::chrono::steady_clock::now() - start;
+                observable->Drain();
+            }
+            Report("AsyncObservable enqueue, manual drain",
+                std::chrono::duration<double, std::nano>(enqueueing).count() /
+                    static_cast<double>((iterations + burst - 1) / burst * burst));
+        }
+
+        auto observable = std::make_shared<BenchmarkAsyncObservable>(
+            4096, AsyncDispatchMode::DispatcherThread);
+        std::vector<ObserverHandlePtr> handles;
+        for (SensorObserver& observer : observers) {
+            handles.push_back(observable->RegisterObserver(&observer));
+        }
+        Report("AsyncObservable enqueue, dispatcher thread",
+            MeasureNanoseconds(iterations, [&]() { observable->NotifyReading(1); }));
+
+        std::atomic<bool> delivered{false};
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t index = 0; index < iterations; ++index) {
+            observable->NotifyReading(1);
+        }
+        observable->NotifyDelivered(delivered);
+        while (!delivered.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        Report("AsyncObservable end-to-end, dispatcher thread",
+            std::chrono::duration<double, std::nano>(elapsed).count() /
+                static_cast<double>(iterations));
+        DoNotOptimize(observers.front().total);
+    }
+
+    /// The Acquire/Release pair behind every `ObserverHandle::Unregister()`,
+    /// run concurrently on one Observable's lifetime control.
+    void BenchmarkLifetimeControl(std::size_t iterations) {
+        auto observable = std::make_shared<BenchmarkUntypedObservable>();
+        Detail::ObservableLifetimeControl control(observable.get());
+        const std::size_t threadCounts[] = {1, 4};
+        for (const std::size_t threads : threadCounts) {
+            std::atomic<bool> start{false};
+            std::vector<std::thread> workers;
+            for (std::size_t worker = 0; worker < threads; ++worker) {
+                workers.emplace_back([&control, &start, iterations]() {
+                    while (!start.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+                    for (std::size_t index = 0; index < iterations; ++index) {
+                        DoNotOptimize(control.Acquire());
+                        control.Release();
+                    }
+                });
+            }
+            const auto began = std::chrono::steady_clock::now();
+            start.store(true, std::memory_order_release);
+            for (std::thread& worker : workers) { worker.join(); }
+            const auto elapsed = std::chrono::steady_clock::now() - began;
+            char name[80];
+            std::snprintf(name, sizeof(name),
+                "lifetime Acquire/Release, %zu thread(s)", threads);
+            Report(name, std::chrono::duration<double, std::nano>(elapsed).count() /
+                static_cast<double>(iterations * threads));
+        }
+        control.InvalidateAndWait();
+    }
+
+    /// Registering and then unregistering `observerCount` Observers; the cost
+    /// per Observer stays flat as the count grows.
+    void BenchmarkRegistrationScaling() {
+        const std::size_t observerCounts[] = {64, 1024, 8192};
+        for (const std::size_t observerCount : observerCounts) {
+            std::vector<SensorObserver> observers(observerCount);
+            std::vector<ObserverHandlePtr> handles(observerCount);
+            auto observable = std::make_shared<BenchmarkUntypedObservable>();
+            const double nanoseconds = MeasureNanoseconds(20, [&]() {
+                for (std::size_t index = 0; index < observerCount; ++index) {
+                    handles[index] = observable->RegisterObserver(&observers[index]);
+                }
+                for (std::size_t index = 0; index < observerCount; ++index) {
+                    DoNotOptimize(observable->IsObserverRegistered(&observers[index]));
+                    handles[index].reset();
+                }
+            });
+
+            char name[64];
+            std::snprintf(name, sizeof(name),
+                "Observable register+unregister (%zu observers)", observerCount);
+            Report(name, nanoseconds / static_cast<double>(observerCount));
+        }
+    }
+
+    /// Bucket selection alone: the `type_index` hash lookup that
+    /// `ObservableWithBuckets` used to perform, against a dense ID index. The
+    /// `type_index` lookup needs RTTI, so the no-RTTI build skips it.
+    void BenchmarkBucketSelection(std::size_t iterations) {
+        using Bucket = std::vector<void*>;
+#if !ESPRESSIO_OBSERVABLE_NO_RTTI
+        std::unordered_map<std::type_index, Bucket> hashedBuckets;
+        hashedBuckets[std::type_index(typeid(ISensor))].push_back(nullptr);
+        hashedBuckets[std::type_index(typeid(IAlarm))].push_back(nullptr);
+        hashedBuckets[std::type_index(typeid(IStatus))].push_back(nullptr);
+#endif
+
+        std::vector<Bucket> denseBuckets;
+        const std::size_t ids[] = {
+            Detail::InterfaceId<ISensor>::Value(),
+            Detail::InterfaceId<IAlarm>::Value(),
+            Detail::InterfaceId<IStatus>::Value()
+        };
+        for (const std::size_t id : ids) {
+            if (id >= denseBuckets.size()) { denseBuckets.resize(id + 1); }
+            denseBuckets[id].push_back(nullptr);
+        }
+
+#if !ESPRESSIO_OBSERVABLE_NO_RTTI
+        Report("bucket selection: type_index unordered_map", MeasureNanoseconds(iterations, [&]() {
+            const auto sensor = hashedBuckets.find(std::type_index(typeid(ISensor)));
+            const auto alarm = hashedBuckets.find(std::type_index(typeid(IAlarm)));
+            const auto status = hashedBuckets.find(std::type_index(typeid(IStatus)));
+            DoNotOptimize(sensor->second.size() + alarm->second.size() + status->second.size());
+        }) / 3.0);
+#endif
+
+        Report("bucket selection: dense InterfaceId", MeasureNanoseconds(iterations, [&]() {
+            const std::size_t sensor = Detail::InterfaceId<ISensor>::Value();
+            const std::size_t alarm = Detail::InterfaceId<IAlarm>::Value();
+            const std::size_t status = Detail::InterfaceId<IStatus>::Value();
+            DoNotOptimize(
+                denseBuckets[sensor].size() + denseBuckets[alarm].size() +
+                denseBuckets[status].size());
+        }) / 3.0);
+    }
+
+    template <class BenchmarkObservable>
+    void BenchmarkSensorDispatch(const char* label, std::size_t iterations) {
+        const std::size_t observerCounts[] = {1, 16};
+        for (const std::size_t observerCount : observerCounts) {
+            auto observable = std::make_shared<BenchmarkObservable>();
+            std::vector<std::unique_ptr<SensorObserver> > observers;
+            std::vector<ObserverHandlePtr> handles;
+            for (std::size_t index = 0; index < observerCount; ++index) {
+                observers.emplace_back(new SensorObserver());
+                handles.push_back(
+                    observable->template RegisterObserverAs<ISensor, IAlarm>(
+                        observers.back().get()));
+            }
+
+            char name[64];
+            std::snprintf(name, sizeof(name),
+                "%s notify (%zu observers)", label, observerCount);
+            Report(name, MeasureNanoseconds(iterations, [&]() {
+                observable->NotifyReading(1);
+            }));
+            DoNotOptimize(observers.front()->total);
+        }
+    }
+
+    /// `IReading<Depth>` extends `IReading<Depth - 1>`; Observers implement the
+    /// deepest level and are notified through `IReading<1>`, so resolving the
+    /// interface walks a hierarchy `Depth` levels deep.
+    template <int Depth>
+    struct IReading : IReading<Depth - 1> {};
+
+    template <>
+    struct IReading<1> {
+        virtual ~IReading() = default;
+        virtual void OnReading(int value) = 0;
+    };
+
+    template <int Depth>
+    struct DepthObserver final : ObserverOf<IReading<Depth> > {
+        int total = 0;
+        void OnReading(int value) override { total += value; }
+#if ESPRESSIO_OBSERVABLE_NO_RTTI
+        void* ResolveInterface(std::size_t interfaceId) noexcept override {
+            return ResolveObserverInterface<IReading<Depth>, IReading<1> >(this, interfaceId);
+        }
+#endif
+    };
+
+    /// Registered alongside `DepthObserver`s to make up the misses.
+    struct MissObserver final : ObserverOf<IAlarm> {
+        void OnAlarm() override {}
+    };
+
+    /// Notifies `IReading<1>` through the cached typed dispatch or, where `Base`
+    /// supports it, by casting every Observer in an untyped dispatch.
+    template <class Base>
+    class ReadingObservable final : public Base {
+        public:
+            void NotifyTyped(int value) {
+                this->ExecuteNotification([value](typename Base::NotificationContext& notification) {
+                    notification.template WithObservers<IReading<1> >(
+                        [value](IReading<1>* observer) { observer->OnReading(value); });
+                });
+            }
+
+            void NotifyUntyped(int value) {
+                this->ExecuteNotification([value](typename Base::NotificationContext& notification) {
+                    notification.WithObservers([value](IObserver* observer) {
+                        IReading<1>* reading = ObserverCast<IReading<1> >(observer);
+                        if (reading != nullptr) { reading->OnReading(value); }
+                    });
+                });
+            }
+    };
+
+    template <class Base>
+    struct MatrixRegistration {
+        static constexpr bool Untyped = true;
+
+        template <class Interface, class ObserverType>
+        static ObserverHandlePtr Register(ReadingObservable<Base>& observable, ObserverType* observer) {
+            return observable.RegisterObserver(observer);
+        }
+    };
+
+    template <>
+    struct MatrixRegistration<ObservableWithBuckets> {
+        static constexpr bool Untyped = false;
+
+        template <class Interface, class ObserverType>
+        static ObserverHandlePtr Register(
+            ReadingObservable<ObservableWithBuckets>& observable,
+            ObserverType* observer) {
+            return observable.template RegisterObserverAs<Interface>(observer);
+        }
+    };
+
+    template <class Base, bool Untyped>
+    struct UntypedDispatch {
+        static void Measure(ReadingObservable<Base>&, const char*, std::size_t, DispatchParameters) {}
+    };
+
+    template <class Base>
+    struct UntypedDispatch<Base, true> {
+        static void Measure(
+            ReadingObservable<Base>& observable,
+            const char* label,
+            std::size_t iterations,
+            DispatchParameters parameters) {
+            parameters.dispatch = "untyped";
+            char name[96];
+            std::snprintf(name, sizeof(name),
+                "%s untyped (n=%ld d=%d hit=%.2f)",
+                label, parameters.observers, parameters.depth, parameters.hitRatio);
+            Report(name, MeasureNanoseconds(iterations, [&]() { observable.NotifyUntyped(1); }),
+                parameters);
+        }
+    };
+
+    /// One notification to `observerCount` Observers of which `hitRatio`
+    /// implement the notified interface, `Depth` levels down its hierarchy.
+    /// Iterations scale inversely with the Observer count.
+    template <class Base, int Depth>
+    void MeasureDispatch(
+        const char* label,
+        std::size_t observerCount,
+        double hitRatio,
+        std::size_t observerBudget) {
+        auto observable = std::make_shared<ReadingObservable<Base> >();
+        const std::size_t hits =
+            static_cast<std::size_t>(static_cast<double>(observerCount) * hitRatio + 0.5);
+        std::vector<DepthObserver<Depth> > hitObservers(hits);
+        std::vector<MissObserver> missObservers(observerCount - hits);
+        std::vector<ObserverHandlePtr> handles;
+        handles.reserve(observerCount);
+        // Interleave hits and misses so a miss ratio is not a contiguous tail.
+        std::size_t hit = 0;
+        std::size_t miss = 0;
+        for (std::size_t index = 0; index < observerCount; ++index) {
+            if (miss == missObservers.size() ||
+                (hit < hits && hit * observerCount <= index * hits)) {
+                handles.push_back(MatrixRegistration<Base>::template Register<IReading<1> >(
+                    *observable, &hitObservers[hit++]));
+            } else {
+                handles.push_back(MatrixRegistration<Base>::template Register<IAlarm>(
+                    *observable, &missObservers[miss++]));
+            }
+        }
+
+        const std::size_t iterations =
+            std::max<std::size_t>(observerBudget / std::max<std::size_t>(observerCount, 1), 16);
+        const DispatchParameters parameters{
+            label, "typed", static_cast<long>(observerCount), Depth, hitRatio};
+        char name[96];
+        std::snprintf(name, sizeof(name),
+            "%s typed (n=%zu d=%d hit=%.2f)", label, observerCount, Depth, hitRatio);
+        Report(name, MeasureNanoseconds(iterations, [&]() { observable->NotifyTyped(1); }),
+            parameters);
+        UntypedDispatch<Base, MatrixRegistration<Base>::Untyped>::Measure(
+            *observable, label, iterations, parameters);
+        if (hits > 0) { DoNotOptimize(hitObservers.front().total); }
+    }
+
+    /// Sweeps the Observer count, interface depth and cast hit ratio
+    /// independently for one Observable type.
+    template <class Base>
+    void BenchmarkDispatchMatrix(const char* label, std::size_t observerBudget, bool quick) {
+        const std::size_t observerCounts[] = {0, 1, 10, 100, 1000, 10000, 100000};
+        for (const std::size_t observerCount : observerCounts) {
+            if (quick && observerCount > 1000) { continue; }
+            MeasureDispatch<Base, 1>(label, observerCount, 1.0, observerBudget);
+        }
+        MeasureDispatch<Base, 4>(label, 100, 1.0, observerBudget);
+        MeasureDispatch<Base, 8>(label, 100, 1.0, observerBudget);
+        MeasureDispatch<Base, 1>(label, 100, 0.5, observerBudget);
+        MeasureDispatch<Base, 1>(label, 100, 0.0, observerBudget);
+    }
+
+}
+
+/// Usage: espressio_observable_benchmarks [--quick] [--json <path>]
+/// `--quick` shortens every measurement for smoke runs; `--json` additionally
+/// writes every result to `path` for tracking between releases.
+int main(int argc, char** argv) {
+    bool quick = false;
+    const char* jsonPath = nullptr;
+    for (int argument = 1; argument < argc; ++argument) {
+        if (std::strcmp(argv[argument], "--quick") == 0) {
+            quick = true;
+        } else if (std::strcmp(argv[argument], "--json") == 0 && argument + 1 < argc) {
+            jsonPath = argv[++argument];
+        } else {
+            std::fprintf(stderr, "usage: %s [--quick] [--json <path>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const std::size_t iterations = quick ? 20000 : 2000000;
+    const std::size_t observerBudget = quick ? 200000 : 10000000;
+    BenchmarkDispatchMatrix<Observable>("Observable", observerBudget, quick);
+    BenchmarkDispatchMatrix<ThreadSafeObservable>("ThreadSafeObservable", observerBudget, quick);
+    BenchmarkDispatchMatrix<ObservableWithBuckets>("ObservableWithBuckets", observerBudget, quick);
+    BenchmarkRegistrationScaling();
+    BenchmarkLifetimeControl(iterations);
+    BenchmarkBucketSelection(iterations);
+    BenchmarkSensorDispatch<BenchmarkBucketObservable>("ObservableWithBuckets", iterations);
+    BenchmarkSensorDispatch<BenchmarkStaticObservable>("StaticObservable", iterations);
+    BenchmarkSingleInterfaceDispatch(iterations);
+    BenchmarkKeyedSubscriptions(iterations / 64);
+    BenchmarkRangeSubscriptions(iterations / 64);
+    BenchmarkAsyncNotification(iterations / 4);
+    BenchmarkObservableValueBurst(iterations / 16);
+    BenchmarkNotificationTransaction(iterations / 16);
+    BenchmarkRunToCompletion(iterations / 64);
+    BenchmarkLatencyTracking(iterations / 4);
+    BenchmarkNotificationLifetime(iterations);
+    BenchmarkParallelFanOutScaling();
+    BenchmarkShardedRegistrationScaling();
+    BenchmarkContendedNotification();
+
+    if (jsonPath != nullptr && !WriteJsonReport(jsonPath, quick)) {
+        std::fprintf(stderr, "failed to write %s\n", jsonPath);
+        return 1;
+    }
+    return 0;
+}
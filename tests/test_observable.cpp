@@ -1,18 +1,40 @@
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <stdexcept>
 #include <thread>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "ESPressio_AsyncObservable.hpp"
+#include "ESPressio_BlockAllocator.hpp"
+#include "ESPressio_NotificationTransaction.hpp"
 #include "ESPressio_Observable.hpp"
+#include "ESPressio_ObservableValue.hpp"
 #include "ESPressio_ObservableWithBuckets.hpp"
+#include "ESPressio_ObserverRegistration.hpp"
+#include "ESPressio_ParallelDispatchPool.hpp"
+#include "ESPressio_ShardedThreadSafeObservable.hpp"
+#include "ESPressio_StaticObservable.hpp"
 #include "ESPressio_ThreadSafeObservable.hpp"
+#include "ESPressio_ThreadSafeObservableWithBuckets.hpp"
+#include "ESPressio_ThreadSafeSnapshotObservable.hpp"
+#include "ESPressio_TypedObservable.hpp"
 
 using namespace ESPressio::Observable;
 
+static_assert(sizeof(ObserverRegistration) <= 3 * sizeof(void*),
+    "ObserverRegistration must stay small enough to embed in an Observer");
+static_assert(std::is_nothrow_move_constructible<ObserverRegistration>::value,
+    "ObserverRegistration must be nothrow movable");
+
 static_assert(std::is_base_of<std::runtime_error, ObservableException>::value,
     "ObservableException must be a runtime_error");
 static_assert(std::is_base_of<ObservableException, ObserverRegistrationException>::value,
@@ -36,16 +58,42 @@ static_assert(std::is_base_of<ObserverHandleException,
     "Invalid handle construction must have a typed exception");
 static_assert(std::is_base_of<ObservableException, ObservableOwnershipException>::value,
     "Ownership failures must be Observable exceptions");
+static_assert(std::is_base_of<ObservableException,
+    AsyncNotificationQueueFullException>::value,
+    "A full asynchronous queue must be an Observable exception");
+static_assert(std::is_base_of<ObservableException, ParallelNotificationException>::value,
+    "Aggregated parallel callback failures must be Observable exceptions");
+static_assert(std::is_base_of<ThreadSafeObservable, AsyncObservable>::value,
+    "AsyncObservable must support ThreadSafeObservable registration");
 static_assert(std::is_base_of<IObservable, IUntypedObservable>::value,
     "IUntypedObservable must extend IObservable");
 static_assert(std::is_base_of<IUntypedObservable, Observable>::value,
     "Observable must support untyped registration");
 static_assert(std::is_base_of<IUntypedObservable, ThreadSafeObservable>::value,
     "ThreadSafeObservable must support untyped registration");
+static_assert(std::is_base_of<IUntypedObservable, ThreadSafeSnapshotObservable>::value,
+    "ThreadSafeSnapshotObservable must support untyped registration");
+static_assert(std::is_base_of<IUntypedObservable, ShardedThreadSafeObservable>::value,
+    "ShardedThreadSafeObservable must support untyped registration");
 static_assert(std::is_base_of<IObservable, ObservableWithBuckets>::value,
     "ObservableWithBuckets must satisfy IObservable");
 static_assert(!std::is_base_of<IUntypedObservable, ObservableWithBuckets>::value,
     "ObservableWithBuckets must not advertise untyped registration");
+static_assert(std::is_base_of<IObservable, StaticObservable<IObserver> >::value,
+    "StaticObservable must satisfy IObservable");
+static_assert(!std::is_base_of<IUntypedObservable, StaticObservable<IObserver> >::value,
+    "StaticObservable must not advertise untyped registration");
+static_assert(std::is_base_of<IObservable, ThreadSafeObservableWithBuckets>::value,
+    "ThreadSafeObservableWithBuckets must satisfy IObservable");
+static_assert(!std::is_base_of<IUntypedObservable, ThreadSafeObservableWithBuckets>::value,
+    "ThreadSafeObservableWithBuckets must not advertise untyped registration");
+static_assert(ThreadSafeObservable::IsThreadSafe && AsyncObservable::IsThreadSafe &&
+    ThreadSafeObservableWithBuckets::IsThreadSafe && ThreadSafeSnapshotObservable::IsThreadSafe &&
+    ShardedThreadSafeObservable::IsThreadSafe,
+    "Thread Safe Observables must declare themselves Thread Safe");
+static_assert(!Observable::IsThreadSafe && !ObservableWithBuckets::IsThreadSafe &&
+    !StaticObservable<IObserver>::IsThreadSafe && !TypedObservable<IObserver>::IsThreadSafe,
+    "Single-threaded Observables must not declare themselves Thread Safe");
 static_assert(!std::is_copy_constructible<IObservable>::value,
     "IObservable must not be copyable");
 static_assert(!std::is_move_constructible<IObservable>::value,
@@ -76,13 +124,13 @@ namespace {
         virtual void OnC() = 0;
     };
 
-    struct ObserverA final : IObserver, InterfaceA {
+    struct ObserverA final : ObserverOf<InterfaceA> {
         int calls = 0;
         int value = 0;
         void OnA(int newValue) override { ++calls; value = newValue; }
     };
 
-    struct ObserverAB final : IObserver, InterfaceA, InterfaceB {
+    struct ObserverAB final : ObserverOf<InterfaceA, InterfaceB> {
         int callsA = 0;
         int callsB = 0;
         int valueA = 0;
@@ -91,9 +139,23 @@ namespace {
         void OnB(int value) override { ++callsB; valueB = value; }
     };
 
-    struct PlainObserver final : IObserver {};
+    struct PlainObserver final : ObserverOf<> {};
+
+    struct InterfaceDerivedA : InterfaceA {};
+
+    /// Implements `InterfaceA` only through `InterfaceDerivedA`, so resolves it
+    /// explicitly without RTTI.
+    struct DerivedObserverA final : ObserverOf<InterfaceDerivedA> {
+        int calls = 0;
+        void OnA(int) override { ++calls; }
+#if ESPRESSIO_OBSERVABLE_NO_RTTI
+        void* ResolveInterface(std::size_t interfaceId) noexcept override {
+            return ResolveObserverInterface<InterfaceDerivedA, InterfaceA>(this, interfaceId);
+        }
+#endif
+    };
 
-    struct SelfRemovingObserver final : IObserver, InterfaceA {
+    struct SelfRemovingObserver final : ObserverOf<InterfaceA> {
         ObserverHandlePtr* handle = nullptr;
         int calls = 0;
         void OnA(int) override {
@@ -104,6 +166,17 @@ namespace {
 
     class TestObservable final : public Observable {
         public:
+            void RaiseA(int value) {
+                ExecuteDeferrableNotification<InterfaceA>(
+                    [value](InterfaceA* observer) { observer->OnA(value); });
+            }
+
+            void NotifyWithA(const std::function<void(InterfaceA*)>& callback) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(callback);
+                });
+            }
+
             void NotifyAll(const std::function<void(IObserver*)>& callback) {
                 ExecuteNotification([&](NotificationContext& notification) {
                     notification.WithObservers(callback);
@@ -151,6 +224,150 @@ namespace {
 
     class TestThreadSafeObservable final : public ThreadSafeObservable {
         public:
+            explicit TestThreadSafeObservable(ThreadSafeLocking locking = ThreadSafeLocking::Recursive)
+                : ThreadSafeObservable(locking) {}
+
+            void RaiseA(int value) {
+                ExecuteDeferrableNotification<InterfaceA>(
+                    [value](InterfaceA* observer) { observer->OnA(value); });
+            }
+
+            void NotifyWithA(const std::function<void(InterfaceA*)>& callback) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(callback);
+                });
+            }
+
+            void NotifyAll(const std::function<void(IObserver*)>& callback) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers(callback);
+                });
+            }
+
+            void NotifyA(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(
+                        [value](InterfaceA* observer) { observer->OnA(value); });
+                });
+            }
+
+            void NotifyKeyA(SubscriptionKey key, int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(
+                        key, [value](InterfaceA* observer) { observer->OnA(value); });
+                });
+            }
+
+            void NotifyMatchingA(double value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObserversMatching<InterfaceA>(
+                        value, [value](InterfaceA* observer) { observer->OnA(static_cast<int>(value)); });
+                });
+            }
+    };
+
+    struct CallbackObserverA final : ObserverOf<InterfaceA> {
+        std::function<void(int)> onA;
+        void OnA(int value) override { onA(value); }
+    };
+
+    class TestAsyncObservable final : public AsyncObservable {
+        public:
+            std::atomic<int> exceptions{0};
+
+            explicit TestAsyncObservable(
+                std::size_t queueCapacity = 64,
+                AsyncDispatchMode mode = AsyncDispatchMode::DispatcherThread)
+                : AsyncObservable(queueCapacity, mode) {}
+
+            bool TryNotifyA(int value) {
+                return TryExecuteNotification([value](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(
+                        [value](InterfaceA* observer) { observer->OnA(value); });
+                });
+            }
+
+            void NotifyA(int value) {
+                ExecuteNotification([value](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(
+                        [value](InterfaceA* observer) { observer->OnA(value); });
+                });
+            }
+
+            void NotifyDeferrableA(int value) {
+                ExecuteDeferrableNotification<InterfaceA>(
+                    [value](InterfaceA* observer) { observer->OnA(value); });
+            }
+
+            void NotifyHolding(std::shared_ptr<int> token) {
+                ExecuteNotification([token](NotificationContext& notification) {
+                    notification.WithObservers([](IObserver*) {});
+                });
+            }
+
+            void NotifyThrow() {
+                ExecuteNotification([](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>([](InterfaceA*) {
+                        throw std::runtime_error("async callback failure");
+                    });
+                });
+            }
+
+        protected:
+            void OnAsyncNotificationException(std::exception_ptr) noexcept override {
+                exceptions.fetch_add(1);
+            }
+    };
+
+    template <class Predicate>
+    bool WaitUntil(Predicate&& predicate) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!predicate()) {
+            if (std::chrono::steady_clock::now() > deadline) { return false; }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    class TestParallelObservable final : public ThreadSafeObservable {
+        public:
+            void NotifyA(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(
+                        [value](InterfaceA* observer) { observer->OnA(value); });
+                });
+            }
+
+            void NotifyThrow() {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers([](IObserver*) {
+                        throw std::runtime_error("parallel callback failure");
+                    });
+                });
+            }
+    };
+
+    class TestSnapshotObservable final : public ThreadSafeSnapshotObservable {
+        public:
+            void NotifyAll(const std::function<void(IObserver*)>& callback) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers(callback);
+                });
+            }
+
+            void NotifyA(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(
+                        [value](InterfaceA* observer) { observer->OnA(value); });
+                });
+            }
+    };
+
+    class TestShardedObservable final : public ShardedThreadSafeObservable {
+        public:
+            explicit TestShardedObservable(std::size_t shardCount)
+                : ShardedThreadSafeObservable(shardCount) {}
+
             void NotifyAll(const std::function<void(IObserver*)>& callback) {
                 ExecuteNotification([&](NotificationContext& notification) {
                     notification.WithObservers(callback);
@@ -167,6 +384,11 @@ namespace {
 
     class TestBucketObservable final : public ObservableWithBuckets {
         public:
+            void RaiseA(int value) {
+                ExecuteDeferrableNotification<InterfaceA>(
+                    [value](InterfaceA* observer) { observer->OnA(value); });
+            }
+
             void NotifyA(int value) {
                 ExecuteNotification([&](NotificationContext& notification) {
                     notification.WithObservers<InterfaceA>(
@@ -382,6 +604,412 @@ namespace {
         plainHandle.reset();
     }
 
+    void TestObserverCast() {
+        ObserverAB observerAB;
+        PlainObserver plain;
+        IObserver* observer = &observerAB;
+        assert(ObserverCast<InterfaceA>(observer) == static_cast<InterfaceA*>(&observerAB));
+        assert(ObserverCast<InterfaceB>(observer) == static_cast<InterfaceB*>(&observerAB));
+        assert(ObserverCast<InterfaceC>(observer) == nullptr);
+        assert(ObserverCast<IObserver>(observer) == observer);
+        assert(ObserverCast<InterfaceA>(&plain) == nullptr);
+        assert(ObserverCast<InterfaceA>(nullptr) == nullptr);
+
+        auto observable = std::make_shared<TestObservable>();
+        DerivedObserverA derived;
+        assert(ObserverCast<InterfaceA>(&derived) == static_cast<InterfaceA*>(&derived));
+        ObserverHandlePtr handle = observable->RegisterObserver(&derived);
+        observable->NotifyA(5);
+        assert(derived.calls == 1);
+        handle.reset();
+    }
+
+    template <class ObservableType>
+    void TestDispatchCacheIncrementalUpdates() {
+        auto observable = std::make_shared<ObservableType>();
+        ObserverA first;
+        ObserverAB second;
+        PlainObserver plain;
+        ObserverA third;
+        ObserverHandlePtr firstHandle = observable->RegisterObserver(&first);
+        ObserverHandlePtr plainHandle = observable->RegisterObserver(&plain);
+
+        observable->NotifyA(1);
+        assert(first.calls == 1);
+
+        ObserverHandlePtr secondHandle = observable->RegisterObserver(&second);
+        observable->NotifyA(2);
+        assert(first.calls == 2 && second.callsA == 1 && second.valueA == 2);
+
+        firstHandle.reset();
+        observable->NotifyA(3);
+        assert(first.calls == 2 && second.callsA == 2);
+
+        ObserverHandlePtr thirdHandle;
+        int order = 0;
+        int secondOrder = 0;
+        int thirdOrder = 0;
+        firstHandle = observable->RegisterObserver(&first);
+        observable->NotifyAll([&](IObserver* observer) {
+            if (observer == &second) { secondOrder = ++order; }
+            if (observer == &third) { thirdOrder = ++order; }
+            if (observer == &plain) {
+                plainHandle.reset();
+                thirdHandle = observable->RegisterObserver(&third);
+            }
+        });
+        assert(secondOrder == 1 && thirdOrder == 0);
+        observable->NotifyA(4);
+        assert(first.calls == 3 && second.callsA == 3 && third.calls == 1);
+        assert(third.value == 4);
+
+        secondHandle.reset();
+        observable->NotifyA(5);
+        assert(first.calls == 4 && second.callsA == 3 && third.calls == 2);
+        firstHandle.reset();
+        thirdHandle.reset();
+        observable->NotifyA(6);
+        assert(first.calls == 4 && third.calls == 2);
+    }
+
+    template <class ObservableType>
+    void TestSlotIndexPreservesOrder() {
+        auto observable = std::make_shared<ObservableType>();
+        const std::size_t observerCount = 64;
+        std::unique_ptr<ObserverA[]> observers(new ObserverA[observerCount]);
+        std::unique_ptr<ObserverHandlePtr[]> handles(new ObserverHandlePtr[observerCount]);
+        for (std::size_t index = 0; index < observerCount; ++index) {
+            handles[index] = observable->RegisterObserver(&observers[index]);
+        }
+        observable->NotifyA(1);
+
+        std::size_t removed = 0;
+        observable->NotifyAll([&](IObserver* observer) {
+            if (observer == &observers[0]) {
+                for (std::size_t index = 1; index < observerCount; index += 2) {
+                    handles[index].reset();
+                    ++removed;
+                }
+                assert(!observable->IsObserverRegistered(&observers[1]));
+                assert(observable->IsObserverRegistered(&observers[2]));
+            }
+        });
+        assert(removed == observerCount / 2);
+
+        for (std::size_t index = 0; index < observerCount; index += 4) {
+            handles[index].reset();
+        }
+        for (std::size_t index = 1; index < observerCount; index += 2) {
+            handles[index] = observable->RegisterObserver(&observers[index]);
+        }
+
+        std::vector<IObserver*> expected;
+        for (std::size_t index = 2; index < observerCount; index += 4) {
+            expected.push_back(&observers[index]);
+        }
+        for (std::size_t index = 1; index < observerCount; index += 2) {
+            expected.push_back(&observers[index]);
+        }
+        std::vector<IObserver*> untypedOrder;
+        observable->NotifyAll([&](IObserver* observer) { untypedOrder.push_back(observer); });
+        assert(untypedOrder == expected);
+
+        std::vector<IObserver*> typedOrder;
+        observable->NotifyWithA([&](InterfaceA* observer) {
+            typedOrder.push_back(static_cast<ObserverA*>(observer));
+        });
+        assert(typedOrder == expected);
+
+        for (std::size_t index = 0; index < observerCount; ++index) {
+            assert(observable->IsObserverRegistered(&observers[index]) == (handles[index] != nullptr));
+        }
+    }
+
+    template <class ObservableType>
+    void TestBulkRegistration() {
+        auto observable = std::make_shared<ObservableType>();
+        ObserverA first;
+        ObserverAB second;
+        ObserverA third;
+        ObserverA existing;
+        ObserverHandlePtr existingHandle = observable->RegisterObserver(&existing);
+        observable->Reserve(16);
+        observable->NotifyA(1);
+
+        bool nullThrown = false;
+        try { observable->RegisterObservers({&first, nullptr}); }
+        catch (const InvalidObserverRegistrationException&) { nullThrown = true; }
+        assert(nullThrown);
+
+        bool duplicateThrown = false;
+        try { observable->RegisterObservers({&first, &second, &first}); }
+        catch (const DuplicateObserverRegistrationException&) { duplicateThrown = true; }
+        assert(duplicateThrown);
+
+        duplicateThrown = false;
+        try { observable->RegisterObservers({&first, &existing}); }
+        catch (const DuplicateObserverRegistrationException&) { duplicateThrown = true; }
+        assert(duplicateThrown);
+        assert(!observable->IsObserverRegistered(&first));
+        assert(!observable->IsObserverRegistered(&second));
+        assert(observable->IsObserverRegistered(&existing));
+
+        observable->NotifyA(2);
+        assert(existing.calls == 2 && first.calls == 0 && second.callsA == 0);
+
+        std::vector<IObserver*> observers = {&first, &second, &third};
+        ObserverHandleBatch handles = observable->RegisterObservers(observers);
+        assert(handles.size() == 3);
+        for (std::size_t index = 0; index < handles.size(); ++index) {
+            assert(handles[index]->GetObserver() == observers[index]);
+        }
+
+        std::vector<IObserver*> order;
+        observable->NotifyAll([&](IObserver* observer) { order.push_back(observer); });
+        assert(order.size() == 4 && order[0] == &existing && order[1] == &first);
+        assert(order[2] == &second && order[3] == &third);
+        observable->NotifyA(3);
+        assert(first.calls == 1 && second.callsA == 1 && third.calls == 1);
+
+        const std::vector<ObserverA*> removals = {&first, &third, &first};
+        observable->UnregisterObservers(removals);
+        assert(!observable->IsObserverRegistered(&first));
+        assert(!observable->IsObserverRegistered(&third));
+        assert(handles[0]->GetObserver() == nullptr && handles[1]->GetObserver() == &second);
+        observable->NotifyA(4);
+        assert(first.calls == 1 && second.callsA == 2 && third.calls == 1);
+
+        observable->UnregisterObservers({&second, &existing});
+        assert(!observable->IsObserverRegistered(&second));
+        assert(!observable->IsObserverRegistered(&existing));
+        handles.clear();
+        existingHandle.reset();
+
+        ObserverHandlePtr handle = observable->RegisterObserver(&first);
+        observable->NotifyA(5);
+        assert(first.calls == 2 && first.value == 5);
+    }
+
+    void TestBucketBulkRegistration() {
+        auto observable = std::make_shared<TestBucketObservable>();
+        ObserverAB first;
+        ObserverAB second;
+        ObserverA onlyA;
+        observable->Reserve(8);
+
+        bool mismatchThrown = false;
+        try { observable->RegisterObserversAs<InterfaceA, InterfaceB>({&first, &onlyA}); }
+        catch (const ObserverInterfaceMismatchException&) { mismatchThrown = true; }
+        assert(mismatchThrown);
+
+        bool duplicateThrown = false;
+        try { observable->RegisterObserversAs<InterfaceA, InterfaceB>({&first, &second, &first}); }
+        catch (const DuplicateObserverRegistrationException&) { duplicateThrown = true; }
+        assert(duplicateThrown);
+        assert(!observable->IsObserverRegistered(&first));
+        assert(!observable->IsObserverRegistered(&second));
+        observable->NotifyA(1);
+        assert(first.callsA == 0 && second.callsA == 0);
+
+        const std::vector<ObserverAB*> observers = {&first, &second};
+        ObserverHandleBatch handles =
+            observable->RegisterObserversAs<InterfaceA, InterfaceB>(observers);
+        assert(handles.size() == 2 && handles[1]->GetObserver() == &second);
+
+        bool conflictThrown = false;
+        try { observable->RegisterObserversAs<InterfaceA>({&onlyA, &second}); }
+        catch (const ObserverRegistrationConflictException&) { conflictThrown = true; }
+        assert(conflictThrown);
+        assert(!observable->IsObserverRegistered(&onlyA));
+
+        observable->NotifyA(2);
+        observable->NotifyB(3);
+        assert(first.callsA == 1 && first.valueB == 3 && second.callsB == 1);
+
+        observable->UnregisterObservers(observers);
+        assert(!observable->IsObserverRegistered(&first));
+        assert(handles[0]->GetObserver() == nullptr && handles[1]->GetObserver() == nullptr);
+        observable->NotifyA(4);
+        assert(first.callsA == 1 && second.callsA == 1);
+
+        CallbackObserverA remover;
+        ObserverA removed;
+        ObserverA kept;
+        ObserverHandleBatch removalHandles =
+            observable->RegisterObserversAs<InterfaceA>({&remover, &removed, &kept});
+        remover.onA = [&](int) {
+            observable->UnregisterObservers({&removed, &remover, &removed, &onlyA});
+        };
+        observable->NotifyA(5);
+        assert(removed.calls == 0 && kept.calls == 1);
+        assert(!observable->IsObserverRegistered(&remover));
+        assert(removalHandles[1]->GetObserver() == nullptr);
+        observable->NotifyA(6);
+        assert(removed.calls == 0 && kept.calls == 2 && kept.value == 6);
+        assert(observable->RegisterObserversAs<InterfaceA>(std::vector<IObserver*>()).empty());
+    }
+
+    void TestKeyedSubscriptions() {
+        auto observable = std::make_shared<TestThreadSafeObservable>();
+        ObserverA single;
+        ObserverA multiple;
+        ObserverA unkeyed;
+        PlainObserver plain;
+        ObserverHandlePtr singleHandle = observable->RegisterObserver(&single, 1);
+        ObserverHandlePtr multipleHandle = observable->RegisterObserver(&multiple, {1, 2, 2});
+        ObserverHandlePtr unkeyedHandle = observable->RegisterObserver(&unkeyed);
+        ObserverHandlePtr plainHandle = observable->RegisterObserver(&plain, 1);
+
+        observable->NotifyKeyA(1, 10);
+        assert(single.calls == 1 && multiple.calls == 1 && unkeyed.calls == 0);
+        observable->NotifyKeyA(2, 20);
+        assert(single.calls == 1 && multiple.calls == 2 && multiple.value == 20);
+        observable->NotifyKeyA(3, 30);
+        assert(single.calls == 1 && multiple.calls == 2 && unkeyed.calls == 0);
+        observable->NotifyA(40);
+        assert(single.calls == 2 && multiple.calls == 3 && unkeyed.calls == 1);
+
+        // A slot vacated by unregistration is not reached through its old key.
+        singleHandle.reset();
+        singleHandle = observable->RegisterObserver(&single, 2);
+        observable->NotifyKeyA(1, 50);
+        assert(single.calls == 2 && multiple.calls == 4);
+        observable->NotifyKeyA(2, 60);
+        assert(single.calls == 3 && single.value == 60 && multiple.calls == 5);
+
+        // Unregistration during a keyed notification skips the removed Observer.
+        CallbackObserverA removing;
+        ObserverHandlePtr removingHandle = observable->RegisterObserver(&removing, 2);
+        multipleHandle.reset();
+        multipleHandle = observable->RegisterObserver(&multiple, 2);
+        removing.onA = [&multipleHandle](int) { multipleHandle.reset(); };
+        observable->NotifyKeyA(2, 70);
+        assert(multiple.calls == 5 && single.calls == 4);
+        removingHandle.reset();
+        singleHandle.reset();
+        unkeyedHandle.reset();
+        plainHandle.reset();
+
+        // Compaction renumbers keyed slots and drops keys left empty.
+        std::vector<ObserverA> observers(64);
+        std::vector<ObserverHandlePtr> handles;
+        for (std::size_t index = 0; index < observers.size(); ++index) {
+            handles.push_back(observable->RegisterObserver(
+                &observers[index], static_cast<SubscriptionKey>(index % 4)));
+        }
+        for (std::size_t index = 0; index < observers.size(); ++index) {
+            if (index % 4 == 3 || index % 2 == 1) { handles[index].reset(); }
+        }
+        observable->NotifyKeyA(0, 1);
+        observable->NotifyKeyA(2, 3);
+        observable->NotifyKeyA(3, 4);
+        for (std::size_t index = 0; index < observers.size(); ++index) {
+            const int expected = index % 2 == 1 ? 0 : 1;
+            assert(observers[index].calls == expected);
+            assert(expected == 0 || observers[index].value == static_cast<int>(index % 4) + 1);
+        }
+        ObserverA late;
+        ObserverHandlePtr lateHandle = observable->RegisterObserver(&late, 3);
+        observable->NotifyKeyA(3, 4);
+        assert(late.calls == 1);
+        observable->NotifyKeyA(0, 5);
+        assert(observers[0].calls == 2 && observers[4].calls == 2 && late.calls == 1);
+    }
+
+    void TestRangeSubscriptions() {
+        auto observable = std::make_shared<TestThreadSafeObservable>();
+        ObserverA above;
+        ObserverA between;
+        ObserverA atMost;
+        ObserverA unranged;
+        ObserverHandlePtr aboveHandle =
+            observable->RegisterObserver(&above, SubscriptionRange::Above(80));
+        ObserverHandlePtr betweenHandle =
+            observable->RegisterObserver(&between, SubscriptionRange::Between(2, 3));
+        ObserverHandlePtr atMostHandle =
+            observable->RegisterObserver(&atMost, SubscriptionRange::AtMost(10));
+        ObserverHandlePtr unrangedHandle = observable->RegisterObserver(&unranged);
+
+        observable->NotifyMatchingA(85);
+        assert(above.calls == 1 && between.calls == 0 && atMost.calls == 0);
+        observable->NotifyMatchingA(80);
+        assert(above.calls == 1 && atMost.calls == 0);
+        observable->NotifyMatchingA(3);
+        assert(between.calls == 1 && atMost.calls == 1);
+        observable->NotifyMatchingA(2.5);
+        assert(between.calls == 2 && atMost.calls == 2);
+        observable->NotifyMatchingA(std::numeric_limits<double>::quiet_NaN());
+        assert(above.calls == 1 && between.calls == 2 && atMost.calls == 2);
+        assert(unranged.calls == 0);
+
+        bool invalidThrown = false;
+        try { observable->RegisterObserver(&unranged, SubscriptionRange::Between(3, 2)); }
+        catch (const InvalidSubscriptionRangeException&) { invalidThrown = true; }
+        assert(invalidThrown);
+        invalidThrown = false;
+        try {
+            observable->RegisterObserver(
+                &unranged, SubscriptionRange::AtLeast(std::numeric_limits<double>::quiet_NaN()));
+        } catch (const InvalidSubscriptionRangeException&) { invalidThrown = true; }
+        assert(invalidThrown);
+
+        // An Observer registered by a callback is matched by a nested
+        // notification, which rebuilds the index while the outer one runs.
+        CallbackObserverA registering;
+        ObserverA late;
+        ObserverHandlePtr lateHandle;
+        ObserverHandlePtr registeringHandle =
+            observable->RegisterObserver(&registering, SubscriptionRange::AtLeast(1000));
+        registering.onA = [&](int) {
+            if (lateHandle) { return; }
+            lateHandle = observable->RegisterObserver(&late, SubscriptionRange::AtLeast(1000));
+            observable->NotifyMatchingA(2000);
+        };
+        observable->NotifyMatchingA(1000);
+        assert(late.calls == 1 && late.value == 2000 && above.calls == 3);
+        registeringHandle.reset();
+        lateHandle.reset();
+        aboveHandle.reset();
+        betweenHandle.reset();
+        atMostHandle.reset();
+        unrangedHandle.reset();
+
+        // Matches agree with testing every range, in registration order,
+        // including after unregistration has compacted the slots.
+        std::vector<CallbackObserverA> observers(200);
+        std::vector<SubscriptionRange> ranges;
+        std::vector<ObserverHandlePtr> handles;
+        std::vector<std::size_t> order;
+        std::uint32_t seed = 12345;
+        const auto next = [&seed]() {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<double>(seed >> 24);
+        };
+        for (std::size_t index = 0; index < observers.size(); ++index) {
+            const double first = next();
+            const double second = next();
+            ranges.push_back(index % 10 == 0
+                ? SubscriptionRange::AtLeast(first)
+                : SubscriptionRange::Between(std::min(first, second), std::max(first, second)));
+            observers[index].onA = [&order, index](int) { order.push_back(index); };
+            handles.push_back(observable->RegisterObserver(&observers[index], ranges.back()));
+        }
+        for (int round = 0; round < 2; ++round) {
+            for (double value = -1; value <= 256; value += 0.5) {
+                std::vector<std::size_t> expected;
+                for (std::size_t index = 0; index < observers.size(); ++index) {
+                    if (handles[index] && ranges[index].Contains(value)) { expected.push_back(index); }
+                }
+                order.clear();
+                observable->NotifyMatchingA(value);
+                assert(order == expected);
+            }
+            for (std::size_t index = 0; index < observers.size(); index += 2) {
+                handles[index].reset();
+            }
+        }
+    }
+
     void TestThreadSafeConcurrentUnregister() {
         auto observable = std::make_shared<TestThreadSafeObservable>();
         PlainObserver observer;
@@ -412,36 +1040,171 @@ namespace {
         handle.reset();
     }
 
-    void TestThreadSafeStress() {
-        auto observable = std::make_shared<TestThreadSafeObservable>();
-        ObserverA observer;
+    void TestReaderWriterConcurrentDispatch() {
+        auto observable = std::make_shared<TestThreadSafeObservable>(ThreadSafeLocking::ReaderWriter);
+        PlainObserver observer;
+        PlainObserver late;
         ObserverHandlePtr handle = observable->RegisterObserver(&observer);
-        std::atomic<bool> stop{false};
+        std::atomic<int> callbacksEntered{0};
+        std::atomic<bool> releaseCallbacks{false};
 
-        std::thread notifier([&]() {
-            while (!stop.load()) { observable->NotifyA(7); }
-        });
-        std::thread reader([&]() {
-            for (int index = 0; index < 1000; ++index) {
-                (void)observable->IsObserverRegistered(&observer);
-            }
-            stop.store(true);
+        auto notify = [&]() {
+            observable->NotifyAll([&](IObserver*) {
+                callbacksEntered.fetch_add(1);
+                while (!releaseCallbacks.load()) { std::this_thread::yield(); }
+            });
+        };
+        std::thread firstNotifier(notify);
+        std::thread secondNotifier(notify);
+        // Both callbacks run at once: neither notification waits for the other.
+        while (callbacksEntered.load() != 2) { std::this_thread::yield(); }
+        assert(observable->IsObserverRegistered(&observer));
+
+        ObserverHandlePtr lateHandle;
+        std::atomic<bool> registerFinished{false};
+        std::thread registerer([&]() {
+            lateHandle = observable->RegisterObserver(&late);
+            registerFinished.store(true);
         });
-        reader.join();
-        notifier.join();
-        handle->Unregister();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        assert(!registerFinished.load());
+        releaseCallbacks.store(true);
+        firstNotifier.join();
+        secondNotifier.join();
+        registerer.join();
+        assert(observable->IsObserverRegistered(&late));
+
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> notifiers;
+        std::atomic<int> calls{0};
+        for (int index = 0; index < 3; ++index) {
+            notifiers.emplace_back([&]() {
+                while (!stop.load()) {
+                    observable->NotifyAll([&](IObserver*) { calls.fetch_add(1); });
+                }
+            });
+        }
+        for (int index = 0; index < 200; ++index) {
+            lateHandle.reset();
+            lateHandle = observable->RegisterObserver(&late);
+        }
+        stop.store(true);
+        for (std::thread& notifier : notifiers) { notifier.join(); }
         handle.reset();
+        lateHandle.reset();
+        assert(!observable->IsObserverRegistered(&observer));
+        assert(!observable->IsObserverRegistered(&late));
     }
 
-    void TestConcurrentHandleAndObservableDestruction() {
-        for (int iteration = 0; iteration < 250; ++iteration) {
-            PlainObserver observer;
-            auto observable = std::make_shared<TestThreadSafeObservable>();
-            ObserverHandlePtr handle = observable->RegisterObserver(&observer);
-            std::atomic<bool> start{false};
-            std::thread destroyHandle([&start, handle = std::move(handle)]() mutable {
-                while (!start.load()) { std::this_thread::yield(); }
-                handle.reset();
+    void TestReaderWriterReentrancy() {
+        auto observable = std::make_shared<TestThreadSafeObservable>(ThreadSafeLocking::ReaderWriter);
+        PlainObserver first;
+        PlainObserver second;
+        PlainObserver third;
+        ObserverHandlePtr firstHandle = observable->RegisterObserver(&first);
+        ObserverHandlePtr secondHandle = observable->RegisterObserver(&second);
+        ObserverHandlePtr thirdHandle = observable->RegisterObserver(&third);
+        int calls = 0;
+        int nestedCalls = 0;
+        bool reentrantThrown = false;
+
+        observable->NotifyAll([&](IObserver* observer) {
+            ++calls;
+            if (observer != &first) { return; }
+            secondHandle.reset();
+            observable->UnregisterObserver(&second);
+            observable->UnregisterObservers({&first, &third});
+            assert(!observable->IsObserverRegistered(&second));
+            assert(!observable->IsObserverRegistered(&third));
+            observable->NotifyAll([&](IObserver*) { ++nestedCalls; });
+            try { observable->RegisterObserver(&second); }
+            catch (const ReentrantRegistrationException&) { reentrantThrown = true; }
+        });
+        assert(calls == 1 && nestedCalls == 0 && reentrantThrown);
+        assert(!observable->IsObserverRegistered(&first));
+        firstHandle.reset();
+        thirdHandle.reset();
+
+        // Registering again applies the deferred unregistrations first.
+        secondHandle = observable->RegisterObserver(&second);
+        SelfRemovingObserver selfRemoving;
+        ObserverHandlePtr selfRemovingHandle = observable->RegisterObserver(&selfRemoving);
+        selfRemoving.handle = &selfRemovingHandle;
+        CallbackObserverA byValue;
+        ObserverRegistration registration = observable->RegisterObserverByValue(&byValue);
+        int byValueCalls = 0;
+        byValue.onA = [&registration, &byValueCalls](int) {
+            ++byValueCalls;
+            registration.Unregister();
+        };
+        observable->NotifyA(1);
+        observable->NotifyA(2);
+        assert(selfRemoving.calls == 1 && byValueCalls == 1);
+        assert(!observable->IsObserverRegistered(&selfRemoving));
+        assert(!observable->IsObserverRegistered(&byValue));
+
+        // Latency tracking and parallel fan-out notify with exclusive access,
+        // from which callbacks may register Observers again.
+        ObserverA timed;
+        ObserverHandlePtr timedHandle = observable->RegisterObserver(&timed);
+        observable->EnableLatencyTracking();
+        ObserverHandlePtr thirdAgain;
+        observable->NotifyAll([&](IObserver* observer) {
+            if (observer == &second) { thirdAgain = observable->RegisterObserver(&third); }
+        });
+        assert(observable->IsObserverRegistered(&third));
+        observable->NotifyA(3);
+        assert(timed.calls == 1);
+        assert(timedHandle->GetLatencyHistogram().GetSampleCount() == 2);
+        observable->DisableLatencyTracking();
+
+        observable->SetParallelDispatch(std::make_shared<ParallelDispatchPool>(2), 4);
+        std::vector<SelfRemovingObserver> removing(50);
+        std::vector<ObserverHandlePtr> removingHandles(removing.size());
+        for (std::size_t index = 0; index < removing.size(); ++index) {
+            removingHandles[index] = observable->RegisterObserver(&removing[index]);
+            removing[index].handle = &removingHandles[index];
+        }
+        observable->NotifyA(4);
+        observable->NotifyA(5);
+        for (SelfRemovingObserver& observer : removing) {
+            assert(observer.calls == 1);
+            assert(!observable->IsObserverRegistered(&observer));
+        }
+        assert(timed.calls == 3);
+        observable->SetParallelDispatch(nullptr);
+    }
+
+    void TestThreadSafeStress() {
+        auto observable = std::make_shared<TestThreadSafeObservable>();
+        ObserverA observer;
+        ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+        std::atomic<bool> stop{false};
+
+        std::thread notifier([&]() {
+            while (!stop.load()) { observable->NotifyA(7); }
+        });
+        std::thread reader([&]() {
+            for (int index = 0; index < 1000; ++index) {
+                (void)observable->IsObserverRegistered(&observer);
+            }
+            stop.store(true);
+        });
+        reader.join();
+        notifier.join();
+        handle->Unregister();
+        handle.reset();
+    }
+
+    void TestConcurrentHandleAndObservableDestruction() {
+        for (int iteration = 0; iteration < 250; ++iteration) {
+            PlainObserver observer;
+            auto observable = std::make_shared<TestThreadSafeObservable>();
+            ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+            std::atomic<bool> start{false};
+            std::thread destroyHandle([&start, handle = std::move(handle)]() mutable {
+                while (!start.load()) { std::this_thread::yield(); }
+                handle.reset();
             });
             std::thread destroyObservable([&]() {
                 while (!start.load()) { std::this_thread::yield(); }
@@ -453,6 +1216,329 @@ namespace {
         }
     }
 
+    void TestLifetimeControlWaitsForOperations() {
+        auto observable = std::make_shared<TestObservable>();
+        Detail::ObservableLifetimeControl control(observable.get());
+        assert(control.Peek() == observable.get());
+        assert(control.Acquire() == observable.get());
+        assert(control.Acquire() == observable.get());
+        control.Release();
+
+        std::atomic<bool> invalidated{false};
+        std::thread destroyer([&control, &invalidated]() {
+            control.InvalidateAndWait();
+            invalidated.store(true);
+        });
+        while (control.Peek() != nullptr) { std::this_thread::yield(); }
+        assert(control.Acquire() == nullptr);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        assert(!invalidated.load());
+        control.Release();
+        destroyer.join();
+        assert(invalidated.load() && control.Acquire() == nullptr);
+        control.InvalidateAndWait();
+    }
+
+    void TestSnapshotReentrancyAndExceptions() {
+        auto observable = std::make_shared<TestSnapshotObservable>();
+        PlainObserver first;
+        PlainObserver second;
+        PlainObserver third;
+        ObserverA observerA;
+        ObserverHandlePtr firstHandle = observable->RegisterObserver(&first);
+        ObserverHandlePtr secondHandle = observable->RegisterObserver(&second);
+        ObserverHandlePtr thirdHandle;
+        int calls = 0;
+
+        bool nullThrown = false;
+        try { observable->RegisterObserver(nullptr); }
+        catch (const InvalidObserverRegistrationException&) { nullThrown = true; }
+        assert(nullThrown);
+        bool duplicateThrown = false;
+        try { observable->RegisterObserver(&first); }
+        catch (const DuplicateObserverRegistrationException&) { duplicateThrown = true; }
+        assert(duplicateThrown);
+        assert(firstHandle->GetObservable() == observable.get());
+
+        observable->NotifyAll([&](IObserver* observer) {
+            ++calls;
+            if (observer == &first) {
+                secondHandle.reset();
+                thirdHandle = observable->RegisterObserver(&third);
+            }
+        });
+        assert(calls == 1);
+        assert(!observable->IsObserverRegistered(&second));
+        assert(observable->IsObserverRegistered(&third));
+
+        calls = 0;
+        observable->NotifyAll([&](IObserver*) { ++calls; });
+        assert(calls == 2);
+
+        bool callbackThrown = false;
+        try {
+            observable->NotifyAll([](IObserver*) {
+                throw std::logic_error("expected");
+            });
+        } catch (const std::logic_error&) { callbackThrown = true; }
+        assert(callbackThrown);
+        assert(observable->IsObserverRegistered(&first));
+
+        ObserverHandlePtr handleA = observable->RegisterObserver(&observerA);
+        observable->NotifyA(19);
+        assert(observerA.calls == 1 && observerA.value == 19);
+
+        firstHandle.reset();
+        thirdHandle.reset();
+        observable.reset();
+        assert(handleA->GetObservable() == nullptr);
+        assert(handleA->GetObserver() == nullptr);
+        handleA.reset();
+    }
+
+    void TestSnapshotConcurrentDispatch() {
+        auto observable = std::make_shared<TestSnapshotObservable>();
+        PlainObserver observer;
+        PlainObserver late;
+        ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+        std::atomic<int> callbacksEntered{0};
+        std::atomic<bool> releaseCallbacks{false};
+
+        auto notify = [&]() {
+            observable->NotifyAll([&](IObserver*) {
+                callbacksEntered.fetch_add(1);
+                while (!releaseCallbacks.load()) { std::this_thread::yield(); }
+            });
+        };
+        std::thread firstNotifier(notify);
+        std::thread secondNotifier(notify);
+        while (callbacksEntered.load() != 2) { std::this_thread::yield(); }
+
+        ObserverHandlePtr lateHandle = observable->RegisterObserver(&late);
+        assert(observable->IsObserverRegistered(&late));
+
+        std::atomic<bool> unregisterFinished{false};
+        std::thread unregisterer([&]() {
+            handle->Unregister();
+            unregisterFinished.store(true);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        assert(!unregisterFinished.load());
+        releaseCallbacks.store(true);
+        firstNotifier.join();
+        secondNotifier.join();
+        unregisterer.join();
+        assert(!observable->IsObserverRegistered(&observer));
+        handle.reset();
+        lateHandle.reset();
+        assert(!observable->IsObserverRegistered(&late));
+    }
+
+    void TestSnapshotStress() {
+        auto observable = std::make_shared<TestSnapshotObservable>();
+        ObserverA stable;
+        ObserverHandlePtr stableHandle = observable->RegisterObserver(&stable);
+        std::atomic<bool> stop{false};
+
+        std::atomic<bool> notified{false};
+
+        std::thread notifier([&]() {
+            while (!stop.load()) {
+                observable->NotifyA(3);
+                notified.store(true);
+            }
+        });
+        while (!notified.load()) { std::this_thread::yield(); }
+        std::thread churn([&]() {
+            for (int index = 0; index < 500; ++index) {
+                ObserverA transient;
+                ObserverHandlePtr handle = observable->RegisterObserver(&transient);
+                assert(observable->IsObserverRegistered(&transient));
+                handle.reset();
+            }
+            stop.store(true);
+        });
+        churn.join();
+        notifier.join();
+        assert(stable.calls > 0);
+        stableHandle.reset();
+    }
+
+    void TestShardedRegistrationAndDispatch() {
+        assert(TestShardedObservable(0).GetShardCount() == 1);
+        auto observable = std::make_shared<TestShardedObservable>(4);
+        assert(observable->GetShardCount() == 4);
+
+        bool nullThrown = false;
+        try { observable->RegisterObserver(nullptr); }
+        catch (const InvalidObserverRegistrationException&) { nullThrown = true; }
+        assert(nullThrown);
+
+        std::vector<ObserverA> observers(64);
+        std::vector<ObserverHandlePtr> handles;
+        for (ObserverA& observer : observers) {
+            handles.push_back(observable->RegisterObserver(&observer));
+        }
+        bool duplicateThrown = false;
+        try { observable->RegisterObserver(&observers[5]); }
+        catch (const DuplicateObserverRegistrationException&) { duplicateThrown = true; }
+        assert(duplicateThrown);
+        assert(handles[5]->GetObservable() == observable.get());
+
+        observable->NotifyA(7);
+        for (const ObserverA& observer : observers) {
+            assert(observer.calls == 1 && observer.value == 7);
+        }
+
+        // Registration and unregistration from a callback: Observers registered
+        // during a notification wait for the next one, whichever shard they
+        // land in, and unregistered Observers are skipped.
+        std::vector<ObserverA> late(16);
+        std::vector<ObserverHandlePtr> lateHandles;
+        PlainObserver plain;
+        ObserverHandlePtr plainHandle = observable->RegisterObserver(&plain);
+        int calls = 0;
+        bool lateNotified = false;
+        observable->NotifyAll([&](IObserver* observer) {
+            for (ObserverA& lateObserver : late) {
+                if (observer == &lateObserver) { lateNotified = true; }
+            }
+            if (observer != &plain) { return; }
+            for (std::size_t index = 0; index < handles.size(); index += 2) {
+                handles[index].reset();
+            }
+            for (ObserverA& observer : late) {
+                lateHandles.push_back(observable->RegisterObserver(&observer));
+            }
+            observable->NotifyA(8);
+        });
+        for (const ObserverA& observer : late) {
+            assert(observer.calls == 1 && observer.value == 8);
+        }
+        assert(!lateNotified);
+        for (std::size_t index = 0; index < observers.size(); ++index) {
+            assert(observable->IsObserverRegistered(&observers[index]) == (index % 2 == 1));
+            assert(observers[index].calls == (index % 2 == 1 ? 2 : 1));
+        }
+
+        calls = 0;
+        observable->NotifyAll([&](IObserver*) { ++calls; });
+        assert(calls == 32 + 16 + 1);
+
+        bool callbackThrown = false;
+        try {
+            observable->NotifyAll([](IObserver*) { throw std::logic_error("expected"); });
+        } catch (const std::logic_error&) { callbackThrown = true; }
+        assert(callbackThrown);
+        observable->NotifyA(9);
+        assert(observers[1].calls == 3 && late[0].calls == 2);
+
+        // Unregistering the remainder compacts every shard.
+        for (ObserverHandlePtr& handle : handles) { handle.reset(); }
+        lateHandles.clear();
+        observable->NotifyA(10);
+        assert(observers[1].calls == 3 && late[0].calls == 2);
+        assert(observable->IsObserverRegistered(&plain));
+
+        observable.reset();
+        assert(plainHandle->GetObservable() == nullptr);
+        assert(plainHandle->GetObserver() == nullptr);
+    }
+
+    void TestShardedConcurrentRegistration() {
+        auto observable = std::make_shared<TestShardedObservable>(4);
+        CallbackObserverA blocking;
+        std::atomic<bool> entered{false};
+        std::atomic<bool> release{false};
+        blocking.onA = [&](int) {
+            entered.store(true);
+            while (!release.load()) { std::this_thread::yield(); }
+        };
+        ObserverHandlePtr blockingHandle = observable->RegisterObserver(&blocking);
+        std::thread notifier([&]() { observable->NotifyA(1); });
+        while (!entered.load()) { std::this_thread::yield(); }
+
+        // At most the blocked shard waits for the callback; the others accept
+        // registrations meanwhile.
+        std::vector<ObserverA> candidates(16);
+        std::vector<ObserverHandlePtr> candidateHandles(candidates.size());
+        std::atomic<std::size_t> registered{0};
+        std::vector<std::thread> registrants;
+        for (std::size_t index = 0; index < candidates.size(); ++index) {
+            registrants.emplace_back([&, index]() {
+                candidateHandles[index] = observable->RegisterObserver(&candidates[index]);
+                registered.fetch_add(1);
+            });
+        }
+        while (registered.load() == 0) { std::this_thread::yield(); }
+        release.store(true);
+        notifier.join();
+        for (std::thread& registrant : registrants) { registrant.join(); }
+        assert(registered.load() == candidates.size());
+
+        ObserverA stable;
+        ObserverHandlePtr stableHandle = observable->RegisterObserver(&stable);
+        std::atomic<bool> stop{false};
+        std::thread stableNotifier([&]() {
+            while (!stop.load()) { observable->NotifyA(3); }
+        });
+        std::vector<std::thread> churn;
+        for (int thread = 0; thread < 4; ++thread) {
+            churn.emplace_back([&]() {
+                std::vector<ObserverA> transient(8);
+                for (int round = 0; round < 200; ++round) {
+                    std::vector<ObserverHandlePtr> transientHandles;
+                    for (ObserverA& observer : transient) {
+                        transientHandles.push_back(observable->RegisterObserver(&observer));
+                        assert(observable->IsObserverRegistered(&observer));
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : churn) { thread.join(); }
+        stop.store(true);
+        stableNotifier.join();
+        observable->NotifyA(4);
+        assert(stable.calls > 0 && stable.value == 4);
+        for (const ObserverA& candidate : candidates) { assert(candidate.value == 4); }
+    }
+
+    class TestThreadSafeBucketObservable final : public ThreadSafeObservableWithBuckets {
+        public:
+            void NotifyA(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(
+                        [value](InterfaceA* observer) { observer->OnA(value); });
+                });
+            }
+
+            void NotifyB(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceB>(
+                        [value](InterfaceB* observer) { observer->OnB(value); });
+                });
+            }
+
+            void NotifyC() {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceC>(
+                        [](InterfaceC* observer) { observer->OnC(); });
+                });
+            }
+
+            void NotifyWithA(const std::function<void(InterfaceA*)>& callback) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(callback);
+                });
+            }
+
+            void NotifyWithB(const std::function<void(InterfaceB*)>& callback) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceB>(callback);
+                });
+            }
+    };
+
     void TestBucketRegistrationAndDispatch() {
         auto observable = std::make_shared<TestBucketObservable>();
         ObserverAB observer;
@@ -521,34 +1607,1126 @@ namespace {
         assert(ownershipThrown);
     }
 
-    void TestMutationDuringNotification() {
-        {
-            auto observable = std::make_shared<TestObservable>();
-            SelfRemovingObserver observer;
-            ObserverHandlePtr handle = observable->RegisterObserver(&observer);
-            observer.handle = &handle;
-            observable->NotifyA(1);
-            observable->NotifyA(2);
-            assert(observer.calls == 1);
-            assert(!observable->IsObserverRegistered(&observer));
-        }
-
-        {
-            auto observable = std::make_shared<TestBucketObservable>();
-            SelfRemovingObserver observer;
-            ObserverHandlePtr handle =
-                observable->RegisterObserverAs<InterfaceA>(&observer);
-            observer.handle = &handle;
-            observable->NotifyA(1);
-            observable->NotifyA(2);
-            assert(observer.calls == 1);
-            assert(!observable->IsObserverRegistered(&observer));
-        }
-    }
+    void TestThreadSafeBucketRegistrationAndDispatch() {
+        auto observable = std::make_shared<TestThreadSafeBucketObservable>();
+        ObserverAB observer;
+        ObserverA observerA;
 
-}
+        bool nullThrown = false;
+        try { observable->RegisterObserverAs<InterfaceA>(nullptr); }
+        catch (const InvalidObserverRegistrationException&) { nullThrown = true; }
+        assert(nullThrown);
 
-int main() {
+        bool mismatchThrown = false;
+        try { observable->RegisterObserverAs<InterfaceC>(&observer); }
+        catch (const ObserverInterfaceMismatchException&) { mismatchThrown = true; }
+        assert(mismatchThrown);
+        assert(!observable->IsObserverRegistered(&observer));
+
+        ObserverHandlePtr handle =
+            observable->RegisterObserverAs<InterfaceA, InterfaceB, InterfaceA>(&observer);
+        bool duplicateThrown = false;
+        try { observable->RegisterObserverAs<InterfaceB, InterfaceA>(&observer); }
+        catch (const DuplicateObserverRegistrationException&) { duplicateThrown = true; }
+        assert(duplicateThrown);
+        bool conflictThrown = false;
+        try { observable->RegisterObserverAs<InterfaceA>(&observer); }
+        catch (const ObserverRegistrationConflictException&) { conflictThrown = true; }
+        assert(conflictThrown);
+
+        ObserverHandlePtr handleA = observable->RegisterObserverAs<InterfaceA>(&observerA);
+        observable->NotifyA(12);
+        observable->NotifyB(34);
+        observable->NotifyC();
+        assert(observer.callsA == 1 && observer.valueA == 12);
+        assert(observer.callsB == 1 && observer.valueB == 34);
+        assert(observerA.calls == 1 && observerA.value == 12);
+
+        int calls = 0;
+        observable->NotifyWithA([&](InterfaceA* target) {
+            ++calls;
+            if (target == static_cast<InterfaceA*>(&observer)) { handleA.reset(); }
+        });
+        assert(calls == 1);
+        assert(!observable->IsObserverRegistered(&observerA));
+
+        bool callbackThrown = false;
+        try {
+            observable->NotifyWithA([](InterfaceA*) {
+                throw std::runtime_error("bucket callback failure");
+            });
+        } catch (const std::runtime_error&) { callbackThrown = true; }
+        assert(callbackThrown);
+        assert(observable->IsObserverRegistered(&observer));
+
+        observable->UnregisterObserver(&observer);
+        observable->UnregisterObserver(&observer);
+        assert(!observable->IsObserverRegistered(&observer));
+        assert(handle->GetObserver() == nullptr);
+        observable->NotifyA(56);
+        assert(observer.callsA == 1);
+        handle.reset();
+
+        ObserverHandlePtr retained = observable->RegisterObserverAs<InterfaceB>(&observer);
+        observable.reset();
+        assert(retained->GetObservable() == nullptr);
+        retained.reset();
+    }
+
+    void TestThreadSafeBucketParallelDispatch() {
+        auto observable = std::make_shared<TestThreadSafeBucketObservable>();
+        ObserverAB observer;
+        ObserverA lateObserver;
+        ObserverHandlePtr handle =
+            observable->RegisterObserverAs<InterfaceA, InterfaceB>(&observer);
+        std::atomic<int> callbacksEntered{0};
+        std::atomic<bool> releaseCallbacks{false};
+
+        std::thread notifierA([&]() {
+            observable->NotifyWithA([&](InterfaceA*) {
+                callbacksEntered.fetch_add(1);
+                while (!releaseCallbacks.load()) { std::this_thread::yield(); }
+            });
+        });
+        std::thread notifierB([&]() {
+            observable->NotifyWithB([&](InterfaceB*) {
+                callbacksEntered.fetch_add(1);
+                while (!releaseCallbacks.load()) { std::this_thread::yield(); }
+            });
+        });
+        while (callbacksEntered.load() != 2) { std::this_thread::yield(); }
+
+        ObserverHandlePtr lateHandle = observable->RegisterObserverAs<InterfaceA>(&lateObserver);
+        assert(observable->IsObserverRegistered(&lateObserver));
+        releaseCallbacks.store(true);
+        notifierA.join();
+        notifierB.join();
+
+        std::atomic<bool> stop{false};
+        std::atomic<bool> notified{false};
+        std::thread notifier([&]() {
+            while (!stop.load()) {
+                observable->NotifyB(1);
+                notified.store(true);
+            }
+        });
+        while (!notified.load()) { std::this_thread::yield(); }
+        for (int index = 0; index < 200; ++index) {
+            ObserverA transient;
+            ObserverHandlePtr transientHandle =
+                observable->RegisterObserverAs<InterfaceA>(&transient);
+            transientHandle.reset();
+        }
+        stop.store(true);
+        notifier.join();
+        lateHandle.reset();
+        handle.reset();
+    }
+
+    class TestStaticObservable final
+        : public StaticObservable<InterfaceA, InterfaceB, InterfaceC> {
+        public:
+            void NotifyA(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(
+                        [value](InterfaceA* observer) { observer->OnA(value); });
+                });
+            }
+
+            void NotifyB(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceB>(
+                        [value](InterfaceB* observer) { observer->OnB(value); });
+                });
+            }
+
+            void NotifyWithA(const std::function<void(InterfaceA*)>& callback) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers<InterfaceA>(callback);
+                });
+            }
+    };
+
+    void TestStaticRegistrationAndDispatch() {
+        auto observable = std::make_shared<TestStaticObservable>();
+        ObserverAB observer;
+        ObserverA observerA;
+
+        bool nullThrown = false;
+        try { observable->RegisterObserver(static_cast<ObserverA*>(nullptr)); }
+        catch (const InvalidObserverRegistrationException&) { nullThrown = true; }
+        assert(nullThrown);
+
+        ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+        bool duplicateThrown = false;
+        try { observable->RegisterObserverAs<InterfaceB, InterfaceA>(&observer); }
+        catch (const DuplicateObserverRegistrationException&) { duplicateThrown = true; }
+        assert(duplicateThrown);
+        bool conflictThrown = false;
+        try { observable->RegisterObserverAs<InterfaceA>(&observer); }
+        catch (const ObserverRegistrationConflictException&) { conflictThrown = true; }
+        assert(conflictThrown);
+
+        ObserverHandlePtr handleA = observable->RegisterObserverAs<InterfaceA>(&observerA);
+        assert(observable->IsObserverRegistered(&observer));
+        assert(observable->IsObserverRegistered(&observerA));
+        observable->NotifyA(12);
+        observable->NotifyB(34);
+        assert(observer.callsA == 1 && observer.valueA == 12);
+        assert(observer.callsB == 1 && observer.valueB == 34);
+        assert(observerA.calls == 1 && observerA.value == 12);
+
+        int calls = 0;
+        observable->NotifyWithA([&](InterfaceA* target) {
+            ++calls;
+            if (target == static_cast<InterfaceA*>(&observer)) { handleA.reset(); }
+        });
+        assert(calls == 1);
+        assert(!observable->IsObserverRegistered(&observerA));
+        observable->NotifyA(56);
+        assert(observer.callsA == 2 && observerA.calls == 1);
+
+        bool callbackThrown = false;
+        try {
+            observable->NotifyWithA([](InterfaceA*) {
+                throw std::runtime_error("static callback failure");
+            });
+        } catch (const std::runtime_error&) { callbackThrown = true; }
+        assert(callbackThrown);
+        assert(observable->IsObserverRegistered(&observer));
+
+        observable->UnregisterObserver(&observer);
+        observable->UnregisterObserver(&observer);
+        assert(!observable->IsObserverRegistered(&observer));
+        assert(handle->GetObserver() == nullptr);
+        observable->NotifyB(78);
+        assert(observer.callsB == 1);
+        handle.reset();
+
+        ObserverHandlePtr retained = observable->RegisterObserverAs<InterfaceB>(&observer);
+        observable.reset();
+        assert(retained->GetObservable() == nullptr);
+        retained.reset();
+
+        TestStaticObservable unmanaged;
+        bool ownershipThrown = false;
+        try { unmanaged.NotifyA(1); }
+        catch (const ObservableOwnershipException&) { ownershipThrown = true; }
+        assert(ownershipThrown);
+    }
+
+    class TestTypedObservable final : public TypedObservable<InterfaceA> {
+        public:
+            void NotifyA(int value) {
+                ExecuteNotification([&](NotificationContext& notification) {
+                    notification.WithObservers(
+                        [value](InterfaceA* observer) { observer->OnA(value); });
+                });
+            }
+    };
+
+    void TestTypedRegistrationAndDispatch() {
+        auto observable = std::make_shared<TestTypedObservable>();
+        std::vector<int> order;
+        CallbackObserverA first;
+        CallbackObserverA second;
+        CallbackObserverA third;
+        first.onA = [&order](int) { order.push_back(1); };
+        second.onA = [&order](int) { order.push_back(2); };
+        third.onA = [&order](int) { order.push_back(3); };
+
+        bool nullThrown = false;
+        try { observable->RegisterObserver(static_cast<CallbackObserverA*>(nullptr)); }
+        catch (const InvalidObserverRegistrationException&) { nullThrown = true; }
+        assert(nullThrown);
+
+        ObserverHandlePtr firstHandle = observable->RegisterObserver(&first);
+        ObserverHandlePtr secondHandle = observable->RegisterObserver(&second);
+        bool duplicateThrown = false;
+        try { observable->RegisterObserver(&first); }
+        catch (const DuplicateObserverRegistrationException&) { duplicateThrown = true; }
+        assert(duplicateThrown);
+
+        // An Observer registered during a notification is first notified by
+        // the next one, and one unregistered is skipped immediately.
+        ObserverHandlePtr thirdHandle;
+        first.onA = [&](int) {
+            order.push_back(1);
+            if (!thirdHandle) { thirdHandle = observable->RegisterObserver(&third); }
+            secondHandle.reset();
+        };
+        observable->NotifyA(1);
+        assert((order == std::vector<int>{1}));
+        order.clear();
+        observable->NotifyA(2);
+        assert((order == std::vector<int>{1, 3}));
+        assert(!observable->IsObserverRegistered(&second));
+
+        // Compaction keeps the remaining Observers in registration order.
+        firstHandle.reset();
+        secondHandle = observable->RegisterObserver(&second);
+        order.clear();
+        observable->NotifyA(3);
+        assert((order == std::vector<int>{3, 2}));
+
+        observable.reset();
+        assert(thirdHandle->GetObservable() == nullptr);
+        assert(thirdHandle->GetObserver() == nullptr);
+
+        TestTypedObservable unmanaged;
+        bool ownershipThrown = false;
+        try { unmanaged.NotifyA(1); }
+        catch (const ObservableOwnershipException&) { ownershipThrown = true; }
+        assert(ownershipThrown);
+    }
+
+    void TestSlabBlockAllocator() {
+        using Allocator = Detail::SlabBlockAllocator;
+        void* first = Allocator::Allocate(40);
+        Allocator::Deallocate(first, 40);
+        void* reused = Allocator::Allocate(48);
+        assert(reused == first);
+
+        void* blocks[Allocator::ThreadCacheLimit * 2];
+        for (void*& block : blocks) {
+            block = Allocator::Allocate(Allocator::Granularity * 2);
+            assert(reinterpret_cast<std::uintptr_t>(block) % alignof(std::max_align_t) == 0);
+        }
+        std::thread releaser([&]() {
+            for (void* block : blocks) {
+                Allocator::Deallocate(block, Allocator::Granularity * 2);
+            }
+        });
+        releaser.join();
+
+        const std::size_t largeSize = Allocator::Granularity * Allocator::SizeClassCount + 1;
+        void* large = Allocator::Allocate(largeSize);
+        Allocator::Deallocate(large, largeSize);
+        Allocator::Deallocate(reused, 48);
+        Allocator::Deallocate(nullptr, 48);
+    }
+
+    void TestAsyncManualDrain() {
+        auto observable = std::make_shared<TestAsyncObservable>(3, AsyncDispatchMode::Manual);
+        assert(observable->GetQueueCapacity() == 4);
+        ObserverA observer;
+        ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+
+        observable->NotifyA(1);
+        observable->NotifyA(2);
+        observable->NotifyA(3);
+        assert(observer.calls == 0);
+        assert(observable->Drain() == 3);
+        assert(observer.calls == 3 && observer.value == 3);
+        assert(observable->Drain() == 0);
+
+        for (int value = 0; value < 4; ++value) { assert(observable->TryNotifyA(value)); }
+        assert(!observable->TryNotifyA(4));
+        bool fullThrown = false;
+        try { observable->NotifyA(5); }
+        catch (const AsyncNotificationQueueFullException&) { fullThrown = true; }
+        assert(fullThrown);
+        assert(observable->Drain() == 4);
+        assert(observer.calls == 7 && observer.value == 3);
+
+        CallbackObserverA reentrant;
+        std::size_t nestedDrained = 1;
+        reentrant.onA = [&](int) { nestedDrained = observable->Drain(); };
+        ObserverHandlePtr reentrantHandle = observable->RegisterObserver(&reentrant);
+        observable->NotifyA(6);
+        observable->NotifyA(7);
+        assert(observable->Drain() == 2);
+        assert(nestedDrained == 0);
+        assert(observer.calls == 9 && observer.value == 7);
+
+        observable->NotifyThrow();
+        observable->NotifyA(8);
+        bool callbackThrown = false;
+        try { observable->Drain(); }
+        catch (const std::runtime_error&) { callbackThrown = true; }
+        assert(callbackThrown);
+        assert(observable->Drain() == 1);
+        assert(observer.value == 8);
+
+        TestAsyncObservable unmanaged(4, AsyncDispatchMode::Manual);
+        unmanaged.NotifyA(1);
+        bool ownershipThrown = false;
+        try { unmanaged.Drain(); }
+        catch (const ObservableOwnershipException&) { ownershipThrown = true; }
+        assert(ownershipThrown);
+
+        TestAsyncObservable unmanagedDispatcher;
+        ownershipThrown = false;
+        try { unmanagedDispatcher.NotifyA(1); }
+        catch (const ObservableOwnershipException&) { ownershipThrown = true; }
+        assert(ownershipThrown);
+    }
+
+    void TestAsyncDeferrableNotification() {
+        auto observable = std::make_shared<TestAsyncObservable>(4, AsyncDispatchMode::Manual);
+        ObserverA observer;
+        ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+
+        observable->NotifyDeferrableA(1);
+        assert(observer.calls == 0);
+        assert(observable->Drain() == 1);
+        assert(observer.calls == 1 && observer.value == 1);
+
+        {
+            NotificationTransaction transaction;
+            observable->NotifyDeferrableA(2);
+            observable->NotifyDeferrableA(3);
+            transaction.Commit();
+        }
+        assert(observer.calls == 1);
+        assert(observable->Drain() == 1);
+        assert(observer.calls == 2 && observer.value == 3);
+
+        ObserverA later;
+        {
+            NotificationTransaction transaction;
+            observable->NotifyDeferrableA(4);
+            ObserverHandlePtr laterHandle = observable->RegisterObserver(&later);
+            observable->NotifyDeferrableA(5);
+            transaction.Commit();
+            assert(observer.calls == 2 && later.calls == 0);
+            assert(observable->Drain() == 1);
+        }
+        assert(observer.calls == 3 && observer.value == 5);
+        assert(later.calls == 1 && later.value == 5);
+    }
+
+    void TestAsyncDispatcherThread() {
+        auto observable = std::make_shared<TestAsyncObservable>(1024);
+        std::atomic<int> calls{0};
+        std::atomic<bool> onDispatcher{true};
+        const std::thread::id producerThread = std::this_thread::get_id();
+        CallbackObserverA observer;
+        observer.onA = [&](int) {
+            if (std::this_thread::get_id() == producerThread) { onDispatcher = false; }
+            calls.fetch_add(1);
+        };
+        ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < 4; ++producer) {
+            producers.emplace_back([&]() {
+                for (int value = 0; value < 200; ++value) { observable->NotifyA(value); }
+            });
+        }
+        for (std::thread& producer : producers) { producer.join(); }
+        assert(WaitUntil([&]() { return calls.load() == 800; }));
+        assert(onDispatcher);
+
+        observable->NotifyThrow();
+        observable->NotifyA(1);
+        assert(WaitUntil([&]() { return calls.load() == 801; }));
+        assert(observable->exceptions.load() == 1);
+
+        auto token = std::make_shared<int>(0);
+        {
+            auto manual = std::make_shared<TestAsyncObservable>(4, AsyncDispatchMode::Manual);
+            manual->NotifyHolding(token);
+            assert(token.use_count() == 2);
+        }
+        assert(token.use_count() == 1);
+        handle.reset();
+    }
+
+    void TestAsyncDestructionOnDispatcher() {
+        auto observable = std::make_shared<TestAsyncObservable>();
+        std::atomic<bool> entered{false};
+        std::atomic<bool> released{false};
+        CallbackObserverA observer;
+        observer.onA = [&](int) {
+            entered = true;
+            while (!released.load()) { std::this_thread::yield(); }
+        };
+        ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+        observable->NotifyA(1);
+        assert(WaitUntil([&]() { return entered.load(); }));
+
+        observable.reset();
+        assert(handle->GetObservable() != nullptr);
+        released = true;
+        assert(WaitUntil([&]() { return handle->GetObservable() == nullptr; }));
+        handle.reset();
+    }
+
+    void TestParallelDispatchPool() {
+        ParallelDispatchPool pool(3);
+        assert(pool.GetWorkerCount() == 3);
+
+        const std::size_t count = 10000;
+        std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[count]);
+        for (std::size_t index = 0; index < count; ++index) { visits[index] = 0; }
+        std::atomic<std::size_t> nestedVisits{0};
+        std::vector<std::exception_ptr> exceptions =
+            pool.ForEach(count, 7, [&](std::size_t index) {
+                visits[index].fetch_add(1);
+                if (index % 1000 == 0) {
+                    pool.ForEach(16, 1, [&](std::size_t) { nestedVisits.fetch_add(1); });
+                    throw std::runtime_error("pool callback failure");
+                }
+            });
+        for (std::size_t index = 0; index < count; ++index) { assert(visits[index] == 1); }
+        assert(nestedVisits == 10 * 16);
+        assert(exceptions.size() == 10);
+        for (const std::exception_ptr& exception : exceptions) {
+            bool rethrown = false;
+            try { std::rethrow_exception(exception); }
+            catch (const std::runtime_error&) { rethrown = true; }
+            assert(rethrown);
+        }
+
+        ParallelDispatchPool serialPool(0);
+        std::size_t serialVisits = 0;
+        assert(serialPool.ForEach(100, 1, [&](std::size_t) { ++serialVisits; }).empty());
+        assert(serialVisits == 100);
+    }
+
+    template <class ParallelObservable, class Register>
+    void TestParallelFanOut(Register&& registerObserver) {
+        auto pool = std::make_shared<ParallelDispatchPool>(3);
+        auto observable = std::make_shared<ParallelObservable>();
+        observable->SetParallelDispatch(pool, 4);
+
+        const std::size_t observerCount = 200;
+        std::vector<ObserverA> observers(observerCount);
+        std::vector<ObserverHandlePtr> handles;
+        for (ObserverA& observer : observers) {
+            handles.push_back(registerObserver(*observable, &observer));
+        }
+        observable->NotifyA(5);
+        for (const ObserverA& observer : observers) {
+            assert(observer.calls == 1 && observer.value == 5);
+        }
+
+        bool aggregated = false;
+        try { observable->NotifyThrow(); }
+        catch (const ParallelNotificationException& exception) {
+            aggregated = exception.GetExceptions().size() == observerCount;
+        }
+        assert(aggregated);
+
+        std::vector<SelfRemovingObserver> removing(observerCount);
+        std::vector<ObserverHandlePtr> removingHandles(observerCount);
+        for (std::size_t index = 0; index < observerCount; ++index) {
+            removingHandles[index] = registerObserver(*observable, &removing[index]);
+            removing[index].handle = &removingHandles[index];
+        }
+        observable->NotifyA(6);
+        observable->NotifyA(7);
+        for (std::size_t index = 0; index < observerCount; ++index) {
+            assert(removing[index].calls == 1);
+            assert(!observable->IsObserverRegistered(&removing[index]));
+        }
+        for (const ObserverA& observer : observers) {
+            assert(observer.calls == 3 && observer.value == 7);
+        }
+
+        observable->SetParallelDispatch(nullptr);
+        bool serialThrown = false;
+        try { observable->NotifyThrow(); }
+        catch (const ParallelNotificationException&) {}
+        catch (const std::runtime_error&) { serialThrown = true; }
+        assert(serialThrown);
+    }
+
+    template <class T>
+    struct ValueRecorder final : ObserverOf<IValueObserver<T> > {
+        std::vector<std::pair<T, T> > changes;
+        void OnValueChanged(const T& previous, const T& current) override {
+            changes.emplace_back(previous, current);
+        }
+    };
+
+    void TestObservableValue() {
+        auto value = std::make_shared<ObservableValue<int> >(0);
+        ValueRecorder<int> recorder;
+        ObserverHandlePtr handle = value->RegisterObserver(&recorder);
+
+        value->Set(1);
+        value->Set(1);
+        assert(recorder.changes.size() == 1);
+        assert(recorder.changes.back() == std::make_pair(0, 1));
+
+        value->Coalesce([&]() {
+            value->Set(2);
+            value->Coalesce([&]() { value->Set(3); });
+            value->Set(4);
+        });
+        assert(recorder.changes.size() == 2);
+        assert(recorder.changes.back() == std::make_pair(1, 4));
+
+        value->Coalesce([&]() {
+            value->Set(5);
+            value->Set(4);
+        });
+        assert(recorder.changes.size() == 2);
+
+        bool thrown = false;
+        try {
+            value->Coalesce([&]() {
+                value->Set(7);
+                throw std::runtime_error("coalesced write failure");
+            });
+        } catch (const std::runtime_error&) { thrown = true; }
+        assert(thrown);
+        assert(value->Get() == 7);
+        assert(recorder.changes.size() == 2);
+        value->Set(7);
+        assert(recorder.changes.size() == 3);
+        assert(recorder.changes.back() == std::make_pair(4, 7));
+    }
+
+    void TestObservableValueTransaction() {
+        auto first = std::make_shared<ObservableValue<int> >(0);
+        auto second = std::make_shared<ObservableValue<int, ThreadSafeObservable> >(0);
+        ValueRecorder<int> both;
+        ValueRecorder<int> firstOnly;
+        ValueRecorder<int> secondOnly;
+        ObserverHandlePtr handles[] = {
+            first->RegisterObserver(&both),
+            second->RegisterObserver(&both),
+            first->RegisterObserver(&firstOnly),
+            second->RegisterObserver(&secondOnly)
+        };
+
+        {
+            NotificationTransaction transaction;
+            first->Set(1);
+            second->Set(2);
+            first->Set(3);
+            assert(both.changes.empty() && firstOnly.changes.empty() && secondOnly.changes.empty());
+            transaction.Commit();
+        }
+        assert(both.changes.size() == 1);
+        assert(both.changes.back() == std::make_pair(1, 3));
+        assert(firstOnly.changes.size() == 1);
+        assert(firstOnly.changes.back() == std::make_pair(1, 3));
+        assert(secondOnly.changes.size() == 1);
+        assert(secondOnly.changes.back() == std::make_pair(0, 2));
+
+        {
+            NotificationTransaction transaction;
+            first->Set(4);
+        }
+        assert(first->Get() == 4);
+        assert(firstOnly.changes.size() == 1);
+        first->Set(5);
+        assert(firstOnly.changes.size() == 2);
+        assert(firstOnly.changes.back() == std::make_pair(4, 5));
+    }
+
+    /// Counts notifications delivered from any thread, and whether each one
+    /// continued from the value the previous one left.
+    struct ConcurrentValueObserver final : ObserverOf<IValueObserver<int> > {
+        std::atomic<int> changes{0};
+        std::atomic<int> last{0};
+        std::atomic<bool> ordered{true};
+        void OnValueChanged(const int& previous, const int& current) override {
+            if (last.exchange(current) != previous) { ordered = false; }
+            ++changes;
+        }
+    };
+
+    template <class Base>
+    void TestConcurrentObservableValue() {
+        constexpr int writes = 2000;
+        auto value = std::make_shared<ObservableValue<int, Base> >(0);
+        ConcurrentValueObserver observer;
+        ObserverHandlePtr handle = value->RegisterObserver(&observer);
+
+        std::vector<std::thread> writers;
+        for (int writer = 0; writer < 2; ++writer) {
+            writers.emplace_back([&value, writer]() {
+                for (int write = 1; write <= writes; ++write) {
+                    value->Set(writer * writes + write);
+                }
+            });
+        }
+        for (std::thread& writer : writers) { writer.join(); }
+
+        // Every write differs from the value last notified, so each notifies.
+        const int last = value->Get();
+        assert(last == writes || last == 2 * writes);
+        assert(observer.changes.load() == 2 * writes);
+        assert(observer.ordered.load() && observer.last.load() == last);
+        handle.reset();
+    }
+
+    void TestObservableValueComparators() {
+        using Temperature =
+            ObservableValue<float, ThreadSafeObservable, ApproximatelyEqual<float> >;
+        auto temperature = std::make_shared<Temperature>(0.0f, ApproximatelyEqual<float>(0.5f));
+        ValueRecorder<float> recorder;
+        ObserverHandlePtr handle = temperature->RegisterObserver(&recorder);
+
+        temperature->Set(0.25f);
+        assert(recorder.changes.empty());
+        temperature->Set(0.75f);
+        temperature->Set(1.0f);
+        temperature->Set(1.5f);
+        assert(recorder.changes.size() == 2);
+        assert(recorder.changes[0] == std::make_pair(0.0f, 0.75f));
+        assert(recorder.changes[1] == std::make_pair(0.75f, 1.5f));
+        assert(temperature->Get() == 1.5f);
+
+        auto bucketValue = std::make_shared<ObservableValue<int, ObservableWithBuckets> >();
+        ValueRecorder<int> bucketRecorder;
+        ObserverHandlePtr bucketHandle =
+            bucketValue->RegisterObserverAs<IValueObserver<int> >(&bucketRecorder);
+        bucketValue->Set(3);
+        assert(bucketRecorder.changes.size() == 1);
+        assert(bucketRecorder.changes.back() == std::make_pair(0, 3));
+    }
+
+    void TestNotificationTransaction() {
+        auto observable = std::make_shared<TestObservable>();
+        auto threadSafe = std::make_shared<TestThreadSafeObservable>();
+        auto buckets = std::make_shared<TestBucketObservable>();
+        ObserverA shared;
+        ObserverAB single;
+        ObserverHandlePtr sharedHandles[] = {
+            observable->RegisterObserver(&shared),
+            threadSafe->RegisterObserver(&shared),
+            buckets->RegisterObserverAs<InterfaceA>(&shared)
+        };
+        ObserverHandlePtr singleHandle = observable->RegisterObserver(&single);
+
+        observable->RaiseA(1);
+        threadSafe->RaiseA(2);
+        assert(shared.calls == 2 && shared.value == 2);
+
+        {
+            NotificationTransaction transaction;
+            observable->RaiseA(3);
+            threadSafe->RaiseA(4);
+            buckets->RaiseA(5);
+            observable->NotifyA(6);
+            assert(shared.calls == 3 && shared.value == 6);
+            transaction.Commit();
+        }
+        assert(shared.calls == 4 && shared.value == 5);
+        assert(single.callsA == 3 && single.valueA == 3);
+
+        {
+            NotificationTransaction transaction;
+            threadSafe->RaiseA(7);
+        }
+        {
+            NotificationTransaction outer;
+            observable->RaiseA(8);
+            {
+                NotificationTransaction committed;
+                buckets->RaiseA(9);
+                committed.Commit();
+            }
+            {
+                NotificationTransaction discarded;
+                threadSafe->RaiseA(10);
+            }
+            assert(shared.calls == 4);
+            outer.Commit();
+            outer.Commit();
+        }
+        assert(shared.calls == 5 && shared.value == 9);
+        assert(single.callsA == 4 && single.valueA == 8);
+
+        {
+            NotificationTransaction transaction;
+            observable->RaiseA(11);
+            singleHandle.reset();
+            transaction.Commit();
+        }
+        assert(shared.calls == 6 && shared.value == 11);
+        assert(single.callsA == 4);
+
+        std::weak_ptr<TestBucketObservable> weakBuckets = buckets;
+        {
+            NotificationTransaction transaction;
+            buckets->RaiseA(12);
+            buckets.reset();
+            assert(!weakBuckets.expired());
+            transaction.Commit();
+        }
+        assert(weakBuckets.expired());
+        assert(shared.calls == 7 && shared.value == 12);
+
+        // A callback committing its own transaction flushes it immediately.
+        CallbackObserverA forwarding;
+        int nestedValue = 0;
+        forwarding.onA = [&threadSafe, &shared, &nestedValue](int value) {
+            NotificationTransaction nested;
+            threadSafe->RaiseA(value * 10);
+            threadSafe->RaiseA(value * 100);
+            nested.Commit();
+            nestedValue = shared.value;
+        };
+        ObserverHandlePtr forwardingHandle = observable->RegisterObserver(&forwarding);
+        {
+            NotificationTransaction transaction;
+            observable->RaiseA(13);
+            threadSafe->RaiseA(14);
+            transaction.Commit();
+        }
+        assert(nestedValue == 1300);
+        assert(shared.calls == 9 && shared.value == 14);
+    }
+
+    /// `expectedTombstones` and `expectedCompactions` differ by type: buckets
+    /// compact after any notification that left a tombstone, and remove
+    /// Observers unregistered outside a notification immediately.
+    template <class ObservableType, class Register>
+    void TestInstrumentation(
+        Register&& registerObserver,
+        std::uint64_t expectedTombstones,
+        std::uint64_t expectedCompactions) {
+        auto observable = std::make_shared<ObservableType>();
+        ObserverA first;
+        ObserverA third;
+        CallbackObserverA second;
+        ObserverHandlePtr thirdHandle;
+        second.onA = [&thirdHandle](int) { thirdHandle.reset(); };
+        ObserverHandlePtr firstHandle = registerObserver(*observable, &first);
+        ObserverHandlePtr secondHandle = registerObserver(*observable, &second);
+        thirdHandle = registerObserver(*observable, &third);
+
+        observable->NotifyA(1);
+        observable->NotifyA(2);
+        firstHandle.reset();
+        secondHandle.reset();
+        observable->NotifyA(3);
+        assert(first.calls == 2 && third.calls == 0);
+
+        const ObservableStatistics statistics = observable->GetStatistics();
+#if ESPRESSIO_OBSERVABLE_INSTRUMENTATION
+        assert(statistics.notifications == 3);
+        assert(statistics.callbacksInvoked == 4);
+        assert(statistics.tombstonesSkipped == expectedTombstones);
+        assert(statistics.compactions == expectedCompactions);
+        assert(statistics.registrations == 3);
+        assert(statistics.unregistrations == 3);
+        assert(statistics.totalDispatchNanoseconds >= statistics.maxDispatchNanoseconds);
+#else
+        (void)expectedTombstones;
+        (void)expectedCompactions;
+        assert(statistics.notifications == 0 && statistics.callbacksInvoked == 0);
+        assert(statistics.registrations == 0 && statistics.totalDispatchNanoseconds == 0);
+#endif
+    }
+
+    template <class ObservableType, class Register>
+    void TestRunToCompletion(Register&& registerObserver) {
+        auto observable = std::make_shared<ObservableType>();
+        auto chained = std::make_shared<ObservableType>();
+        CallbackObserverA cascading;
+        CallbackObserverA forwarding;
+        std::vector<int> values;
+        int depth = 0;
+        int maxDepth = 0;
+        cascading.onA = [&](int value) {
+            maxDepth = std::max(maxDepth, ++depth);
+            values.push_back(value);
+            if (value == 3) {
+                observable->RaiseA(2);
+                observable->RaiseA(1);
+            } else if (value == 2) {
+                observable->RaiseA(0);
+            } else if (value >= 10) {
+                chained->RaiseA(value - 1);
+            }
+            --depth;
+        };
+        forwarding.onA = [&](int value) {
+            maxDepth = std::max(maxDepth, ++depth);
+            if (value > 10) { observable->RaiseA(value - 1); }
+            --depth;
+        };
+        ObserverHandlePtr cascadingHandle = registerObserver(*observable, &cascading);
+        ObserverHandlePtr forwardingHandle = registerObserver(*chained, &forwarding);
+
+        observable->RaiseA(3);
+        assert((values == std::vector<int>{3, 2, 0, 1}) && maxDepth == 3);
+        values.clear();
+        maxDepth = 0;
+        observable->RaiseA(16);
+        assert(values.size() == 4 && maxDepth == 8);
+
+        observable->EnableRunToCompletion();
+        chained->EnableRunToCompletion();
+        values.clear();
+        maxDepth = 0;
+        observable->RaiseA(3);
+        assert((values == std::vector<int>{3, 2, 1, 0}) && maxDepth == 1);
+        values.clear();
+        observable->RaiseA(1000);
+        assert(values.size() == 496 && values.back() == 10 && maxDepth == 1);
+
+        // Tombstones left by one queued notification are compacted before the next.
+        std::vector<SelfRemovingObserver> removing(4);
+        std::vector<ObserverHandlePtr> removingHandles(removing.size());
+        for (std::size_t index = 0; index < removing.size(); ++index) {
+            removingHandles[index] = registerObserver(*observable, &removing[index]);
+            removing[index].handle = &removingHandles[index];
+        }
+        const ObservableStatistics before = observable->GetStatistics();
+        values.clear();
+        observable->RaiseA(3);
+        assert(values.size() == 4);
+        for (const SelfRemovingObserver& observer : removing) { assert(observer.calls == 1); }
+        const ObservableStatistics after = observable->GetStatistics();
+        assert(after.tombstonesSkipped == before.tombstonesSkipped);
+
+        // A callback exception discards the notifications still queued.
+        cascading.onA = [&](int value) {
+            values.push_back(value);
+            observable->RaiseA(value + 1);
+            if (value == 1) { throw std::logic_error("expected"); }
+        };
+        values.clear();
+        bool thrown = false;
+        try { observable->RaiseA(0); }
+        catch (const std::logic_error&) { thrown = true; }
+        assert(thrown && (values == std::vector<int>{0, 1}));
+        values.clear();
+        cascading.onA = [&](int value) { values.push_back(value); };
+        observable->RaiseA(5);
+        assert((values == std::vector<int>{5}));
+
+        observable->DisableRunToCompletion();
+        chained->DisableRunToCompletion();
+        cascading.onA = [&](int value) {
+            values.push_back(value);
+            if (value > 0) { observable->RaiseA(value - 1); }
+        };
+        values.clear();
+        observable->RaiseA(1);
+        assert((values == std::vector<int>{1, 0}));
+    }
+
+    void TestLatencyHistogramPercentiles() {
+        ObserverLatencyHistogram histogram;
+        assert(histogram.GetSampleCount() == 0 && histogram.GetPercentileNanoseconds(50) == 0);
+        histogram.counts[3] = 9;
+        histogram.counts[10] = 1;
+        assert(histogram.GetSampleCount() == 10);
+        assert(histogram.GetPercentileNanoseconds(50) == 8);
+        assert(histogram.GetPercentileNanoseconds(90) == 8);
+        assert(histogram.GetPercentileNanoseconds(99) == 1024);
+    }
+
+    template <class ObservableType, class Register>
+    void TestLatencyTracking(Register&& registerObserver) {
+        auto observable = std::make_shared<ObservableType>();
+        ObserverA fast;
+        CallbackObserverA slow;
+        SelfRemovingObserver selfRemoving;
+        slow.onA = [](int) { std::this_thread::sleep_for(std::chrono::milliseconds(2)); };
+        ObserverHandlePtr fastHandle = registerObserver(*observable, &fast);
+        ObserverHandlePtr slowHandle = registerObserver(*observable, &slow);
+        ObserverHandlePtr selfRemovingHandle = registerObserver(*observable, &selfRemoving);
+        selfRemoving.handle = &selfRemovingHandle;
+
+        observable->NotifyA(0);
+        assert(fastHandle->GetLatencyHistogram().GetSampleCount() == 0);
+        assert(slowHandle->GetLatencyHistogram().GetSampleCount() == 0);
+
+        std::vector<IObserver*> slowObservers;
+        observable->EnableLatencyTracking(
+            std::chrono::milliseconds(1),
+            [&observable, &slowObservers](IObserver* observer, std::chrono::nanoseconds elapsed) {
+                assert(elapsed >= std::chrono::milliseconds(1));
+                slowObservers.push_back(observer);
+                observable->UnregisterObserver(observer);
+            });
+        selfRemovingHandle = registerObserver(*observable, &selfRemoving);
+        observable->NotifyA(1);
+        observable->NotifyA(2);
+        assert(fast.calls == 3 && selfRemoving.calls == 2);
+        assert(slowObservers.size() == 1 && slowObservers[0] == &slow);
+        assert(!observable->IsObserverRegistered(&slow));
+        assert(fastHandle->GetLatencyHistogram().GetSampleCount() == 2);
+        const ObserverLatencyHistogram slowHistogram = slowHandle->GetLatencyHistogram();
+        assert(slowHistogram.GetSampleCount() == 1);
+        assert(slowHistogram.GetPercentileNanoseconds(100) >= 1000000);
+
+        observable->DisableLatencyTracking();
+        observable->NotifyA(3);
+        assert(fast.calls == 4);
+        assert(fastHandle->GetLatencyHistogram().GetSampleCount() == 2);
+    }
+
+    template <class ObservableType, class RegisterByValue, class Register>
+    void TestObserverRegistration(RegisterByValue&& registerByValue, Register&& registerObserver) {
+        auto observable = std::make_shared<ObservableType>();
+        ObserverA first;
+        ObserverA second;
+        ObserverA third;
+        CallbackObserverA selfRemoving;
+
+        ObserverRegistration empty;
+        assert(!empty && empty.GetObservable() == nullptr && empty.GetObserver() == nullptr);
+        empty.Unregister();
+
+        ObserverRegistration registration = registerByValue(*observable, &first);
+        assert(registration && registration.GetObserver() == &first);
+        assert(registration.GetObservable() == observable.get());
+        bool duplicateThrown = false;
+        try { registerObserver(*observable, &first); }
+        catch (const DuplicateObserverRegistrationException&) { duplicateThrown = true; }
+        assert(duplicateThrown);
+        {
+            ObserverRegistration moved(std::move(registration));
+            assert(!registration && moved.GetObserver() == &first);
+            observable->NotifyA(1);
+            assert(first.calls == 1 && first.value == 1);
+        }
+        assert(!observable->IsObserverRegistered(&first));
+
+        // A registration made stale by UnregisterObserver() leaves a later
+        // registration of the same Observer in place.
+        ObserverRegistration stale = registerByValue(*observable, &second);
+        observable->UnregisterObserver(&second);
+        ObserverHandlePtr handle = registerObserver(*observable, &second);
+        stale.Unregister();
+        assert(!stale && observable->IsObserverRegistered(&second));
+        handle.reset();
+        assert(!observable->IsObserverRegistered(&second));
+
+        ObserverRegistration assigned = registerByValue(*observable, &second);
+        assigned = registerByValue(*observable, &third);
+        assert(!observable->IsObserverRegistered(&second));
+        assert(observable->IsObserverRegistered(&third));
+
+        ObserverRegistration selfRegistration = registerByValue(*observable, &selfRemoving);
+        int selfCalls = 0;
+        selfRemoving.onA = [&selfRegistration, &selfCalls](int) {
+            ++selfCalls;
+            selfRegistration.Unregister();
+        };
+        observable->NotifyA(2);
+        observable->NotifyA(3);
+        assert(selfCalls == 1 && third.calls == 2);
+        assert(!selfRegistration);
+
+        observable.reset();
+        assert(assigned && assigned.GetObservable() == nullptr);
+        assigned.Unregister();
+        assert(!assigned);
+    }
+
+    template <class ObservableType, class Register>
+    void TestDeferredDestruction(Register&& registerObserver) {
+        std::shared_ptr<ObservableType> observable = MakeObservable<ObservableType>();
+        ObservableType* raw = observable.get();
+        std::weak_ptr<ObservableType> weakObservable = observable;
+        CallbackObserverA releasing;
+        ObserverA later;
+        ObserverHandlePtr releasingHandle = registerObserver(*observable, &releasing);
+        ObserverHandlePtr laterHandle = registerObserver(*observable, &later);
+
+        // Released by a callback of a nested notification, the Observable
+        // survives until the outermost notification returns.
+        releasing.onA = [&](int value) {
+            if (value == 1) {
+                raw->NotifyA(2);
+                assert(weakObservable.expired());
+                assert(releasingHandle->GetObservable() == raw);
+            } else {
+                observable.reset();
+            }
+        };
+        raw->NotifyA(1);
+        assert(later.calls == 2 && later.value == 1);
+        assert(releasingHandle->GetObservable() == nullptr);
+        assert(laterHandle->GetObservable() == nullptr);
+        releasingHandle.reset();
+        laterHandle.reset();
+
+        observable = MakeObservable<ObservableType>();
+        raw = observable.get();
+        releasingHandle = registerObserver(*observable, &releasing);
+        releasing.onA = [&](int) {
+            observable.reset();
+            throw std::runtime_error("callback failure");
+        };
+        bool callbackThrown = false;
+        try { raw->NotifyA(3); }
+        catch (const std::runtime_error&) { callbackThrown = true; }
+        assert(callbackThrown);
+        assert(releasingHandle->GetObservable() == nullptr);
+    }
+
+    void TestDeferredDestructionWithParallelDispatch() {
+        std::shared_ptr<TestBucketObservable> observable = MakeObservable<TestBucketObservable>();
+        TestBucketObservable* raw = observable.get();
+        observable->SetParallelDispatch(std::make_shared<ParallelDispatchPool>(3), 1);
+
+        std::vector<CallbackObserverA> observers(64);
+        std::vector<ObserverHandlePtr> handles;
+        std::atomic<int> calls{0};
+        for (CallbackObserverA& observer : observers) {
+            // Each fan-out callback notifies the same Observable again.
+            observer.onA = [&](int) {
+                raw->NotifyC();
+                ++calls;
+            };
+            handles.push_back(observable->RegisterObserverAs<InterfaceA>(&observer));
+        }
+        for (int round = 0; round < 20; ++round) { raw->NotifyA(round); }
+        assert(calls.load() == 64 * 20);
+
+        // Every notification lifetime was released, so the Observable is
+        // destroyed immediately.
+        observable.reset();
+        assert(handles.front()->GetObservable() == nullptr);
+    }
+
+    void TestDeferredNotificationContext() {
+        std::shared_ptr<TestObservable> observable = MakeObservable<TestObservable>();
+        ObserverA observer;
+        ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+        std::function<void(int)> deferred = observable->DeferredNotifyA();
+        std::function<void(int)> copied = deferred;
+        observable.reset();
+        deferred = std::function<void(int)>();
+        assert(handle->GetObservable() != nullptr);
+        copied(17);
+        assert(observer.calls == 1 && observer.value == 17);
+        copied = std::function<void(int)>();
+        assert(handle->GetObservable() == nullptr);
+    }
+
+    void TestMutationDuringNotification() {
+        {
+            auto observable = std::make_shared<TestObservable>();
+            SelfRemovingObserver observer;
+            ObserverHandlePtr handle = observable->RegisterObserver(&observer);
+            observer.handle = &handle;
+            observable->NotifyA(1);
+            observable->NotifyA(2);
+            assert(observer.calls == 1);
+            assert(!observable->IsObserverRegistered(&observer));
+        }
+
+        {
+            auto observable = std::make_shared<TestBucketObservable>();
+            SelfRemovingObserver observer;
+            ObserverHandlePtr handle =
+                observable->RegisterObserverAs<InterfaceA>(&observer);
+            observer.handle = &handle;
+            observable->NotifyA(1);
+            observable->NotifyA(2);
+            assert(observer.calls == 1);
+            assert(!observable->IsObserverRegistered(&observer));
+        }
+    }
+
+}
+
+int main() {
     TestObservableRegistrationAndDispatch();
     TestObservableExceptionsAndOwnership();
     TestSharedNotificationLifetime();
@@ -557,10 +2735,135 @@ int main() {
     TestRetainedNotificationContext();
     TestThreadSafeReentrancyAndExceptions();
     TestThreadSafeTypedFiltering();
+    TestObserverCast();
+    TestDispatchCacheIncrementalUpdates<TestObservable>();
+    TestDispatchCacheIncrementalUpdates<TestThreadSafeObservable>();
+    TestSlotIndexPreservesOrder<TestObservable>();
+    TestSlotIndexPreservesOrder<TestThreadSafeObservable>();
+    TestBulkRegistration<TestObservable>();
+    TestBulkRegistration<TestThreadSafeObservable>();
+    TestKeyedSubscriptions();
+    TestRangeSubscriptions();
     TestThreadSafeConcurrentUnregister();
+    TestObservableValue();
+    TestNotificationTransaction();
+    TestInstrumentation<TestObservable>(
+        [](TestObservable& observable, IObserver* observer) {
+            return observable.RegisterObserver(observer);
+        }, 2, 2);
+    TestInstrumentation<TestThreadSafeObservable>(
+        [](TestThreadSafeObservable& observable, IObserver* observer) {
+            return observable.RegisterObserver(observer);
+        }, 2, 2);
+    TestInstrumentation<TestBucketObservable>(
+        [](TestBucketObservable& observable, IObserver* observer) {
+            return observable.RegisterObserverAs<InterfaceA>(observer);
+        }, 1, 1);
+    TestObserverRegistration<TestObservable>(
+        [](TestObservable& observable, IObserver* observer) {
+            return observable.RegisterObserverByValue(observer);
+        },
+        [](TestObservable& observable, IObserver* observer) {
+            return observable.RegisterObserver(observer);
+        });
+    TestObserverRegistration<TestThreadSafeObservable>(
+        [](TestThreadSafeObservable& observable, IObserver* observer) {
+            return observable.RegisterObserverByValue(observer);
+        },
+        [](TestThreadSafeObservable& observable, IObserver* observer) {
+            return observable.RegisterObserver(observer);
+        });
+    TestObserverRegistration<TestBucketObservable>(
+        [](TestBucketObservable& observable, IObserver* observer) {
+            return observable.RegisterObserverByValueAs<InterfaceA>(observer);
+        },
+        [](TestBucketObservable& observable, IObserver* observer) {
+            return observable.RegisterObserverAs<InterfaceA>(observer);
+        });
+    TestDeferredDestruction<TestObservable>(
+        [](TestObservable& observable, IObserver* observer) {
+            return observable.RegisterObserver(observer);
+        });
+    TestDeferredDestruction<TestBucketObservable>(
+        [](TestBucketObservable& observable, IObserver* observer) {
+            return observable.RegisterObserverAs<InterfaceA>(observer);
+        });
+    TestDeferredDestruction<TestStaticObservable>(
+        [](TestStaticObservable& observable, auto* observer) {
+            return observable.RegisterObserver(observer);
+        });
+    TestDeferredDestruction<TestTypedObservable>(
+        [](TestTypedObservable& observable, auto* observer) {
+            return observable.RegisterObserver(observer);
+        });
+    TestDeferredDestructionWithParallelDispatch();
+    TestDeferredNotificationContext();
+    TestObserverRegistration<TestTypedObservable>(
+        [](TestTypedObservable& observable, auto* observer) {
+            return observable.RegisterObserverByValue(observer);
+        },
+        [](TestTypedObservable& observable, auto* observer) {
+            return observable.RegisterObserver(observer);
+        });
+    TestRunToCompletion<TestObservable>(
+        [](TestObservable& observable, IObserver* observer) {
+            return observable.RegisterObserver(observer);
+        });
+    TestRunToCompletion<TestThreadSafeObservable>(
+        [](TestThreadSafeObservable& observable, IObserver* observer) {
+            return observable.RegisterObserver(observer);
+        });
+    TestRunToCompletion<TestBucketObservable>(
+        [](TestBucketObservable& observable, IObserver* observer) {
+            return observable.RegisterObserverAs<InterfaceA>(observer);
+        });
+    TestLatencyHistogramPercentiles();
+    TestLatencyTracking<TestObservable>(
+        [](TestObservable& observable, IObserver* observer) {
+            return observable.RegisterObserver(observer);
+        });
+    TestLatencyTracking<TestThreadSafeObservable>(
+        [](TestThreadSafeObservable& observable, IObserver* observer) {
+            return observable.RegisterObserver(observer);
+        });
+    TestLatencyTracking<TestBucketObservable>(
+        [](TestBucketObservable& observable, IObserver* observer) {
+            return observable.RegisterObserverAs<InterfaceA>(observer);
+        });
+    TestObservableValueComparators();
+    TestObservableValueTransaction();
+    TestConcurrentObservableValue<ThreadSafeObservable>();
+    TestConcurrentObservableValue<ShardedThreadSafeObservable>();
+    TestParallelDispatchPool();
+    TestParallelFanOut<TestParallelObservable>(
+        [](TestParallelObservable& observable, IObserver* observer) {
+            return observable.RegisterObserver(observer);
+        });
+    TestParallelFanOut<TestBucketObservable>(
+        [](TestBucketObservable& observable, IObserver* observer) {
+            return observable.RegisterObserverAs<InterfaceA>(observer);
+        });
+    TestAsyncManualDrain();
+    TestAsyncDeferrableNotification();
+    TestAsyncDispatcherThread();
+    TestAsyncDestructionOnDispatcher();
     TestThreadSafeStress();
+    TestReaderWriterConcurrentDispatch();
+    TestReaderWriterReentrancy();
     TestConcurrentHandleAndObservableDestruction();
+    TestLifetimeControlWaitsForOperations();
+    TestSnapshotReentrancyAndExceptions();
+    TestSnapshotConcurrentDispatch();
+    TestSnapshotStress();
+    TestShardedRegistrationAndDispatch();
+    TestShardedConcurrentRegistration();
     TestBucketRegistrationAndDispatch();
     TestBucketExceptionsAndOwnership();
+    TestBucketBulkRegistration();
     TestMutationDuringNotification();
+    TestThreadSafeBucketRegistrationAndDispatch();
+    TestThreadSafeBucketParallelDispatch();
+    TestStaticRegistrationAndDispatch();
+    TestTypedRegistrationAndDispatch();
+    TestSlabBlockAllocator();
 }